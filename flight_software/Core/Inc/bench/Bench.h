@@ -0,0 +1,87 @@
+/**
+ * Microbenchmark harness for hot path kernels, timed with the Timebase cycle counter
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BENCH_DEFAULT_ITERATIONS 1000U
+#define BENCH_LINE_LEN 112 // longest formatted result line
+
+/**
+ * @brief A kernel under test
+ * @param name Short identifier, stable across commits so results can be compared
+ * @param setup Untimed preparation run once before the iterations, may be NULL
+ * @param run One invocation of the kernel, timed on its own. i is the iteration index,
+ *            kernels use it to cycle through their input sets
+ * @param reset Untimed cleanup after every invocation (e.g. draining a queue), may be NULL
+ * @param items Work items per invocation (samples in a batch), at least 1. Above 1 the
+ *              report adds the mean cost per item
+ */
+typedef struct {
+    const char* name;
+    void (*setup)(void);
+    void (*run)(uint32_t i);
+    void (*reset)(void);
+    uint32_t items;
+} bench_kernel_t;
+
+/**
+ * @brief Cycle counts of one kernel, with the timing overhead already subtracted
+ * @param name Kernel name
+ * @param iterations Number of timed invocations
+ * @param minCycles Fastest invocation
+ * @param meanCycles Average invocation
+ * @param maxCycles Slowest invocation, includes any preemption
+ * @param items Work items per invocation
+ */
+typedef struct {
+    const char* name;
+    uint32_t iterations;
+    uint32_t minCycles;
+    uint32_t meanCycles;
+    uint32_t maxCycles;
+    uint32_t items;
+} bench_result_t;
+
+/**
+ * @brief Gets the registered kernels
+ * @param count Set to the number of kernels
+ * @returns Pointer to the kernel table
+ */
+const bench_kernel_t* Bench_GetKernels(uint32_t* count);
+
+/**
+ * @brief Measures the cost of an empty timed call, subtracted from every result.
+ *        Called by Bench_Run on first use, call again if the clock changes.
+ */
+void Bench_Calibrate(void);
+
+/**
+ * @brief Runs one kernel and collects its cycle counts
+ * @param kernel Kernel to run
+ * @param iterations Number of timed invocations, at least 1
+ * @param result Pointer to a bench_result_t to fill
+ * @returns False if iterations is 0
+ */
+bool Bench_Run(const bench_kernel_t* kernel, uint32_t iterations, bench_result_t* result);
+
+/**
+ * @brief Formats a result as "BENCH <name> n=<iterations> min=<c> mean=<c> max=<c>\r\n",
+ *        with " per_item=<c>" before the line end when the kernel has more than one item
+ * @param dst Output buffer, BENCH_LINE_LEN bytes is always enough
+ * @param space Size of the output buffer
+ * @param result Result to format
+ * @returns Number of bytes written, excluding the null terminator
+ */
+int Bench_FormatResult(char* dst, uint32_t space, const bench_result_t* result);
+
+/**
+ * @brief Benchmark worker task of the FSW_BENCHMARK firmware variant. Brings up USB,
+ *        runs every kernel and reports the results over the CDC link, then repeats
+ *        so a terminal attached late still gets a full report.
+ * @param argument No arguments expected
+ */
+void BenchTask(void *argument);
\ No newline at end of file
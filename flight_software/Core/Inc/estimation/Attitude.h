@@ -0,0 +1,84 @@
+/**
+ * Attitude estimation task, runs the attitude filter on every IMU sample
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "AttitudeFilter.h"
+#include "GyroBias.h"
+
+#define ATTITUDE_KP 1.0f            // gravity correction proportional gain
+#define ATTITUDE_KI 0.0f            // no integral term, GyroBias owns the bias and the two would fight over it
+#define ATTITUDE_CYCLE_BUDGET 2000U // core cycles allowed per filter update
+#define ATTITUDE_GROUND_REST_US 2000000U // still this long and the vehicle counts as on the ground
+
+/**
+ * @brief A published attitude estimate
+ *
+ * @param q Attitude, body to earth
+ * @param gyroBias Gyro bias removed before the filter, rad/s
+ * @param atRest True while the vehicle is still and the bias is being refined
+ * @param restSince_us Timestamp of the sample that started the current rest, valid while atRest
+ * @param seq_n Sequence number of the IMU sample the estimate includes
+ * @param timestamp_us Timestamp of that IMU sample
+ */
+typedef struct {
+    quat_t q;
+    float gyroBias[3];
+    bool atRest;
+    uint64_t restSince_us;
+    uint32_t seq_n;
+    uint64_t timestamp_us;
+} attitude_state_t;
+
+/**
+ * @brief Estimator counters
+ * @param updates Filter updates run
+ * @param missedSamples IMU samples lost before the estimator could read them
+ * @param maxCycles Longest filter update in core cycles
+ * @param budgetOverruns Updates that took longer than ATTITUDE_CYCLE_BUDGET
+ */
+typedef struct {
+    uint32_t updates;
+    uint32_t missedSamples;
+    uint32_t maxCycles;
+    uint32_t budgetOverruns;
+} attitude_stats_t;
+
+/**
+ * @brief Attitude worker task, woken by the acquisition scheduler with ACQ_FLAG_IMU.
+ *        Every sample passes the rest detector and gyro bias estimator first.
+ * @param argument No arguments expected
+ */
+void AttitudeTask(void *argument);
+
+/**
+ * @brief Seeds the online gyro bias estimate, e.g. with the stored one at boot. Call before the
+ *        kernel starts, the task picks it up when it starts.
+ * @param bias Gyro bias in rad/s, body frame, as published in attitude_state_t
+ */
+void Attitude_SetGyroBias(const float bias[3]);
+
+/**
+ * @brief Gets the latest attitude estimate, safe to call from any task
+ * @param stateBuff Pointer to an attitude_state_t to fill
+ * @returns False if no estimate has been published yet
+ */
+bool Attitude_GetLatest(attitude_state_t* stateBuff);
+
+/**
+ * @brief Whether the vehicle is on the ground, taken as still for ATTITUDE_GROUND_REST_US. There
+ *        is no arming state, and spinning motors shake the IMU well past the rest thresholds, so
+ *        a hover never counts. Work that must not run in flight, flash writes, gates on this.
+ * @returns False before the first estimate and whenever the vehicle moved recently
+ */
+bool Attitude_OnGround(void);
+
+/**
+ * @brief Copies the estimator counters
+ * @param stats Pointer to an attitude_stats_t to fill
+ */
+void Attitude_GetStats(attitude_stats_t* stats);
\ No newline at end of file
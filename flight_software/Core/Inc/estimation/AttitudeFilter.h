@@ -0,0 +1,64 @@
+/**
+ * Mahony quaternion complementary filter, single precision
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IMUInterface.h"
+
+/**
+ * @brief Unit quaternion rotating body frame vectors into the earth frame
+ */
+typedef struct {
+    float w;
+    float x;
+    float y;
+    float z;
+} quat_t;
+
+/**
+ * @brief Filter state, one per estimator instance
+ *
+ * @param q Current attitude
+ * @param integral Integral feedback of the gravity error, the gyro bias estimate in rad/s
+ * @param kp Proportional gain of the gravity correction
+ * @param ki Integral gain of the gravity correction, 0 disables bias estimation
+ * @param lastTimestampUs Timestamp of the previous update
+ * @param initialized False until the first sample has levelled the attitude
+ */
+typedef struct {
+    quat_t q;
+    float integral[3];
+    float kp;
+    float ki;
+    uint64_t lastTimestampUs;
+    bool initialized;
+} attitude_filter_t;
+
+/**
+ * @brief Resets the filter, the first update levels it from the accelerometer
+ * @param filter Filter state
+ * @param kp Proportional gain
+ * @param ki Integral gain
+ */
+void AttitudeFilter_Init(attitude_filter_t* filter, float kp, float ki);
+
+/**
+ * @brief Integrates one IMU sample. The step is the timestamp delta to the previous sample;
+ *        a non-increasing or implausibly long delta only re-anchors the time reference.
+ *        The gravity correction is skipped while the accelerometer is far from 1 g.
+ * @param filter Filter state
+ * @param sample Accel in m/s^2, gyro in rad/s
+ * @param timestampUs Time of the sample
+ */
+void AttitudeFilter_Update(attitude_filter_t* filter, const imu_sample_t* sample, uint64_t timestampUs);
+
+/**
+ * @brief Converts a quaternion to aerospace (ZYX) Euler angles
+ * @param q Attitude
+ * @param roll,pitch,yaw Filled with angles in rad
+ */
+void AttitudeFilter_ToEuler(const quat_t* q, float* roll, float* pitch, float* yaw);
\ No newline at end of file
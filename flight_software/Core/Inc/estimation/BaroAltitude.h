@@ -0,0 +1,74 @@
+/**
+ * Barometric altitude, ISA hypsometric formula through a precomputed piecewise cubic table
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BARO_ALT_P_MIN_PA    30000.0f  // table range, about 9 km ISA
+#define BARO_ALT_P_MAX_PA    110000.0f // about -750 m ISA
+#define BARO_ALT_SEGMENTS    64U       // cubic segments over the table range
+#define BARO_ALT_GROUND_MAX  1000U     // most samples averaged into a ground reference
+
+/**
+ * @brief Relative altitude state, one per pressure source
+ *
+ * @param groundAltitude ISA altitude of the ground reference in m
+ * @param groundFirst First pressure of the reference average, the sum is kept relative to it
+ * @param groundSum Sum of pressure deviations from groundFirst
+ * @param groundCount Samples averaged so far
+ * @param groundTarget Samples to average before the reference is set
+ * @param grounded True once the ground reference is set
+ */
+typedef struct {
+    float groundAltitude;
+    float groundFirst;
+    float groundSum;
+    uint16_t groundCount;
+    uint16_t groundTarget;
+    bool grounded;
+} baro_altitude_t;
+
+/**
+ * @brief Builds the altitude table, call once before any other BaroAltitude function
+ */
+void BaroAltitude_Init(void);
+
+/**
+ * @brief ISA altitude of a pressure, from the table inside its range and the exact formula outside
+ * @param pressurePa Static pressure in Pa
+ * @returns Altitude above the 101325 Pa level in m
+ */
+float BaroAltitude_FromPressure(float pressurePa);
+
+/**
+ * @brief Exact ISA altitude with powf, the reference the table is built from
+ * @param pressurePa Static pressure in Pa
+ * @returns Altitude above the 101325 Pa level in m
+ */
+float BaroAltitude_FromPressureExact(float pressurePa);
+
+/**
+ * @brief Starts a new ground reference, averaged over the next samples given to BaroAltitude_Update
+ * @param alt Altitude state
+ * @param nSamples Samples to average, 1 to BARO_ALT_GROUND_MAX
+ */
+void BaroAltitude_ResetGround(baro_altitude_t* alt, uint16_t nSamples);
+
+/**
+ * @brief Sets the ground reference directly
+ * @param alt Altitude state
+ * @param pressurePa Ground pressure in Pa
+ */
+void BaroAltitude_SetGround(baro_altitude_t* alt, float pressurePa);
+
+/**
+ * @brief Feeds one pressure sample. While a ground reference is averaging the sample goes into it.
+ * @param alt Altitude state
+ * @param pressurePa Static pressure in Pa
+ * @param altitudeM Set to the altitude above the ground reference in m, only when True is returned
+ * @returns False while the ground reference is not set yet
+ */
+bool BaroAltitude_Update(baro_altitude_t* alt, float pressurePa, float* altitudeM);
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+ * Rest detection and recursive gyro bias estimation, runs on every IMU sample
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IMUInterface.h"
+
+#define GYRO_BIAS_BLOCK_US      50000U    // variance block, the window slides one block at a time
+#define GYRO_BIAS_REST_BLOCKS   4U        // quiet blocks in a row before the vehicle counts as still
+#define GYRO_BIAS_GYRO_VAR_MAX  1e-4f     // (rad/s)^2 per axis within a block, about 4x MPU6500 noise
+#define GYRO_BIAS_ACCEL_VAR_MAX 0.04f     // (m/s^2)^2 per axis within a block
+#define GYRO_BIAS_RATE_MAX      0.1f      // rad/s block mean, above any plausible bias (5 dps zero rate offset)
+#define GYRO_BIAS_MEAS_VAR      1e-5f     // (rad/s)^2 gyro white noise per sample at 184 Hz bandwidth
+#define GYRO_BIAS_DRIFT_VAR     1e-8f     // (rad/s)^2 per second, bias random walk with temperature
+#define GYRO_BIAS_INIT_VAR      1e-2f     // (rad/s)^2 with nothing known about the bias
+#define GYRO_BIAS_STORED_VAR    1e-4f     // (rad/s)^2 starting from a stored bias, it moves with temperature between boots
+#define GYRO_BIAS_STORE_DELTA   0.002f    // rad/s change on any axis that makes a settled bias worth storing
+#define GYRO_BIAS_GATE_SQ       25.0f     // 5 sigma innovation gate, an outlier ends the rest
+#define GYRO_BIAS_MAX_STEP_US   100000U   // longer gaps restart detection
+
+/**
+ * @brief Estimator state, one per gyro
+ *
+ * @param bias Gyro bias in rad/s, subtract from every sample
+ * @param variance Variance of each bias axis in (rad/s)^2, the axes share one value
+ * @param ref First sample of the current block, gyro then accel, sums are taken relative to it
+ * @param sum,sumSq Sums of the current block relative to ref
+ * @param count Samples in the current block
+ * @param blockStartUs Timestamp of the first sample of the current block
+ * @param lastTimestampUs Timestamp of the previous sample
+ * @param quietBlocks Quiet blocks in a row, saturates at GYRO_BIAS_REST_BLOCKS
+ * @param atRest True while the bias is being updated
+ * @param restUpdates Samples the bias has been updated with
+ */
+typedef struct {
+    float bias[3];
+    float variance;
+    float ref[6];
+    float sum[6];
+    float sumSq[6];
+    uint32_t count;
+    uint64_t blockStartUs;
+    uint64_t lastTimestampUs;
+    uint32_t quietBlocks;
+    bool atRest;
+    uint32_t restUpdates;
+} gyro_bias_t;
+
+/**
+ * @brief Resets the detector and starts the estimate from a known bias
+ * @param est Estimator state
+ * @param bias Initial bias in rad/s, NULL for zero
+ * @param variance Confidence in it in (rad/s)^2, GYRO_BIAS_INIT_VAR when nothing is known
+ */
+void GyroBias_Init(gyro_bias_t* est, const float bias[3], float variance);
+
+/**
+ * @brief Takes one sample, constant cost. Block statistics decide rest, and while at rest every
+ *        sample updates the bias as a scalar Kalman filter per axis. A sample outside the
+ *        innovation gate ends the rest at once, so the start of a motion barely leaks in.
+ * @param est Estimator state
+ * @param sample Accel in m/s^2, gyro in rad/s, uncorrected
+ * @param timestampUs Time of the sample
+ * @returns True while at rest
+ */
+bool GyroBias_Update(gyro_bias_t* est, const imu_sample_t* sample, uint64_t timestampUs);
+
+/**
+ * @brief Removes the current bias from a sample
+ * @param est Estimator state
+ * @param sample Sample to correct in place
+ */
+static inline void GyroBias_Apply(const gyro_bias_t* est, imu_sample_t* sample) {
+    sample->gx -= est->bias[0];
+    sample->gy -= est->bias[1];
+    sample->gz -= est->bias[2];
+}
\ No newline at end of file
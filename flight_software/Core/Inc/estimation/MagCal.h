@@ -0,0 +1,77 @@
+/**
+ * Background magnetometer calibration task, refines the hard and soft iron fit from live samples
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MagCalFit.h"
+
+#define MAG_CAL_MIN_SPACING_UT 2.0f  // samples closer than this to the last accepted one are skipped
+#define MAG_CAL_MIN_SAMPLES    300U  // accepted samples before the first fit
+#define MAG_CAL_SOLVE_INTERVAL 100U  // accepted samples between fits
+#define MAG_CAL_MAX_SAMPLES    4000U // statistics are halved here so the fit follows changes
+#define MAG_CAL_FIELD_MIN_UT   20.0f // plausible Earth field strength
+#define MAG_CAL_FIELD_MAX_UT   80.0f
+#define MAG_CAL_MAX_AXIS_RATIO 1.5f
+#define MAG_CAL_MAX_RESIDUAL   0.05f
+#define MAG_CAL_STORE_UT       1.0f  // offset change that makes a new fit worth storing
+#define MAG_CAL_STORE_MATRIX   0.01f // same for any soft iron matrix element
+#define MAG_CAL_WAKE_MS        250U  // the task wakes at least this often to write queued calibration
+#define MAG_CAL_STALL_MS       500U  // no magnetometer sample for this long restarts the reads
+
+/**
+ * @brief Calibration counters
+ * @param samples Magnetometer samples seen
+ * @param accepted Samples added to the fit
+ * @param fits Fits published
+ * @param rejected Fits that failed or were implausible
+ * @param maxSolveCycles Longest solve in core cycles
+ * @param restarts Reads started after the magnetometer went quiet for MAG_CAL_STALL_MS
+ */
+typedef struct {
+    uint32_t samples;
+    uint32_t accepted;
+    uint32_t fits;
+    uint32_t rejected;
+    uint32_t maxSolveCycles;
+    uint32_t restarts;
+} mag_cal_stats_t;
+
+/**
+ * @brief Calibration worker task, woken by the magnetometer sample callback with ACQ_FLAG_MAG
+ *        and at least every MAG_CAL_WAKE_MS without it. Takes over the magnetometer sample
+ *        callback when it starts.
+ * @param argument No arguments expected
+ */
+void MagCalTask(void *argument);
+
+/**
+ * @brief Gets the coefficients in use, safe to call from any task
+ * @param calBuff Pointer to a mag_cal_t to fill, identity until the first fit or MagCal_Set
+ * @returns False while no calibration has been set or fitted
+ */
+bool MagCal_Get(mag_cal_t* calBuff);
+
+/**
+ * @brief Replaces the coefficients in use, e.g. with stored ones at boot. The background fit
+ *        keeps running and replaces them again once it has enough samples, fits that moved
+ *        away from the stored coefficients are written back to the CalStore on the ground.
+ * @param cal Coefficients to apply
+ */
+void MagCal_Set(const mag_cal_t* cal);
+
+/**
+ * @brief Corrects one sample with the coefficients in use, one 3x3 multiply
+ * @param raw Uncalibrated sample in uT
+ * @param out Corrected sample in uT, may alias raw
+ */
+void MagCal_Correct(const mag_sample_t* raw, mag_sample_t* out);
+
+/**
+ * @brief Copies the calibration counters
+ * @param stats Pointer to a mag_cal_stats_t to fill
+ */
+void MagCal_GetStats(mag_cal_stats_t* stats);
\ No newline at end of file
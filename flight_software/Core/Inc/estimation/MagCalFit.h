@@ -0,0 +1,104 @@
+/**
+ * Incremental least-squares ellipsoid fit for magnetometer hard and soft iron calibration
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MagInterface.h"
+
+#define MAG_CAL_SCALE_UT      64.0f // samples are divided by this so every term of the fit is near 1
+#define MAG_CAL_N_PARAMS      9U    // x^2 y^2 z^2 2xy 2xz 2yz 2x 2y 2z
+#define MAG_CAL_N_SUMS        45U   // packed upper triangle of the normal matrix
+#define MAG_CAL_BLOCK_SAMPLES 32U   // samples summed in single precision before folding into double
+#define MAG_CAL_PIVOT_MIN     1e-9  // smallest Cholesky pivot relative to its diagonal
+
+/**
+ * @brief Calibration coefficients, corrected = matrix * (raw - offset)
+ *
+ * @param offset Hard iron offset in uT
+ * @param matrix Soft iron correction, symmetric with unit determinant so the field strength is kept
+ * @param fieldUt Radius of the corrected sphere, the local field strength
+ * @param axisRatio Longest over shortest axis of the fitted ellipsoid
+ * @param residual RMS algebraic residual of the fit, about twice the relative radius error
+ */
+typedef struct {
+    float offset[3];
+    float matrix[3][3];
+    float fieldUt;
+    float axisRatio;
+    float residual;
+} mag_cal_t;
+
+/**
+ * @brief Sufficient statistics of the fit, constant size however many samples are added
+ *
+ * @param ata Sum of phi * phi^T over folded blocks, packed upper triangle
+ * @param atb Sum of phi over folded blocks
+ * @param n Weight of the folded samples
+ * @param blockAta Running single precision sums of the current block
+ * @param blockAtb Running single precision sums of the current block
+ * @param blockCount Samples in the current block
+ */
+typedef struct {
+    double ata[MAG_CAL_N_SUMS];
+    double atb[MAG_CAL_N_PARAMS];
+    double n;
+    float blockAta[MAG_CAL_N_SUMS];
+    float blockAtb[MAG_CAL_N_PARAMS];
+    uint32_t blockCount;
+} mag_cal_fit_t;
+
+/**
+ * @brief Clears the statistics
+ * @param fit Fit state
+ */
+void MagCalFit_Reset(mag_cal_fit_t* fit);
+
+/**
+ * @brief Adds one raw sample to the statistics
+ * @param fit Fit state
+ * @param sample Uncalibrated sample in uT
+ */
+void MagCalFit_Add(mag_cal_fit_t* fit, const mag_sample_t* sample);
+
+/**
+ * @brief Scales the weight of everything added so far, older samples fade as new ones arrive
+ * @param fit Fit state
+ * @param factor Weight multiplier, 0 to 1
+ */
+void MagCalFit_Scale(mag_cal_fit_t* fit, double factor);
+
+/**
+ * @brief Weight of the samples in the statistics
+ * @param fit Fit state
+ * @returns Sample count, reduced by any scaling
+ */
+uint32_t MagCalFit_Count(const mag_cal_fit_t* fit);
+
+/**
+ * @brief Solves the normal equations for the general ellipsoid and turns it into offset and
+ *        soft iron matrix. Runs in double precision, meant for a background task.
+ * @param fit Fit state, left unchanged so more samples can be added
+ * @param cal Coefficients to fill
+ * @returns False if the samples do not span an ellipsoid (too little rotation) or the
+ *          quadric found is not one
+ */
+bool MagCalFit_Solve(const mag_cal_fit_t* fit, mag_cal_t* cal);
+
+/**
+ * @brief Applies calibration coefficients to one sample
+ * @param cal Coefficients
+ * @param raw Uncalibrated sample in uT
+ * @param out Corrected sample in uT, may alias raw
+ */
+static inline void MagCalFit_Apply(const mag_cal_t* cal, const mag_sample_t* raw, mag_sample_t* out) {
+    float x = raw->mx - cal->offset[0];
+    float y = raw->my - cal->offset[1];
+    float z = raw->mz - cal->offset[2];
+    out->mx = cal->matrix[0][0] * x + cal->matrix[0][1] * y + cal->matrix[0][2] * z;
+    out->my = cal->matrix[1][0] * x + cal->matrix[1][1] * y + cal->matrix[1][2] * z;
+    out->mz = cal->matrix[2][0] * x + cal->matrix[2][1] * y + cal->matrix[2][2] * z;
+}
\ No newline at end of file
@@ -10,7 +10,10 @@
 
 typedef struct {
     UART_HandleTypeDef* p_huart1;
+    UART_HandleTypeDef* p_huart2;
+    SPI_HandleTypeDef* p_hspi1;
     SPI_HandleTypeDef* p_hspi2;
+    SPI_HandleTypeDef* p_hspi3;
 } SystemHardwareHandles_t;
 
 /**
@@ -57,6 +57,19 @@ void Error_Handler(void);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
+#define BARO_CS_Pin GPIO_PIN_4
+#define BARO_CS_GPIO_Port GPIOA
+#define MAG_DRDY_Pin GPIO_PIN_4
+#define MAG_DRDY_GPIO_Port GPIOC
+#define MAG_DRDY_EXTI_IRQn EXTI4_IRQn
+#define BARO_INT_Pin GPIO_PIN_0
+#define BARO_INT_GPIO_Port GPIOB
+#define BARO_INT_EXTI_IRQn EXTI0_IRQn
+#define IMU_INT_Pin GPIO_PIN_1
+#define IMU_INT_GPIO_Port GPIOB
+#define IMU_INT_EXTI_IRQn EXTI1_IRQn
+#define MAG_CS_Pin GPIO_PIN_15
+#define MAG_CS_GPIO_Port GPIOA
 
 /* USER CODE BEGIN Private defines */
 
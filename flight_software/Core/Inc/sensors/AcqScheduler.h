@@ -0,0 +1,77 @@
+/**
+ * Fixed-rate sensor acquisition scheduler, paced by the IMU data-ready interrupt
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+#include "IMUInterface.h"
+
+#define ACQ_MAX_SUBSCRIBERS 8U
+
+// Largest FIFO batch, the FIFO holds 41 frames before it counts as overflowed and half of that
+// is left for a drain that starts late
+#define ACQ_MAX_FIFO_BATCH 20U
+
+// Thread flags for acquisition driven work, one bit per kind. Only IMU work is paced here,
+// the magnetometer and barometer pace themselves on their own data-ready lines.
+#define ACQ_FLAG_IMU  0x0100U
+#define ACQ_FLAG_MAG  0x0200U
+
+/**
+ * @brief Scheduler timing counters
+ * @param edges Data-ready edges seen
+ * @param samples Samples published by the IMU and dispatched to subscribers
+ * @param overruns Reads that found the previous one still in flight
+ * @param maxJitterUs Largest deviation of an edge interval from the IMU sample period
+ */
+typedef struct {
+    uint32_t edges;
+    uint32_t samples;
+    uint32_t overruns;
+    uint32_t maxJitterUs;
+} acq_stats_t;
+
+/**
+ * @brief Initializes the scheduler and takes over the IMU sample and batch callbacks. The
+ *        nominal period is the sample clock the driver actually configured. Must be called
+ *        after Imu_Init and before the kernel starts.
+ * @param fifoBatch Samples per IMU read. 1 reads every sample on its own data-ready edge, more
+ *        enables the device FIFO and drains it on every fifoBatch-th edge, which pays the SPI
+ *        setup and the subscriber wakeups once per batch at high sample rates.
+ * @returns True on success, False if the IMU is not initialized or the batch is out of range
+ */
+bool AcqScheduler_Init(uint16_t fifoBatch);
+
+/**
+ * @brief Wakes a task on every IMU read, each sample or each FIFO batch, from the IMU transfer
+ *        complete ISR. Must be called before AcqScheduler_Start.
+ * @param thread Task to notify
+ * @param flags Thread flags to set, e.g. ACQ_FLAG_IMU
+ * @returns False if the subscriber table is full
+ */
+bool AcqScheduler_Subscribe(osThreadId_t thread, uint32_t flags);
+
+/**
+ * @brief Enables the IMU data-ready interrupt, sampling starts with the next edge.
+ *        Must be called before the kernel starts.
+ * @returns True on success, False otherwise
+ */
+bool AcqScheduler_Start(void);
+
+/**
+ * @brief Data-ready edge handler, called from the IMU INT EXTI ISR (or a simulated clock).
+ *        Starts the sample read or FIFO drain when one is due, subscribers are woken once it
+ *        completes.
+ * @param timestampUs Time of the edge
+ */
+void AcqScheduler_OnDataReady(uint64_t timestampUs);
+
+/**
+ * @brief Copies the scheduler timing counters
+ * @param stats Pointer to an acq_stats_t to fill
+ */
+void AcqScheduler_GetStats(acq_stats_t* stats);
\ No newline at end of file
@@ -0,0 +1,142 @@
+/**
+ * Bosch BMP280 and BMP388 pressure and temperature compensation
+ *
+ * Each sensor has the datasheet integer algorithm, bit exact with the Bosch reference code,
+ * and a single precision float variant for callers that want SI floats without double math.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define BMP280_CALIB_REG 0x88U // dig_T1 LSB
+#define BMP280_CALIB_LEN 24U   // dig_T1 .. dig_P9
+#define BMP388_CALIB_REG 0x31U // NVM_PAR_T1 LSB
+#define BMP388_CALIB_LEN 21U   // NVM_PAR_T1 .. NVM_PAR_P11
+
+/**
+ * @brief BMP280 trimming parameters as stored in the device, see datasheet 3.11.2
+ */
+typedef struct {
+    uint16_t T1;
+    int16_t T2;
+    int16_t T3;
+    uint16_t P1;
+    int16_t P2;
+    int16_t P3;
+    int16_t P4;
+    int16_t P5;
+    int16_t P6;
+    int16_t P7;
+    int16_t P8;
+    int16_t P9;
+} bmp280_calib_t;
+
+/**
+ * @brief BMP388 calibration, the NVM coefficients for the integer algorithm and their
+ *        scaled float forms (datasheet 9.1) for the float algorithm
+ */
+typedef struct {
+    uint16_t T1;
+    uint16_t T2;
+    int8_t T3;
+    int16_t P1;
+    int16_t P2;
+    int8_t P3;
+    int8_t P4;
+    uint16_t P5;
+    uint16_t P6;
+    int8_t P7;
+    int8_t P8;
+    int16_t P9;
+    int8_t P10;
+    int8_t P11;
+
+    float parT[3];
+    float parP[11];
+} bmp388_calib_t;
+
+/**
+ * @brief Decodes the BMP280 trimming registers
+ * @param raw BMP280_CALIB_LEN bytes read from BMP280_CALIB_REG
+ * @param calib Pointer to a bmp280_calib_t to fill
+ */
+void Bmp280_ParseCalib(const uint8_t raw[BMP280_CALIB_LEN], bmp280_calib_t* calib);
+
+/**
+ * @brief Datasheet 32-bit integer temperature compensation
+ * @param calib Trimming parameters
+ * @param adcT 20-bit raw temperature
+ * @param tFine Set to the fine temperature the pressure compensation needs
+ * @returns Temperature in 0.01 degC
+ */
+int32_t Bmp280_CompensateTemp(const bmp280_calib_t* calib, int32_t adcT, int32_t* tFine);
+
+/**
+ * @brief Datasheet 64-bit integer pressure compensation
+ * @param calib Trimming parameters
+ * @param adcP 20-bit raw pressure
+ * @param tFine Fine temperature from Bmp280_CompensateTemp of the same measurement
+ * @returns Pressure in Pa as unsigned Q24.8, 0 on invalid trimming
+ */
+uint32_t Bmp280_CompensatePressure(const bmp280_calib_t* calib, int32_t adcP, int32_t tFine);
+
+/**
+ * @brief Single precision temperature compensation
+ * @param calib Trimming parameters
+ * @param adcT 20-bit raw temperature
+ * @param tFine Set to the fine temperature the pressure compensation needs
+ * @returns Temperature in degC
+ */
+float Bmp280_CompensateTempF(const bmp280_calib_t* calib, int32_t adcT, float* tFine);
+
+/**
+ * @brief Single precision pressure compensation
+ * @param calib Trimming parameters
+ * @param adcP 20-bit raw pressure
+ * @param tFine Fine temperature from Bmp280_CompensateTempF of the same measurement
+ * @returns Pressure in Pa, 0 on invalid trimming
+ */
+float Bmp280_CompensatePressureF(const bmp280_calib_t* calib, int32_t adcP, float tFine);
+
+/**
+ * @brief Decodes the BMP388 calibration registers and precomputes the float coefficients
+ * @param raw BMP388_CALIB_LEN bytes read from BMP388_CALIB_REG
+ * @param calib Pointer to a bmp388_calib_t to fill
+ */
+void Bmp388_ParseCalib(const uint8_t raw[BMP388_CALIB_LEN], bmp388_calib_t* calib);
+
+/**
+ * @brief Bosch BMP3 integer temperature compensation
+ * @param calib Calibration
+ * @param adcT 24-bit raw temperature
+ * @param tLin Set to the linearized temperature the pressure compensation needs
+ * @returns Temperature in 0.01 degC
+ */
+int32_t Bmp388_CompensateTemp(const bmp388_calib_t* calib, uint32_t adcT, int64_t* tLin);
+
+/**
+ * @brief Bosch BMP3 integer pressure compensation
+ * @param calib Calibration
+ * @param adcP 24-bit raw pressure
+ * @param tLin Linearized temperature from Bmp388_CompensateTemp of the same measurement
+ * @returns Pressure in 0.01 Pa
+ */
+uint32_t Bmp388_CompensatePressure(const bmp388_calib_t* calib, uint32_t adcP, int64_t tLin);
+
+/**
+ * @brief Single precision temperature compensation, datasheet 9.2
+ * @param calib Calibration
+ * @param adcT 24-bit raw temperature
+ * @returns Temperature in degC, also the linearized temperature for the pressure compensation
+ */
+float Bmp388_CompensateTempF(const bmp388_calib_t* calib, uint32_t adcT);
+
+/**
+ * @brief Single precision pressure compensation, datasheet 9.3
+ * @param calib Calibration
+ * @param adcP 24-bit raw pressure
+ * @param tLin Temperature from Bmp388_CompensateTempF of the same measurement
+ * @returns Pressure in Pa
+ */
+float Bmp388_CompensatePressureF(const bmp388_calib_t* calib, uint32_t adcP, float tLin);
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * Defines interface for an abstract barometer device
+ */
+
+#pragma once
+
+#include "SystemInitializer.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief A single compensated barometer sample
+ *
+ * @param pressure Static pressure in Pa
+ * @param temperature Die temperature in degC
+ */
+typedef struct {
+    float pressure;
+    float temperature;
+} baro_sample_t;
+
+/**
+ * @brief A repository for a sample of barometer data at a specific point in time
+ *
+ * @param seq_n A monotonic sequence number increasing with every sample collected
+ * @param timestamp The timestamp in microseconds since system boot, the data-ready edge when there is one
+ */
+typedef struct {
+    baro_sample_t data;
+    uint32_t seq_n;
+    uint64_t timestamp_us;
+} baro_repo_t;
+
+/**
+ * @brief Consumer of individual samples, called from the transfer complete ISR after
+ *        the sample is published. The repo is only valid for the duration of the call.
+ */
+typedef void (*baro_sample_callback_t)(const baro_repo_t* repo);
+
+/**
+ * @brief Initialize the barometer and start continuous measurements, must be called before the kernel starts
+ *
+ * @param rate Output data rate in Hz, rounded down to the nearest rate the device supports
+ * @returns True on success, False otherwise
+ */
+bool Baro_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate);
+
+/**
+ * @brief Starts a non-blocking burst read of the data registers,
+ *        the sample is published from the transfer complete ISR
+ *
+ * @returns True if the transfer was started, False if one is still in flight or the bus refused it
+ */
+bool Baro_StartRead(void);
+
+/**
+ * @brief Data-ready edge handler, called from the baro INT EXTI ISR. Starts a read stamped with the edge time.
+ *
+ * @param timestampUs Time of the edge
+ */
+void Baro_OnDataReady(uint64_t timestampUs);
+
+/**
+ * @brief Routes the device data-ready signal to its INT pin, must be called before the kernel starts
+ *
+ * @param enable True to raise INT when a new measurement is ready
+ * @returns True on success, False otherwise
+ */
+bool Baro_SetDataReadyInterrupt(bool enable);
+
+/**
+ * @brief Get the latest published barometer repository (sample, sequence number and timestamp)
+ *
+ * @param repoBuff Pointer to a baro_repo_t to fill
+ * @returns False if no sample has been published yet
+ */
+bool Baro_GetRepo(baro_repo_t* repoBuff);
+
+/**
+ * @brief Registers the consumer of individual samples
+ *
+ * @param callback Function called with every published sample, NULL to disable
+ */
+void Baro_SetSampleCallback(baro_sample_callback_t callback);
+
+/**
+ * @brief Bus transfer complete handler, called from the completion ISR of the baro bus
+ */
+void Baro_OnTransferComplete(void);
+
+/**
+ * @brief Bus error handler, called from the error ISR of the baro bus
+ */
+void Baro_OnTransferError(void);
\ No newline at end of file
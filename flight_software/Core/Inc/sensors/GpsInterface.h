@@ -0,0 +1,101 @@
+/**
+ * Defines interface for an abstract GPS receiver
+ */
+
+#pragma once
+
+#include "SystemInitializer.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief A single position fix
+ *
+ * @param lat_e7,lon_e7 Latitude and longitude in 1e-7 degrees, north and east positive
+ * @param altMsl Altitude above mean sea level in m
+ * @param hdop Horizontal dilution of precision
+ * @param timeOfDayMs UTC time of the fix in ms since midnight
+ * @param fixQuality 0 no fix, 1 GPS, 2 differential, 6 dead reckoning
+ * @param numSats Satellites used in the fix
+ */
+typedef struct {
+    int32_t lat_e7;
+    int32_t lon_e7;
+    float altMsl;
+    float hdop;
+    uint32_t timeOfDayMs;
+    uint8_t fixQuality;
+    uint8_t numSats;
+} gps_fix_t;
+
+/**
+ * @brief A repository for a fix at a specific point in time
+ *
+ * @param seq_n A monotonic sequence number increasing with every fix parsed
+ * @param timestamp The timestamp in microseconds since system boot, the end of the burst that carried the fix
+ */
+typedef struct {
+    gps_fix_t data;
+    uint32_t seq_n;
+    uint64_t timestamp_us;
+} gps_repo_t;
+
+/**
+ * @brief Receiver counters
+ * @param rxBytes Bytes received
+ * @param rxEvents Receive interrupts, about one per burst plus two per lap of the DMA buffer
+ * @param sentences Sentences with a valid checksum
+ * @param checksumErrors Sentences that failed their checksum, line errors end up here
+ * @param dropped Bytes overwritten by the DMA before the task read them
+ * @param restarts Times the receive DMA had stopped and was started again
+ */
+typedef struct {
+    uint32_t rxBytes;
+    uint32_t rxEvents;
+    uint32_t sentences;
+    uint32_t checksumErrors;
+    uint32_t dropped;
+    uint32_t restarts;
+} gps_stats_t;
+
+/**
+ * @brief Initialize the receiver state, must be called before the kernel starts. The module is
+ *        expected to already send NMEA at the baud rate of the UART.
+ *
+ * @returns True on success, False otherwise
+ */
+bool Gps_Init(SystemHardwareHandles_t hardwareHandles);
+
+/**
+ * @brief Starts the circular receive DMA, bytes are kept from here on
+ *
+ * @returns True on success, False otherwise
+ */
+bool Gps_Start(void);
+
+/**
+ * @brief Parses what the DMA received and publishes every GGA fix, woken by the receive events
+ */
+void GpsTask(void *argument);
+
+/**
+ * @brief Get the latest published GPS repository (fix, sequence number and timestamp)
+ *
+ * @param repoBuff Pointer to a gps_repo_t to fill
+ * @returns False if no fix has been published yet
+ */
+bool Gps_GetRepo(gps_repo_t* repoBuff);
+
+/**
+ * @brief Copies the receiver counters
+ * @param stats Pointer to a gps_stats_t to fill
+ */
+void Gps_GetStats(gps_stats_t* stats);
+
+/**
+ * @brief Receive event handler, called from HAL_UARTEx_RxEventCallback of the GPS UART
+ *
+ * @param pos DMA position in the receive buffer
+ * @param timestampUs Time of the event
+ */
+void Gps_OnRxEvent(uint16_t pos, uint64_t timestampUs);
\ No newline at end of file
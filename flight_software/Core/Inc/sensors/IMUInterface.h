@@ -1,12 +1,18 @@
 /**
  * Defines interface for an abstract IMU device
  */
+
+#pragma once
+
 #include "SystemInitializer.h"
 #include <stdint.h>
 #include <stdbool.h>
 
 /**
- * @brief A single sample of raw IMU data
+ * @brief A single sample of IMU data in SI units
+ *
+ * @param ax,ay,az Acceleration in m/s^2
+ * @param gx,gy,gz Angular rate in rad/s
  */
 typedef struct {
     float ax;
@@ -19,9 +25,9 @@ typedef struct {
 
 /**
  * @brief A repository for a sample of IMU data at a specific point in time
- * 
+ *
  * @param seq_n A monotonic sequence number increasing with every sample collected
- * @param timestamp The timestamp in microseconds since system boot 
+ * @param timestamp The timestamp in microseconds since system boot
  */
 typedef struct {
     imu_sample_t data;
@@ -29,16 +35,153 @@ typedef struct {
     uint64_t timestamp_us;
 } imu_repo_t;
 
+/**
+ * @brief Stored calibration of the IMU, applied during raw conversion
+ *
+ * @param accelBias,gyroBias Sensor frame offsets in LSB
+ * @param accelGain Per axis accelerometer scale correction in the sensor frame, 1 when nominal
+ */
+typedef struct {
+    int16_t accelBias[3];
+    int16_t gyroBias[3];
+    float accelGain[3];
+} imu_cal_t;
+
+/**
+ * @brief Maximum number of samples delivered in a single FIFO batch
+ */
+#define IMU_BATCH_MAX_SAMPLES 42
+
+/**
+ * @brief A batch of IMU samples drained from the device FIFO, oldest first. Samples are stored
+ *        as one array per axis so batch consumers stream every axis with unit stride.
+ *
+ * @param ax,ay,az,gx,gy,gz Axis arrays in SI units, see imu_sample_t
+ * @param first_seq_n Sequence number of samples[0], following samples increment by one
+ * @param first_timestamp_us Timestamp of samples[0], back-interpolated from the batch arrival time
+ * @param sample_period_us Time between consecutive samples
+ * @param count Number of valid samples
+ * @param overflowed True if the FIFO overflowed before this batch and samples were lost
+ */
+typedef struct {
+    float ax[IMU_BATCH_MAX_SAMPLES];
+    float ay[IMU_BATCH_MAX_SAMPLES];
+    float az[IMU_BATCH_MAX_SAMPLES];
+    float gx[IMU_BATCH_MAX_SAMPLES];
+    float gy[IMU_BATCH_MAX_SAMPLES];
+    float gz[IMU_BATCH_MAX_SAMPLES];
+    uint32_t first_seq_n;
+    uint64_t first_timestamp_us;
+    uint32_t sample_period_us;
+    uint16_t count;
+    bool overflowed;
+} imu_batch_t;
+
+/**
+ * @brief Consumer of FIFO batches, called from the transfer complete ISR.
+ *        The batch is only valid for the duration of the call.
+ */
+typedef void (*imu_batch_callback_t)(const imu_batch_t* batch);
+
+/**
+ * @brief Consumer of individual samples, called from the transfer complete ISR after
+ *        the sample is published. The repo is only valid for the duration of the call.
+ */
+typedef void (*imu_sample_callback_t)(const imu_repo_t* repo);
+
 /**
  * @brief Initialize the IMU device
- * 
- * @param rate Rate of IMU collection in Hz
+ *
+ * @param rate Rate of IMU collection in Hz, a rate the device clock cannot produce exactly is rejected
+ * @returns True on success, False otherwise
  */
 bool Imu_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate);
 
 /**
- * @brief Get a sample of IMU data
- * 
+ * @brief Gets the period of the device sample clock, as configured by Imu_Init
+ *
+ * @returns Microseconds between samples, 0 before a successful Imu_Init
+ */
+uint32_t Imu_GetSamplePeriodUs(void);
+
+/**
+ * @brief Applies a stored calibration and mounting rotation, must be called before the kernel starts
+ *
+ * @param cal Offsets and scale corrections, NULL for none
+ * @param rotation Sensor to body rotation, row major, NULL for identity
+ * @returns True on success, False if a transfer is in flight
+ */
+bool Imu_SetCalibration(const imu_cal_t* cal, const float rotation[9]);
+
+/**
+ * @brief Starts a non-blocking burst read of the IMU data registers,
+ *        the sample is published from the transfer complete ISR
+ *
+ * @returns True if the transfer was started, False if one is still in flight or the bus refused it
+ */
+bool Imu_StartRead(void);
+
+/**
+ * @brief Get the latest published sample of IMU data
+ *
  * @param imuBuff Pointer to an imu_sample_t to fill with data
  */
-void Imu_GetSample(imu_sample_t* imuBuff);
\ No newline at end of file
+void Imu_GetSample(imu_sample_t* imuBuff);
+
+/**
+ * @brief Get the latest published IMU repository (sample, sequence number and timestamp)
+ *
+ * @param repoBuff Pointer to an imu_repo_t to fill
+ * @returns False if no sample has been published yet
+ */
+bool Imu_GetRepo(imu_repo_t* repoBuff);
+
+/**
+ * @brief Enables or disables the device FIFO, must be called before the kernel starts
+ *
+ * @param enable True to buffer accel and gyro frames in the FIFO
+ * @returns True on success, False otherwise
+ */
+bool Imu_SetFifoMode(bool enable);
+
+/**
+ * @brief Routes the device data-ready signal to its INT pin, must be called before the kernel starts.
+ *        The pin pulses high for every new sample at the configured rate.
+ *
+ * @param enable True to raise INT on data ready
+ * @returns True on success, False otherwise
+ */
+bool Imu_SetDataReadyInterrupt(bool enable);
+
+/**
+ * @brief Registers the consumer of individual samples
+ *
+ * @param callback Function called with every published sample, NULL to disable
+ */
+void Imu_SetSampleCallback(imu_sample_callback_t callback);
+
+/**
+ * @brief Registers the consumer of FIFO batches
+ *
+ * @param callback Function called with every drained batch, NULL to disable
+ */
+void Imu_SetBatchCallback(imu_batch_callback_t callback);
+
+/**
+ * @brief Starts a non-blocking drain of the device FIFO. Reads FIFO_COUNT,
+ *        then all complete frames in one transfer, and hands them to the batch callback.
+ *        An overflowed or misaligned FIFO is reset and the next batch is flagged.
+ *
+ * @returns True if the drain was started, False if a transfer is still in flight or FIFO mode is off
+ */
+bool Imu_StartFifoDrain(void);
+
+/**
+ * @brief Bus transfer complete handler, called from the completion ISR of the IMU bus
+ */
+void Imu_OnTransferComplete(void);
+
+/**
+ * @brief Bus error handler, called from the error ISR of the IMU bus
+ */
+void Imu_OnTransferError(void);
@@ -0,0 +1,87 @@
+/**
+ * Raw to SI conversion of MPU6500 sample frames, single samples and whole FIFO batches
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "IMUInterface.h"
+
+#define IMU_FRAME_BYTES 12U // 6 accel + 6 gyro, 16bit big endian
+
+/**
+ * @brief Conversion constants, prepared by ImuConvert_Init and ImuConvert_SetBias
+ *
+ * @param accelBias,gyroBias Sensor frame offsets in LSB, subtracted before scaling
+ * @param biasPacked The same offsets two per word for the SIMD path: [ax ay] [gx gy] [az gz]
+ * @param accelMat,gyroMat Sensor to body rotation with the LSB scale folded in, row major
+ */
+typedef struct {
+    int16_t accelBias[3];
+    int16_t gyroBias[3];
+    uint32_t biasPacked[3];
+    float accelMat[9];
+    float gyroMat[9];
+} imu_convert_t;
+
+/**
+ * @brief Prepares a converter, biases start at zero
+ *
+ * @param conv Converter to fill
+ * @param accelScale Accelerometer LSB to m/s^2
+ * @param gyroScale Gyro LSB to rad/s
+ * @param rotation Sensor to body rotation, row major, NULL for identity
+ */
+void ImuConvert_Init(imu_convert_t* conv, float accelScale, float gyroScale, const float rotation[9]);
+
+/**
+ * @brief Sets the sensor offsets removed from every raw reading. Not atomic against a
+ *        conversion in progress, call with the sample interrupt path idle.
+ *
+ * @param conv Converter to update
+ * @param accelBias Accelerometer offsets in LSB, NULL for zero
+ * @param gyroBias Gyro offsets in LSB, NULL for zero
+ */
+void ImuConvert_SetBias(imu_convert_t* conv, const int16_t accelBias[3], const int16_t gyroBias[3]);
+
+/**
+ * @brief Scales the accelerometer sensor axes before rotation, call after ImuConvert_Init.
+ *        Same caveat as ImuConvert_SetBias.
+ *
+ * @param conv Converter to update
+ * @param gain Per axis scale correction
+ */
+void ImuConvert_SetAccelGain(imu_convert_t* conv, const float gain[3]);
+
+/**
+ * @brief Converts one sample from its accel and gyro register bursts
+ *
+ * @param conv Converter
+ * @param accel 6 bytes of big endian accel registers, any alignment
+ * @param gyro 6 bytes of big endian gyro registers, any alignment
+ * @param sample Pointer to an imu_sample_t to fill
+ */
+void ImuConvert_Sample(const imu_convert_t* conv, const uint8_t* accel, const uint8_t* gyro, imu_sample_t* sample);
+
+/**
+ * @brief Converts consecutive FIFO frames into an array of samples, the same arithmetic as
+ *        ImuConvert_Batch with the array of structures layout
+ *
+ * @param conv Converter
+ * @param frames count frames of IMU_FRAME_BYTES, accel then gyro, any alignment
+ * @param count Number of frames
+ * @param samples count samples to fill
+ */
+void ImuConvert_Samples(const imu_convert_t* conv, const uint8_t* frames, uint16_t count, imu_sample_t* samples);
+
+/**
+ * @brief Converts consecutive FIFO frames into the axis arrays of a batch. Only the
+ *        sample arrays are written, the caller fills in the rest of the batch.
+ *
+ * @param conv Converter
+ * @param frames count frames of IMU_FRAME_BYTES, accel then gyro, any alignment
+ * @param count Number of frames, at most IMU_BATCH_MAX_SAMPLES
+ * @param batch Batch whose first count entries of every axis array are filled
+ */
+void ImuConvert_Batch(const imu_convert_t* conv, const uint8_t* frames, uint16_t count, imu_batch_t* batch);
\ No newline at end of file
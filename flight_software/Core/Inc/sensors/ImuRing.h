@@ -0,0 +1,53 @@
+/**
+ * Lock-free single producer / multi consumer ring of IMU samples
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IMUInterface.h"
+
+#define IMU_RING_SIZE 64U // must be a power of 2
+
+/**
+ * @brief Per-consumer read state, each reader owns one
+ *
+ * @param cursor Ring position of the next sample to read
+ * @param last_seq_n Sequence number of the last sample returned
+ * @param missed Number of samples lost to ring overruns or upstream gaps in seq_n
+ */
+typedef struct {
+    uint32_t cursor;
+    uint32_t last_seq_n;
+    uint32_t missed;
+} imu_ring_reader_t;
+
+/**
+ * @brief Clears the ring, must be called before the producer starts
+ */
+void ImuRing_Init(void);
+
+/**
+ * @brief Publishes a sample, safe to call from the IMU ISR.
+ *        There must only ever be one producer.
+ * @param repo Sample to copy into the ring
+ */
+void ImuRing_Publish(const imu_repo_t* repo);
+
+/**
+ * @brief Attaches a reader to the ring, starting after the newest published sample
+ * @param reader Reader state to initialize
+ */
+void ImuRing_ReaderInit(imu_ring_reader_t* reader);
+
+/**
+ * @brief Reads the next sample for this reader without blocking the producer.
+ *        If the producer has lapped the reader, it skips ahead to the oldest intact sample
+ *        and the loss shows up in reader->missed.
+ * @param reader Reader state
+ * @param repoBuff Pointer to an imu_repo_t to fill
+ * @returns True if a sample was read, False if the reader is caught up
+ */
+bool ImuRing_Read(imu_ring_reader_t* reader, imu_repo_t* repoBuff);
@@ -0,0 +1,94 @@
+/**
+ * Defines interface for an abstract magnetometer device
+ */
+
+#pragma once
+
+#include "SystemInitializer.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief A single magnetometer sample in the sensor frame
+ *
+ * @param mx,my,mz Magnetic flux density in uT, uncalibrated
+ */
+typedef struct {
+    float mx;
+    float my;
+    float mz;
+} mag_sample_t;
+
+/**
+ * @brief A repository for a sample of magnetometer data at a specific point in time
+ *
+ * @param seq_n A monotonic sequence number increasing with every sample collected
+ * @param timestamp The timestamp in microseconds since system boot, the data-ready edge when there is one
+ */
+typedef struct {
+    mag_sample_t data;
+    uint32_t seq_n;
+    uint64_t timestamp_us;
+} mag_repo_t;
+
+/**
+ * @brief Consumer of individual samples, called from the transfer complete ISR after
+ *        the sample is published. The repo is only valid for the duration of the call.
+ */
+typedef void (*mag_sample_callback_t)(const mag_repo_t* repo);
+
+/**
+ * @brief Initialize the magnetometer and start continuous measurements, must be called before the kernel starts
+ *
+ * @param rate Output data rate in Hz, rounded up to the nearest rate the device supports (at most 100 Hz)
+ * @returns True on success, False otherwise
+ */
+bool Mag_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate);
+
+/**
+ * @brief Starts a non-blocking burst read of the output registers,
+ *        the sample is published from the transfer complete ISR
+ *
+ * @returns True if the transfer was started, False if one is still in flight or the bus refused it
+ */
+bool Mag_StartRead(void);
+
+/**
+ * @brief Data-ready edge handler, called from the mag DRDY EXTI ISR. Starts a read stamped with the edge time.
+ *
+ * @param timestampUs Time of the edge
+ */
+void Mag_OnDataReady(uint64_t timestampUs);
+
+/**
+ * @brief Routes the device data-ready signal to its DRDY pin, must be called before the kernel starts
+ *
+ * @param enable True to raise DRDY when a new measurement is ready
+ * @returns True on success, False otherwise
+ */
+bool Mag_SetDataReadyInterrupt(bool enable);
+
+/**
+ * @brief Get the latest published magnetometer repository (sample, sequence number and timestamp)
+ *
+ * @param repoBuff Pointer to a mag_repo_t to fill
+ * @returns False if no sample has been published yet
+ */
+bool Mag_GetRepo(mag_repo_t* repoBuff);
+
+/**
+ * @brief Registers the consumer of individual samples
+ *
+ * @param callback Function called with every published sample, NULL to disable
+ */
+void Mag_SetSampleCallback(mag_sample_callback_t callback);
+
+/**
+ * @brief Bus transfer complete handler, called from the TX and RX completion ISRs of the mag bus
+ */
+void Mag_OnTransferComplete(void);
+
+/**
+ * @brief Bus error handler, called from the error ISR of the mag bus
+ */
+void Mag_OnTransferError(void);
\ No newline at end of file
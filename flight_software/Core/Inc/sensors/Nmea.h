@@ -0,0 +1,72 @@
+/**
+ * NMEA 0183 sentence assembly and GGA parsing, one byte at a time straight off the UART
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "GpsInterface.h"
+
+#define NMEA_MAX_LEN 96U // 82 by the standard with '$' and CRLF, longer u-blox PUBX lines are skipped
+
+typedef enum {
+    NMEA_IDLE = 0,  // waiting for '$'
+    NMEA_BODY,      // between '$' and '*'
+    NMEA_CK_HIGH,
+    NMEA_CK_LOW
+} nmea_state_t;
+
+/**
+ * @brief Assembler state, one per stream
+ *
+ * @param line The last complete sentence between '$' and '*', NUL terminated
+ * @param len Characters in line so far
+ * @param checksum XOR of the characters so far
+ * @param expected Checksum sent with the sentence
+ * @param state Where in a sentence the stream is
+ * @param sentences,checksumErrors,overlong Counters
+ */
+typedef struct {
+    char line[NMEA_MAX_LEN + 1U];
+    uint32_t len;
+    uint8_t checksum;
+    uint8_t expected;
+    nmea_state_t state;
+    uint32_t sentences;
+    uint32_t checksumErrors;
+    uint32_t overlong;
+} nmea_parser_t;
+
+/**
+ * @brief Clears the assembler and its counters
+ * @param parser Assembler state
+ */
+void Nmea_Init(nmea_parser_t* parser);
+
+/**
+ * @brief Drops a partial sentence, for a gap in the stream. Counters are kept.
+ * @param parser Assembler state
+ */
+void Nmea_Reset(nmea_parser_t* parser);
+
+/**
+ * @brief Takes one byte. The checksum is accumulated on the way, so a complete sentence costs
+ *        no second pass. '$' always starts over, and anything outside printable ASCII ends the
+ *        sentence, so UBX binary frames in the stream fall out without matching.
+ * @param parser Assembler state
+ * @param c Received byte
+ * @returns True when c completed a sentence with a valid checksum, it is in parser->line
+ *          until the next '$'
+ */
+bool Nmea_Push(nmea_parser_t* parser, uint8_t c);
+
+/**
+ * @brief Parses a GGA sentence from any talker (GP, GN, GL...). Integer arithmetic only, the
+ *        position keeps all five decimals of the minutes the NEO-8M sends.
+ * @param line Sentence without '$' and checksum, as left by Nmea_Push
+ * @param fix Fix to fill, fields left empty by the receiver are zero
+ * @returns False if the sentence is not a GGA or a field is malformed, the fix is then untouched
+ */
+bool Nmea_ParseGga(const char* line, gps_fix_t* fix);
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ * Sensor calibration store in two reserved flash sectors, loaded at boot instead of calibrating
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IMUInterface.h"
+#include "MagCalFit.h"
+
+#define CAL_STORE_SECTOR0 FLASH_SECTOR_10 // 128 KB at 0x080C0000, CALIB in STM32F405XX_FLASH.ld
+#define CAL_STORE_SECTOR1 FLASH_SECTOR_11 // 128 KB at 0x080E0000, right after it
+#define CAL_STORE_SIZE    (128U * 1024U)  // per sector
+#define CAL_STORE_VERSION 2U              // bump whenever cal_data_t changes layout
+#define CAL_STORE_MAGIC   0x4C414346U     // "FCAL"
+#define CAL_STORE_RECENT  4U              // newest records tried in turn when the last one is corrupt
+
+// Parts of a record that hold a calibration, the rest is left at defaults
+#define CAL_VALID_IMU     0x01U
+#define CAL_VALID_MAG     0x02U
+#define CAL_VALID_BOARD   0x04U
+#define CAL_VALID_GYRO    0x08U
+
+/**
+ * @brief One stored calibration, the payload of a record
+ *
+ * @param valid CAL_VALID_* mask of the parts that hold a calibration
+ * @param imu IMU offsets and scale corrections
+ * @param mag Magnetometer hard and soft iron coefficients
+ * @param boardRotation Board to body rotation, row major
+ * @param gyroBias Residual gyro bias in rad/s, body frame, left after the IMU offsets, as the
+ *                 online estimator settled on it the last time the vehicle was on the ground
+ */
+typedef struct {
+    uint32_t valid;
+    imu_cal_t imu;
+    mag_cal_t mag;
+    float boardRotation[9];
+    float gyroBias[3];
+} cal_data_t;
+
+/**
+ * @brief Store counters
+ * @param records Records in the active sector, including unreadable ones
+ * @param bytesUsed Bytes of the active sector taken by records
+ * @param sequence Sequence number of the loaded record, 0 if none
+ * @param eraseCount Times either sector has been erased by the store
+ * @param saves Records appended since boot
+ * @param failures Appends or erases that failed since boot
+ */
+typedef struct {
+    uint32_t records;
+    uint32_t bytesUsed;
+    uint32_t sequence;
+    uint32_t eraseCount;
+    uint32_t saves;
+    uint32_t failures;
+} cal_store_stats_t;
+
+/**
+ * @brief Finds the newest intact record in either sector. When the active sector has no room
+ *        for another record the store compacts: the other sector is erased and the newest record
+ *        copied into it, and only once that copy reads back intact does it become the active
+ *        sector. A reset anywhere in between boots from the full sector again. The erase stalls
+ *        every flash read, so the CPU, for one to two seconds. It only ever happens here, before
+ *        the kernel starts, about once every 900 saves.
+ * @returns True if a record was found
+ */
+bool CalStore_Init(void);
+
+/**
+ * @brief Gets the record found by CalStore_Init or written by the last CalStore_Save
+ * @param data Pointer to a cal_data_t to fill, defaults with an empty valid mask if there is none
+ * @returns False if there is no record
+ */
+bool CalStore_Load(cal_data_t* data);
+
+/**
+ * @brief Appends a record. Each programmed word stalls flash reads for about 16 us, a whole
+ *        record about 0.6 ms, so call it on the ground only, from a low priority task, and from
+ *        one task only. Never erases, a full sector makes it fail until the next boot compacts it.
+ * @param data Calibration to store
+ * @returns True if the record was written and read back intact
+ */
+bool CalStore_Save(const cal_data_t* data);
+
+/**
+ * @brief Copies the store counters
+ * @param stats Pointer to a cal_store_stats_t to fill
+ */
+void CalStore_GetStats(cal_store_stats_t* stats);
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * Reader of a UART receive DMA running in circular mode, fed by the HAL receive-to-idle events
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Current position of the stream in the buffer, size minus the DMA counter
+ */
+typedef uint32_t (*dma_rx_position_t)(void);
+
+/**
+ * @brief Ring state, one per receive DMA
+ *
+ * @param buff DMA destination, written by the stream behind the reader's back
+ * @param size Length of buff, a power of 2
+ * @param position Reads the stream position from the hardware
+ * @param lastPos Stream position at the previous event, interrupt side only
+ * @param written Bytes received up to the previous event, free running
+ * @param events Receive events seen, half transfer, transfer complete and idle line
+ * @param read Bytes consumed, free running, reader side only
+ * @param dropped Bytes skipped because the stream came round to them before they were read
+ */
+typedef struct {
+    const volatile uint8_t* buff;
+    uint32_t size;
+    dma_rx_position_t position;
+    uint32_t lastPos;
+    volatile uint32_t written;
+    volatile uint32_t events;
+    uint32_t read;
+    uint32_t dropped;
+} dma_rx_ring_t;
+
+/**
+ * @brief Starts an empty ring over a DMA buffer, call before the DMA is started
+ * @param ring Ring state
+ * @param buff Circular DMA destination
+ * @param size Length of buff, must be a power of 2
+ * @param position Stream position source, sampled by the reader
+ * @returns False if size is not a power of 2
+ */
+bool DmaRxRing_Init(dma_rx_ring_t* ring, const volatile uint8_t* buff, uint32_t size, dma_rx_position_t position);
+
+/**
+ * @brief Receive event handler, called from HAL_UARTEx_RxEventCallback. The half transfer and
+ *        transfer complete events must stay enabled, they keep the stream less than a lap
+ *        ahead of the last event so its distance is never ambiguous.
+ * @param ring Ring state
+ * @param pos Size argument of the callback, the stream position, size at the wrap
+ */
+void DmaRxRing_OnEvent(dma_rx_ring_t* ring, uint32_t pos);
+
+/**
+ * @brief Copies received bytes out, single reader. Everything up to the current stream position
+ *        is available, not only up to the last event. A reader more than a buffer behind has
+ *        lost the oldest bytes, everything waiting is skipped and counted in dropped, and the
+ *        caller should discard any partial message when dropped changes.
+ * @param ring Ring state
+ * @param dst Buffer to copy into
+ * @param maxLen Size of dst
+ * @returns Number of bytes copied, 0 if nothing intact is waiting
+ */
+uint32_t DmaRxRing_Read(dma_rx_ring_t* ring, uint8_t* dst, uint32_t maxLen);
\ No newline at end of file
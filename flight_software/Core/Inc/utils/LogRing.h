@@ -0,0 +1,53 @@
+/**
+ * Lock-free multi producer / single consumer ring of variable length log records
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_RING_SIZE 2048U      // bytes, must be a power of 2 and at most 32768
+#define LOG_RING_MAX_RECORD 256U // largest record payload in bytes
+
+/**
+ * @brief Ring occupancy counters
+ * @param drops Records rejected because the ring was full or the record too large
+ * @param highWater Largest number of bytes ever reserved at once, including headers and padding
+ * @param used Bytes reserved right now, including headers and padding
+ */
+typedef struct {
+    uint32_t drops;
+    uint32_t highWater;
+    uint32_t used;
+} log_ring_stats_t;
+
+/**
+ * @brief Clears the ring and its counters, must be called before any producer starts
+ */
+void LogRing_Init(void);
+
+/**
+ * @brief Copies a record into the ring without blocking. Safe to call from any number of
+ *        tasks and interrupt handlers at once.
+ * @param data Record payload
+ * @param len Payload length in bytes, 1 to LOG_RING_MAX_RECORD
+ * @returns True if the record was queued, False if it was dropped
+ */
+bool LogRing_Write(const void* data, uint16_t len);
+
+/**
+ * @brief Pops the oldest record. There must only ever be one consumer.
+ *        A record still being written by a preempted producer holds back everything after it
+ *        until that producer commits.
+ * @param dst Buffer to copy the payload into
+ * @param maxLen Size of dst, longer payloads are truncated
+ * @returns Number of bytes copied, 0 if no committed record is waiting
+ */
+uint16_t LogRing_Read(void* dst, uint16_t maxLen);
+
+/**
+ * @brief Copies the ring counters
+ * @param stats Pointer to a log_ring_stats_t to fill
+ */
+void LogRing_GetStats(log_ring_stats_t* stats);
\ No newline at end of file
@@ -11,26 +11,84 @@
 
 #define LOG_MAX_TAG_LEN 8
 #define LOG_MAX_MSG_LEN 116
-#define LOG_QUEUE_SIZE 16
+#define LOG_TX_BUFF_SIZE 512 // size of each of the two TX buffers, multiple messages coalesce into one
+#define LOG_MAX_ARG_WORDS 8  // 32-bit argument words captured per deferred record
+#define LOG_MAX_TAG_FILTERS 16 // tags with their own runtime level
+#define LOG_MAX_CMD_LEN 32     // longest command line accepted over the CDC link
+#define LOG_MAX_FRAME_LEN 200  // largest data frame payload, see Logger_LogFrame
+
+// Severity levels, plain defines so LOG_COMPILE_LEVEL can be compared by the preprocessor
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+// Calls below this level are compiled out, Release and MinSizeRel raise it in CMakeLists.txt
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Runtime level of tags without an entry in the filter table
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+
+// Binary frame sync bytes, used when built with LOG_BINARY_OUTPUT
+#define LOG_FRAME_SYNC0 0xA5
+#define LOG_FRAME_SYNC1 0x5A
+#define LOG_DATA_SYNC1  0x5B // second sync byte of data frames
+
+// Data frame types, decoded by tools/log_decode.py
+#define LOG_DATA_SYSMON 0x01
 
 // Total msg size for nominal logs 
-#define LOG_TOTAL_MSG_SIZE (LOG_MAX_TAG_LEN + LOG_MAX_MSG_LEN + 17) // TAG + MSG + '[8 digits] [] \r\n' + null terminator
+#define LOG_TOTAL_MSG_SIZE (LOG_MAX_TAG_LEN + LOG_MAX_MSG_LEN + 26) // TAG + MSG + '[10.6 digits] [] \r\n' + null terminator
 // Total msg size for direct logs
 #define LOG_TOTAL_MSG_SIZE_DIRECT (LOG_MAX_TAG_LEN + LOG_MAX_MSG_LEN + 6) // TAG + MSG + '[] \r\n' + null terminator
 
+typedef uint8_t log_level_t;
+
 typedef enum {
     LOGGER_TYPE_UART,
     LOGGER_TYPE_USBCDC
 } log_type_t;
 
+/**
+ * @brief A deferred log record: the format is not expanded until LoggerTask (or the host decoder)
+ * @param timestampUs Timebase microseconds at the LOG() call
+ * @param tag Prefix TAG, must point to static storage
+ * @param format Format string, must point to static storage
+ * @param nWords Number of valid words in args
+ * @param args Raw argument values packed in format order, floats are stored as single precision.
+ *             Only the first nWords are stored in the record ring.
+ */
 typedef struct {
-    uint32_t timeTicks;
+    uint64_t timestampUs;
     const char* tag;
-    char msg[LOG_MAX_MSG_LEN];
+    const char* format;
+    uint8_t nWords;
+    uint32_t args[LOG_MAX_ARG_WORDS];
 } log_msg_t;
 
 /**
- * @brief Initializes the logging system: USB_CDC, RTOS queue
+ * @brief Logger throughput counters
+ * @param bytesSent Bytes handed off to and completed by the serial link
+ * @param messagesCoalesced Messages that shared a transfer with an earlier message
+ * @param drops Messages lost to a full TX buffer or a failed transfer
+ * @param ringDrops Messages lost to a full record ring
+ * @param ringHighWater Peak record ring occupancy in bytes, out of LOG_RING_SIZE
+ * @param ringUsed Current record ring occupancy in bytes
+ */
+typedef struct {
+    uint32_t bytesSent;
+    uint32_t messagesCoalesced;
+    uint32_t drops;
+    uint32_t ringDrops;
+    uint32_t ringHighWater;
+    uint32_t ringUsed;
+} log_stats_t;
+
+/**
+ * @brief Initializes the logging system: serial link, record ring
  * @param logType Enum representing UART/USB log type to configure
  * @param huart Pointer to the logging UART handle
  * @returns True on success, False otherwise
@@ -38,12 +96,75 @@ typedef struct {
 bool Logger_Init(log_type_t logType, UART_HandleTypeDef* huart);
 
 /**
- * @brief Formats a message and pushes it to the log queue
+ * @brief Captures the raw arguments of a message and pushes it to the log ring without blocking,
+ *        formatting is deferred to LoggerTask. Safe to call from tasks and interrupt handlers.
+ *        Messages below the runtime level of their tag are dropped before any argument is captured.
+ *        Supports integer, floating point, %p and %c conversions; %s arguments must point to
+ *        static storage (e.g. string literals). Field widths/precisions given as '*' are not supported.
+ *        Use through the LOG_<LEVEL> macros so LOG_COMPILE_LEVEL can remove the call.
+ * @param level Severity of the message
  * @param tag Prefix TAG for the message
  * @param format Message format string
  * @param ... Variable input args to format string
  */
-void LOG(const char* tag, const char* format, ...);
+void Logger_Log(log_level_t level, const char* tag, const char* format, ...);
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(tag, ...) Logger_Log(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define LOG_DEBUG(tag, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(tag, ...) Logger_Log(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#else
+#define LOG_INFO(tag, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(tag, ...) Logger_Log(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#else
+#define LOG_WARN(tag, ...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(tag, ...) Logger_Log(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#else
+#define LOG_ERROR(tag, ...) ((void)0)
+#endif
+
+// Plain LOG() is an info message
+#define LOG(tag, ...) LOG_INFO(tag, __VA_ARGS__)
+
+/**
+ * @brief Queues a binary data frame (telemetry rather than text) on the logger link without
+ *        blocking. Safe to call from tasks and interrupt handlers. Frames are filtered like
+ *        info messages of their tag. With LOG_BINARY_OUTPUT the frame is sent as
+ *        sync0, LOG_DATA_SYNC1, length, timestamp (2 words), type, payload;
+ *        in text mode it is printed as a hex line under its tag.
+ * @param tag Prefix TAG for the frame, must point to static storage
+ * @param type One of the LOG_DATA_<X> types
+ * @param payload Frame contents, little endian
+ * @param len Payload length in bytes, at most LOG_MAX_FRAME_LEN
+ * @returns False if the frame was filtered, too long or dropped by a full ring
+ */
+bool Logger_LogFrame(const char* tag, uint8_t type, const void* payload, uint8_t len);
+
+/**
+ * @brief Sets the runtime level of a tag. Not reentrant, call from one task at a time
+ *        (LoggerTask applies the CDC commands).
+ * @param tag Tag to filter, NULL or "*" sets the level of all tags without their own entry
+ * @param level Lowest level still logged, LOG_LEVEL_NONE silences the tag
+ * @returns False if the level is invalid or the filter table is full
+ */
+bool Logger_SetTagLevel(const char* tag, log_level_t level);
+
+/**
+ * @brief Gets the runtime level of a tag
+ * @param tag Tag to look up, NULL or "*" for the default level
+ * @returns Lowest level logged for the tag
+ */
+log_level_t Logger_GetTagLevel(const char* tag);
 
 /**
  * @brief Formats a message and immediately uses CDC to print,
@@ -55,7 +176,43 @@ void LOG(const char* tag, const char* format, ...);
 void LOG_DIRECT(const char* tag, const char* format, ...);
 
 /**
- * @brief Logger worker task, pops log queue and prints via CDC
+ * @brief Logger worker task, pops the log ring and prints via CDC
  * @param argument No arguments expected
  */
-void LoggerTask(void *argument);
\ No newline at end of file
+void LoggerTask(void *argument);
+
+/**
+ * @brief Receive hook for the USB CDC link, called from the CDC receive ISR.
+ *        Collects one command line at a time for LoggerTask, which accepts
+ *        "loglevel <tag|*> <debug|info|warn|error|none>"
+ * @param buff Received bytes
+ * @param len Number of received bytes
+ */
+void Logger_RxCallback(const uint8_t* buff, uint32_t len);
+
+/**
+ * @brief Expands a deferred record into text the way LoggerTask does in text mode,
+ *        for tools and benchmarks. Works in either output mode.
+ * @param dst Output buffer
+ * @param space Size of the output buffer
+ * @param msg Record to expand
+ * @returns Number of bytes written, including the trailing "\r\n", 0 if space is under 3 bytes
+ */
+uint16_t Logger_Expand(char* dst, uint16_t space, const log_msg_t* msg);
+
+/**
+ * @brief Transfer complete hook for the active serial link, called from the UART DMA and USB CDC ISRs
+ */
+void Logger_TxCpltCallback(void);
+
+/**
+ * @brief Failed transfer hook for the active serial link: UART errors and USB CDC init or deinit,
+ *        after which the transfer in flight never completes. Its messages are counted as drops.
+ */
+void Logger_TxAbortCallback(void);
+
+/**
+ * @brief Copies the logger throughput counters
+ * @param stats Pointer to a log_stats_t to fill
+ */
+void Logger_GetStats(log_stats_t* stats);
\ No newline at end of file
@@ -0,0 +1,28 @@
+/**
+ * Memory placement attributes, see the CCM sections in STM32F405XX_FLASH.ld
+ *
+ * CCM is 64 KB of zero wait state RAM on the CPU data bus only. The DMA controllers and the
+ * USB OTG core cannot reach it, so CCM is for data that only the CPU ever touches. Task stacks
+ * and the MSP stack live there too, so never hand a stack buffer to a DMA transfer.
+ *
+ * CCM is not on the instruction bus either, so code that has to run from RAM goes to main SRAM.
+ */
+
+#pragma once
+
+// Zero initialized CPU-only data in CCM, cleared by the startup code
+#define CCM_BSS __attribute__((section(".ccmbss")))
+
+// Initialized CPU-only data in CCM, copied from flash by the startup code
+#define CCM_DATA __attribute__((section(".ccmram")))
+
+// Function executed from main SRAM, copied from flash with .data by the startup code. Keeps
+// interrupt paths clear of flash wait states when the ART cache misses (FLASH_LATENCY_5).
+// Never inlined, an inlined copy would land wherever its caller is.
+#define RAMFUNC __attribute__((section(".RamFunc"), noinline))
+
+// Buffers read or written by a DMA stream, collected into the .dmabuf output section in main
+// SRAM and zeroed with .bss. The linker script fails the link if that section is mapped
+// outside main SRAM. A DMA buffer without this attribute is not checked, CCM_BSS or a stack
+// buffer handed to DMA still links.
+#define DMA_BUFFER __attribute__((section(".bss.dmabuf"), aligned(4)))
\ No newline at end of file
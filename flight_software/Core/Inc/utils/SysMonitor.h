@@ -0,0 +1,55 @@
+/**
+ * System monitor: periodic per-task CPU and stack usage, heap and log ring telemetry
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYSMON_PERIOD_MS 1000U
+#define SYSMON_MAX_TASKS 12U // tasks reported per frame, must cover every task in the system
+#define SYSMON_NAME_LEN 8U   // task names are cut to this many characters, not null terminated when full
+
+/**
+ * @brief One task in a LOG_DATA_SYSMON frame
+ * @param name Task name
+ * @param priority Current FreeRTOS priority
+ * @param state FreeRTOS eTaskState (0 running, 1 ready, 2 blocked, 3 suspended, 4 deleted)
+ * @param cpuPermille Share of the last period spent in this task, in 0.1 %
+ * @param stackFreeBytes Least stack space ever left since the task started
+ */
+typedef struct __attribute__((packed)) {
+    char name[SYSMON_NAME_LEN];
+    uint8_t priority;
+    uint8_t state;
+    uint16_t cpuPermille;
+    uint16_t stackFreeBytes;
+} sysmon_task_entry_t;
+
+/**
+ * @brief Payload of a LOG_DATA_SYSMON frame, little endian, only the first nTasks entries are sent
+ * @param heapFree Free heap_4 bytes now
+ * @param heapMinFree Least free heap_4 bytes since boot
+ * @param logRingUsed Log record ring bytes in use now
+ * @param logRingHighWater Peak log record ring bytes in use
+ * @param logDrops Log records lost so far, ring and TX combined
+ * @param nTasks Number of task entries that follow
+ * @param tasks Task entries
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    uint16_t logRingUsed;
+    uint16_t logRingHighWater;
+    uint32_t logDrops;
+    uint8_t nTasks;
+    sysmon_task_entry_t tasks[SYSMON_MAX_TASKS];
+} sysmon_frame_t;
+
+/**
+ * @brief System monitor task, samples the system every SYSMON_PERIOD_MS and
+ *        publishes a LOG_DATA_SYSMON frame through the logger
+ * @param argument No arguments expected
+ */
+void SysMonitorTask(void *argument);
\ No newline at end of file
@@ -0,0 +1,37 @@
+/**
+ * Monotonic microsecond timebase shared by the logger, sensor drivers and estimators
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Starts the free-running cycle counter, must be called before any other Timebase function
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief Gets the time since Timebase_Init, safe to call from tasks and ISRs
+ * @returns Microseconds since boot, never wraps in practice
+ */
+uint64_t Timebase_GetUs(void);
+
+/**
+ * @brief Keeps the overflow extension current, must run at least once per
+ *        counter wrap (about 25 s at 168 MHz). Called from the HAL tick ISR.
+ */
+void Timebase_Tick(void);
+
+/**
+ * @brief Gets the raw 32-bit cycle counter, for measuring short intervals
+ *        with (end - start) arithmetic
+ * @returns Current counter value
+ */
+uint32_t Timebase_GetCycles(void);
+
+/**
+ * @brief Gets the counter rate
+ * @returns Counter increments per microsecond
+ */
+uint32_t Timebase_GetCyclesPerUs(void);
\ No newline at end of file
@@ -0,0 +1,156 @@
+/**
+ * Microbenchmark harness for hot path kernels
+ *
+ * Every invocation is timed on its own between two cycle counter reads, so min/mean/max
+ * come straight from the distribution and no kernel needs a hand written loop. The cost
+ * of the timing itself is measured once with an empty kernel and subtracted. In the
+ * FSW_BENCHMARK firmware variant BenchTask replaces the flight tasks and reports one
+ * line per kernel over the CDC link, so each commit can be compared in cycles.
+ */
+
+#include "Bench.h"
+#include "Timebase.h"
+
+#include "usb_device.h"
+#include "usbd_cdc_if.h"
+#include "cmsis_os2.h"
+
+#include <stdio.h>
+
+#ifndef FSW_BUILD_REV
+#define FSW_BUILD_REV "unknown"
+#endif
+
+#define BENCH_CALIBRATION_RUNS 256U
+#define BENCH_USB_SETTLE_MS 2000U // time for the host to enumerate the CDC link
+#define BENCH_REPEAT_MS 10000U
+#define BENCH_TX_TIMEOUT_MS 100U
+
+static uint32_t overheadCycles;
+static bool calibrated;
+
+// Times one invocation, kept out of line so every kernel pays the same call path
+__attribute__((noinline))
+static uint32_t Bench_TimeOne(void (*run)(uint32_t), uint32_t i) {
+    uint32_t start = Timebase_GetCycles();
+    run(i);
+    return Timebase_GetCycles() - start;
+}
+
+static void Bench_Empty(uint32_t i) {
+    (void)i;
+}
+
+void Bench_Calibrate(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = 0; i < BENCH_CALIBRATION_RUNS; i++) {
+        uint32_t cycles = Bench_TimeOne(Bench_Empty, i);
+        if (cycles < best)
+            best = cycles;
+    }
+    overheadCycles = best;
+    calibrated = true;
+}
+
+bool Bench_Run(const bench_kernel_t* kernel, uint32_t iterations, bench_result_t* result) {
+    if (iterations == 0)
+        return false;
+    if (!calibrated)
+        Bench_Calibrate();
+
+    if (kernel->setup != NULL)
+        kernel->setup();
+
+    // Warm caches and branch state, untimed
+    kernel->run(0);
+    if (kernel->reset != NULL)
+        kernel->reset();
+
+    uint32_t minCycles = UINT32_MAX;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t cycles = Bench_TimeOne(kernel->run, i);
+        cycles = (cycles > overheadCycles) ? cycles - overheadCycles : 0;
+        if (kernel->reset != NULL)
+            kernel->reset();
+
+        if (cycles < minCycles)
+            minCycles = cycles;
+        if (cycles > maxCycles)
+            maxCycles = cycles;
+        totalCycles += cycles;
+    }
+
+    result->name = kernel->name;
+    result->iterations = iterations;
+    result->minCycles = minCycles;
+    result->meanCycles = (uint32_t)(totalCycles / iterations);
+    result->maxCycles = maxCycles;
+    result->items = (kernel->items > 0) ? kernel->items : 1U;
+    return true;
+}
+
+int Bench_FormatResult(char* dst, uint32_t space, const bench_result_t* result) {
+    char perItem[24] = "";
+    if (result->items > 1)
+        snprintf(perItem, sizeof(perItem), " per_item=%lu", (unsigned long)(result->meanCycles / result->items));
+
+    int len = snprintf(dst, space, "BENCH %s n=%lu min=%lu mean=%lu max=%lu%s\r\n",
+                       result->name,
+                       (unsigned long)result->iterations,
+                       (unsigned long)result->minCycles,
+                       (unsigned long)result->meanCycles,
+                       (unsigned long)result->maxCycles,
+                       perItem);
+    if (len < 0)
+        return 0; // snprintf fail
+    return ((uint32_t)len < space) ? len : (int)space - 1;
+}
+
+// Double buffered so a line can be formatted while the previous one is still on the IN endpoint
+static char txLines[2][BENCH_LINE_LEN];
+static uint8_t txIdx;
+
+// Sends one line, waiting for the previous transfer to finish
+static void Bench_Print(int len) {
+    uint32_t timeoutTicks = BENCH_TX_TIMEOUT_MS * osKernelGetTickFreq() / 1000U;
+    uint32_t start = osKernelGetTickCount();
+    while (CDC_Transmit_FS((uint8_t*)txLines[txIdx], (uint16_t)len) == USBD_BUSY) {
+        if (osKernelGetTickCount() - start > timeoutTicks)
+            return; // nobody reading, drop the line
+        osDelay(1);
+    }
+    txIdx ^= 1U;
+}
+
+void BenchTask(void *argument) {
+    (void)argument;
+
+    // No LoggerTask in this variant, bring up USB here
+    MX_USB_DEVICE_Init();
+    osDelay(BENCH_USB_SETTLE_MS * osKernelGetTickFreq() / 1000U);
+
+    uint32_t count;
+    const bench_kernel_t* kernels = Bench_GetKernels(&count);
+
+    for (;;) {
+        Bench_Calibrate();
+
+        int len = snprintf(txLines[txIdx], BENCH_LINE_LEN, "BENCH rev=%s cycles_per_us=%lu overhead=%lu kernels=%lu\r\n",
+                           FSW_BUILD_REV,
+                           (unsigned long)Timebase_GetCyclesPerUs(),
+                           (unsigned long)overheadCycles,
+                           (unsigned long)count);
+        if (len > 0 && len < BENCH_LINE_LEN)
+            Bench_Print(len);
+
+        for (uint32_t k = 0; k < count; k++) {
+            bench_result_t result;
+            Bench_Run(&kernels[k], BENCH_DEFAULT_ITERATIONS, &result);
+            Bench_Print(Bench_FormatResult(txLines[txIdx], BENCH_LINE_LEN, &result));
+        }
+
+        osDelay(BENCH_REPEAT_MS * osKernelGetTickFreq() / 1000U);
+    }
+}
\ No newline at end of file
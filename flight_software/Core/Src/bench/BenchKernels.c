@@ -0,0 +1,592 @@
+/**
+ * Hot path kernels registered with the benchmark harness
+ *
+ * Kernels that had no flight implementation yet were ported from the sensor_verification
+ * drivers with their arithmetic untouched, so the first numbers were the baseline the flight
+ * drivers had to beat. The ports stay next to the flight functions as baselines: barometer
+ * compensation as "_dbl", altitude as "altitude_powf", the GGA parser as "nmea_gga_strtok".
+ * Results go to volatile sinks so the compiler cannot drop the work.
+ */
+
+#include "Bench.h"
+#include "Logger.h"
+#include "LogRing.h"
+#include "ImuRing.h"
+#include "ImuConvert.h"
+#include "BaroCompensation.h"
+#include "BaroAltitude.h"
+#include "AttitudeFilter.h"
+#include "MagCalFit.h"
+#include "GyroBias.h"
+#include "Nmea.h"
+#include "MemSections.h"
+
+#include "stm32f4xx_hal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char TAG[] = "BENCH";
+
+#define BENCH_INPUT_SETS 16U // must be a power of 2
+#define BENCH_INPUT_MASK (BENCH_INPUT_SETS - 1U)
+
+static volatile float sinkF;
+static volatile uint32_t sinkU;
+
+// Small deterministic generator for input sets
+static uint32_t benchSeed;
+static uint32_t Bench_Rand(void) {
+    benchSeed = benchSeed * 1664525U + 1013904223U;
+    return benchSeed >> 8;
+}
+
+/* Raw -> SI conversion -------------------------------------------------------*/
+#define ACCEL_SCALE (8.0f * 9.80665f / 32768.0f)
+#define GYRO_SCALE  (2000.0f / 32768.0f * 3.14159265f / 180.0f)
+
+static uint8_t rawFrames[BENCH_INPUT_SETS][IMU_FRAME_BYTES];
+
+// A full FIFO batch, behind one address byte like the DMA buffer so frames are unaligned
+static uint8_t fifoFrames[1 + IMU_BATCH_MAX_SAMPLES * IMU_FRAME_BYTES];
+static imu_convert_t benchConvert;
+static imu_batch_t benchBatch;
+static imu_sample_t aosSamples[IMU_BATCH_MAX_SAMPLES];
+
+static void Imu_ConvertSetup(void) {
+    benchSeed = 1;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++) {
+        for (uint32_t b = 0; b < sizeof(rawFrames[i]); b++)
+            rawFrames[i][b] = (uint8_t)Bench_Rand();
+    }
+    for (uint32_t b = 0; b < sizeof(fifoFrames); b++)
+        fifoFrames[b] = (uint8_t)Bench_Rand();
+
+    // A mount rotation and offsets, so nothing is skipped
+    static const float rotation[9] = { 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f };
+    static const int16_t accelBias[3] = { 12, -40, 85 };
+    static const int16_t gyroBias[3] = { -3, 7, 1 };
+    ImuConvert_Init(&benchConvert, ACCEL_SCALE, GYRO_SCALE, rotation);
+    ImuConvert_SetBias(&benchConvert, accelBias, gyroBias);
+}
+
+// Per-axis conversion the MPU6500 driver used before ImuConvert, one burst frame, kept as the
+// baseline. Always inlined so the flash and RAM kernels below each carry their own copy.
+static inline __attribute__((always_inline)) void Imu_ConvertFrame(const uint8_t* accel, imu_sample_t* sample) {
+    const uint8_t* gyro = accel + 6;
+
+    sample->ax = (int16_t)(((uint16_t)accel[0] << 8) | accel[1]) * ACCEL_SCALE;
+    sample->ay = (int16_t)(((uint16_t)accel[2] << 8) | accel[3]) * ACCEL_SCALE;
+    sample->az = (int16_t)(((uint16_t)accel[4] << 8) | accel[5]) * ACCEL_SCALE;
+    sample->gx = (int16_t)(((uint16_t)gyro[0] << 8) | gyro[1]) * GYRO_SCALE;
+    sample->gy = (int16_t)(((uint16_t)gyro[2] << 8) | gyro[3]) * GYRO_SCALE;
+    sample->gz = (int16_t)(((uint16_t)gyro[4] << 8) | gyro[5]) * GYRO_SCALE;
+}
+
+static inline __attribute__((always_inline)) void Imu_ConvertBody(uint32_t i) {
+    imu_sample_t sample;
+    Imu_ConvertFrame(rawFrames[i & BENCH_INPUT_MASK], &sample);
+    sinkF = sample.ax + sample.ay + sample.az + sample.gx + sample.gy + sample.gz;
+}
+
+static void Imu_ConvertRun(uint32_t i) {
+    Imu_ConvertBody(i);
+}
+
+// ImuConvert with offsets and rotation, one burst frame
+static void Imu_SampleRun(uint32_t i) {
+    imu_sample_t sample;
+    const uint8_t* frame = rawFrames[i & BENCH_INPUT_MASK];
+    ImuConvert_Sample(&benchConvert, frame, frame + 6, &sample);
+    sinkF = sample.ax + sample.gz;
+}
+
+// Whole FIFO batch into the axis arrays
+static void Imu_BatchRun(uint32_t i) {
+    (void)i;
+    ImuConvert_Batch(&benchConvert, &fifoFrames[1], IMU_BATCH_MAX_SAMPLES, &benchBatch);
+    sinkF = benchBatch.ax[0] + benchBatch.gz[IMU_BATCH_MAX_SAMPLES - 1];
+}
+
+// Baseline for imu_batch: the same offsets and rotation into an array of samples, so the two
+// differ only in the layout they store
+static void Imu_BatchAosRun(uint32_t i) {
+    (void)i;
+    ImuConvert_Samples(&benchConvert, &fifoFrames[1], IMU_BATCH_MAX_SAMPLES, aosSamples);
+    sinkF = aosSamples[0].ax + aosSamples[IMU_BATCH_MAX_SAMPLES - 1].gz;
+}
+
+/* Barometer compensation and altitude -----------------------------------------*/
+// Datasheet example trimming values
+static const uint16_t compT[3] = { 27504U, 26435U, (uint16_t)-1000 };
+static const uint16_t compP[9] = { 36477U, (uint16_t)-10685, 3024U, 2855U, 140U, (uint16_t)-7, 15500U, (uint16_t)-14600, 6000U };
+static const bmp280_calib_t bmp280Calib = { 27504U, 26435, -1000, 36477U, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+static int32_t t_fine;
+
+// Synthetic BMP388 calibration registers in the range of real parts
+static const uint8_t bmp388CalibRaw[BMP388_CALIB_LEN] = {
+    0x78, 0x69, 0x38, 0x4A, 0xF9, 0x90, 0x02, 0x50, 0xFB, 0x0C, 0x04,
+    0xA8, 0x61, 0x30, 0x75, 0xF8, 0xF6, 0x80, 0x3E, 0x0A, 0xC4
+};
+static bmp388_calib_t bmp388Calib;
+
+static int32_t rawTemps[BENCH_INPUT_SETS];
+static int32_t rawPressures[BENCH_INPUT_SETS];
+static int32_t fineTemps[BENCH_INPUT_SETS];
+static float fineTempsF[BENCH_INPUT_SETS];
+static uint32_t rawTemps388[BENCH_INPUT_SETS];
+static uint32_t rawPressures388[BENCH_INPUT_SETS];
+static int64_t linTemps388[BENCH_INPUT_SETS];
+static float linTemps388F[BENCH_INPUT_SETS];
+static float pressures[BENCH_INPUT_SETS];
+
+// Accuracy against the datasheet reference is asserted in host/Test/TestBaroCompensation.c
+static void Bmp280_Setup(void) {
+    benchSeed = 2;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++) {
+        rawTemps[i] = 519888 + (int32_t)(Bench_Rand() % 4096U) - 2048;
+        rawPressures[i] = 415148 + (int32_t)(Bench_Rand() % 65536U) - 32768;
+        pressures[i] = 90000.0f + (float)(Bench_Rand() % 15000U);
+        Bmp280_CompensateTemp(&bmp280Calib, rawTemps[i], &fineTemps[i]);
+        Bmp280_CompensateTempF(&bmp280Calib, rawTemps[i], &fineTempsF[i]);
+    }
+}
+
+static void Bmp388_Setup(void) {
+    Bmp388_ParseCalib(bmp388CalibRaw, &bmp388Calib);
+
+    benchSeed = 4;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++) {
+        rawTemps388[i] = 8000000U + Bench_Rand() % 500000U;
+        rawPressures388[i] = 6000000U + Bench_Rand() % 1500000U;
+        Bmp388_CompensateTemp(&bmp388Calib, rawTemps388[i], &linTemps388[i]);
+        linTemps388F[i] = Bmp388_CompensateTempF(&bmp388Calib, rawTemps388[i]);
+    }
+}
+
+// convertRawTemp from sensor_verification/bmp280_verify, double literals included
+static float convertRawTemp(int32_t tRaw) {
+    float dig_T1 = (float)compT[0];
+    float dig_T2 = (float)(int16_t)compT[1];
+    float dig_T3 = (float)(int16_t)compT[2];
+
+    float var1, var2, T;
+    var1 = ((((float)tRaw)/16384.0) - (dig_T1/1024.0)) * dig_T2;
+    var2 = ((((float)tRaw)/131072.0) - (dig_T1/8192.0)) * ((((float)tRaw)/131072.0) - dig_T1/8192.0) * dig_T3;
+    t_fine = (int32_t)(var1 + var2);
+    T = (var1 + var2) / 5120.0;
+    return T;
+}
+
+// convertRawPressure from sensor_verification/bmp280_verify, needs t_fine from convertRawTemp
+static float convertRawPressure(int32_t pRaw) {
+    float dig_P1 = (float)compP[0];
+    float dig_P2 = (float)(int16_t)compP[1];
+    float dig_P3 = (float)(int16_t)compP[2];
+    float dig_P4 = (float)(int16_t)compP[3];
+    float dig_P5 = (float)(int16_t)compP[4];
+    float dig_P6 = (float)(int16_t)compP[5];
+    float dig_P7 = (float)(int16_t)compP[6];
+    float dig_P8 = (float)(int16_t)compP[7];
+    float dig_P9 = (float)(int16_t)compP[8];
+
+    float var1, var2, p;
+    var1 = ((float)t_fine)/2.0 - 64000.0;
+    var2 = var1 * var1 * dig_P6 / 32768.0;
+    var2 = var2 + var1 * dig_P5 * 2.0;
+    var2 = (var2/4.0) + (dig_P4 * 65536.0);
+    var1 = (dig_P3 * var1 * var1 / 524288.0 + (dig_P2 * var1)) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * dig_P1;
+    if (var1 == 0.0) {
+        return 0;
+    }
+    p = 1048576.0 - (float)pRaw;
+    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = dig_P9 * p * p / 2147483648.0;
+    var2 = p * dig_P8 / 32768.0;
+    p = p + (var1 + var2 + dig_P7) / 16.0;
+    return p;
+}
+
+// calculateAltitude from sensor_verification/bmp280_verify
+static float calculateAltitude(float p) {
+    float T0 = 288.15;
+    float P0 = 101325.0;
+    float L = 0.0065;
+    float R = 8.31447;
+    float g = 9.80665;
+    float M = 0.0289644;
+
+    float var1, var2, var3;
+    var1 = T0/L;
+    var2 = p/P0;
+    var3 = (R * L) / (g * M);
+    return var1 * (powf(var2, var3) - 1);
+}
+
+static void Bmp280_TempDblRun(uint32_t i) {
+    sinkF = convertRawTemp(rawTemps[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp280_PressureDblRun(uint32_t i) {
+    sinkF = convertRawPressure(rawPressures[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp280_TempRun(uint32_t i) {
+    int32_t tFine;
+    sinkU = (uint32_t)Bmp280_CompensateTemp(&bmp280Calib, rawTemps[i & BENCH_INPUT_MASK], &tFine);
+}
+
+static void Bmp280_PressureRun(uint32_t i) {
+    sinkU = Bmp280_CompensatePressure(&bmp280Calib, rawPressures[i & BENCH_INPUT_MASK], fineTemps[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp280_TempFloatRun(uint32_t i) {
+    float tFine;
+    sinkF = Bmp280_CompensateTempF(&bmp280Calib, rawTemps[i & BENCH_INPUT_MASK], &tFine);
+}
+
+static void Bmp280_PressureFloatRun(uint32_t i) {
+    sinkF = Bmp280_CompensatePressureF(&bmp280Calib, rawPressures[i & BENCH_INPUT_MASK], fineTempsF[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp388_TempRun(uint32_t i) {
+    int64_t tLin;
+    sinkU = (uint32_t)Bmp388_CompensateTemp(&bmp388Calib, rawTemps388[i & BENCH_INPUT_MASK], &tLin);
+}
+
+static void Bmp388_PressureRun(uint32_t i) {
+    sinkU = Bmp388_CompensatePressure(&bmp388Calib, rawPressures388[i & BENCH_INPUT_MASK], linTemps388[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp388_TempFloatRun(uint32_t i) {
+    sinkF = Bmp388_CompensateTempF(&bmp388Calib, rawTemps388[i & BENCH_INPUT_MASK]);
+}
+
+static void Bmp388_PressureFloatRun(uint32_t i) {
+    sinkF = Bmp388_CompensatePressureF(&bmp388Calib, rawPressures388[i & BENCH_INPUT_MASK], linTemps388F[i & BENCH_INPUT_MASK]);
+}
+
+static void Altitude_Setup(void) {
+    Bmp280_Setup();
+    BaroAltitude_Init();
+}
+
+static void Altitude_Run(uint32_t i) {
+    sinkF = calculateAltitude(pressures[i & BENCH_INPUT_MASK]);
+}
+
+static void Altitude_ExactRun(uint32_t i) {
+    sinkF = BaroAltitude_FromPressureExact(pressures[i & BENCH_INPUT_MASK]);
+}
+
+static void Altitude_TableRun(uint32_t i) {
+    sinkF = BaroAltitude_FromPressure(pressures[i & BENCH_INPUT_MASK]);
+}
+
+/* NMEA parsing ----------------------------------------------------------------*/
+static const char ggaSentence[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static char nmeaBuff[sizeof(ggaSentence)];
+static nmea_parser_t benchNmea;
+
+// validateChecksum from sensor_verification/neo8m_verify
+static uint8_t validateChecksum(const char* buff, uint32_t buffSize) {
+    uint32_t checksumIdx = 0;
+    for (uint32_t i = 0; i < buffSize; i++) {
+        if (buff[i] == '*') {
+            checksumIdx = i + 1;
+            break;
+        }
+    }
+    if (checksumIdx == 0 || checksumIdx + 2 > buffSize)
+        return 0;
+
+    uint8_t checksum = 0;
+    for (uint32_t i = 1; i < checksumIdx - 1; i++)
+        checksum ^= (uint8_t)buff[i];
+
+    char hex[3] = { buff[checksumIdx], buff[checksumIdx + 1], '\0' };
+    return checksum == (uint8_t)strtol(hex, NULL, 16);
+}
+
+// parseGGA from sensor_verification/neo8m_verify, tokenizes in place
+static uint8_t parseGGA(char* buff, float* gpsBuff) {
+    float latitude = 0.0f, longitude = 0.0f;
+    int satCheck = 1;
+
+    int tokenctr = 0;
+    char* tokenptr;
+    char* token = strtok_r(buff, ",", &tokenptr);
+    while (token != NULL) {
+        if (tokenctr == 2) {
+            float rawLatitude = atof(token);
+            latitude = (int)(rawLatitude / 100.0f);
+            latitude += (rawLatitude - latitude * 100) / 60.0f;
+        } else if (tokenctr == 3) {
+            if (token[0] == 'S') latitude *= -1;
+        } else if (tokenctr == 4) {
+            float rawLongitude = atof(token);
+            longitude = (int)(rawLongitude / 100.0f);
+            longitude += (rawLongitude - longitude * 100) / 60.0f;
+        } else if (tokenctr == 5) {
+            if (token[0] == 'W') longitude *= -1;
+        } else if (tokenctr == 6) {
+            if (token[0] == '0') return 0;
+        } else if (tokenctr == 7) {
+            if (atof(token) < 5) satCheck = 0;
+        } else if (tokenctr == 9) {
+            break;
+        }
+        tokenctr++;
+        token = strtok_r(NULL, ",", &tokenptr);
+    }
+
+    if (!satCheck)
+        return 1;
+    gpsBuff[0] = latitude;
+    gpsBuff[1] = longitude;
+    return 2;
+}
+
+// Includes restoring the sentence, strtok_r consumes it (about as much as one memcpy of 70 bytes)
+static void Nmea_GgaStrtokRun(uint32_t i) {
+    (void)i;
+    float gps[2] = { 0.0f, 0.0f };
+    memcpy(nmeaBuff, ggaSentence, sizeof(ggaSentence));
+    if (validateChecksum(nmeaBuff, sizeof(nmeaBuff)) && parseGGA(nmeaBuff, gps) == 2)
+        sinkF = gps[0] + gps[1];
+}
+
+static void Nmea_GgaSetup(void) {
+    Nmea_Init(&benchNmea);
+}
+
+// Byte by byte as GpsTask takes the sentence off the DMA ring, checksum and parse included
+static void Nmea_GgaRun(uint32_t i) {
+    (void)i;
+    gps_fix_t fix;
+    for (uint32_t k = 0; k < sizeof(ggaSentence) - 1U; k++) {
+        if (Nmea_Push(&benchNmea, (uint8_t)ggaSentence[k]) && Nmea_ParseGga(benchNmea.line, &fix))
+            sinkU = (uint32_t)(fix.lat_e7 + fix.lon_e7);
+    }
+}
+
+/* Flash vs RAM execution -------------------------------------------------------*/
+// The same kernel bodies placed in flash and in SRAM (RAMFUNC). The "_cold" and "_ram" kernels
+// flush the ART instruction and data caches after every invocation, as if an interrupt arrived
+// after other code had evicted its path. The harness itself runs from flash and refetches too,
+// which adds the same amount to both, so compare the two against each other.
+static void Bench_FlushArt(void) {
+    __HAL_FLASH_INSTRUCTION_CACHE_DISABLE();
+    __HAL_FLASH_INSTRUCTION_CACHE_RESET();
+    __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_RESET();
+    __HAL_FLASH_DATA_CACHE_ENABLE();
+}
+
+static RAMFUNC void Imu_ConvertRunRam(uint32_t i) {
+    Imu_ConvertBody(i);
+}
+
+// XOR checksum of a sentence, branchy byte loop
+static inline __attribute__((always_inline)) void Nmea_ChecksumBody(void) {
+    uint8_t checksum = 0;
+    for (uint32_t i = 1; i < sizeof(ggaSentence) && ggaSentence[i] != '*'; i++)
+        checksum ^= (uint8_t)ggaSentence[i];
+    sinkU = checksum;
+}
+
+static void Nmea_ChecksumRun(uint32_t i) {
+    (void)i;
+    Nmea_ChecksumBody();
+}
+
+static RAMFUNC void Nmea_ChecksumRunRam(uint32_t i) {
+    (void)i;
+    Nmea_ChecksumBody();
+}
+
+/* Logger ----------------------------------------------------------------------*/
+static log_msg_t capturedMsg;
+
+// Empties the record ring so every capture takes the full write path
+static void Log_Drain(void) {
+    log_msg_t msg;
+    while (LogRing_Read(&msg, sizeof(msg)) > 0) {
+    }
+}
+
+static void Log_CaptureRun(uint32_t i) {
+    LOG(TAG, "seq %lu dt %u us att %.3f", (unsigned long)i, (unsigned)(i & 0xFFU), (double)(i * 0.001f));
+}
+
+static void Log_ExpandSetup(void) {
+    Log_Drain();
+    LOG(TAG, "seq %lu dt %u us att %.3f", 123456UL, 1000U, (double)0.125f);
+    if (LogRing_Read(&capturedMsg, sizeof(capturedMsg)) == 0)
+        capturedMsg = (log_msg_t){ .tag = TAG, .format = "" }; // tag silenced over CDC
+}
+
+static void Log_ExpandRun(uint32_t i) {
+    (void)i;
+    char line[LOG_TOTAL_MSG_SIZE];
+    sinkU = Logger_Expand(line, sizeof(line), &capturedMsg);
+}
+
+/* Queues ----------------------------------------------------------------------*/
+static void LogRing_PutGetRun(uint32_t i) {
+    uint32_t record[8] = { i };
+    uint32_t out[8];
+    LogRing_Write(record, sizeof(record));
+    sinkU = LogRing_Read(out, sizeof(out));
+}
+
+static imu_ring_reader_t benchReader;
+
+static void ImuRing_Setup(void) {
+    ImuRing_Init();
+    ImuRing_ReaderInit(&benchReader);
+}
+
+static void ImuRing_PutGetRun(uint32_t i) {
+    imu_repo_t repo = { .seq_n = i + 1U, .timestamp_us = (uint64_t)i * 1000U };
+    imu_repo_t out;
+    ImuRing_Publish(&repo);
+    sinkU = ImuRing_Read(&benchReader, &out);
+}
+
+/* Attitude filter -------------------------------------------------------------*/
+static attitude_filter_t benchFilter;
+static imu_sample_t filterSamples[BENCH_INPUT_SETS];
+static uint64_t filterTimeUs;
+
+static void Attitude_Setup(void) {
+    benchSeed = 3;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++) {
+        float noise = (float)(Bench_Rand() % 1000U) * 1e-4f;
+        filterSamples[i] = (imu_sample_t){ 0.1f + noise, -0.2f, 9.78f - noise, 0.01f, -0.02f + noise, 0.005f };
+    }
+    AttitudeFilter_Init(&benchFilter, 1.0f, 0.05f);
+    filterTimeUs = 0;
+    AttitudeFilter_Update(&benchFilter, &filterSamples[0], filterTimeUs);
+}
+
+// One 1 kHz step per invocation
+static void Attitude_UpdateRun(uint32_t i) {
+    filterTimeUs += 1000U;
+    AttitudeFilter_Update(&benchFilter, &filterSamples[i & BENCH_INPUT_MASK], filterTimeUs);
+}
+
+/* Gyro bias --------------------------------------------------------------------*/
+static gyro_bias_t benchBias;
+static imu_sample_t restSamples[BENCH_INPUT_SETS];
+static uint64_t biasTimeUs;
+
+// Still and tilted with sensor noise, so the timed path includes the rest update
+static void GyroBias_Setup(void) {
+    benchSeed = 5;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++) {
+        float noise = (float)(Bench_Rand() % 1000U) * 1e-5f;
+        restSamples[i] = (imu_sample_t){ 1.2f + noise, -0.8f, 9.7f - noise, 0.03f + noise, -0.02f - noise, 0.05f };
+    }
+    GyroBias_Init(&benchBias, NULL, GYRO_BIAS_INIT_VAR);
+    for (biasTimeUs = 1000U; biasTimeUs <= GYRO_BIAS_BLOCK_US * (GYRO_BIAS_REST_BLOCKS + 1U); biasTimeUs += 1000U)
+        GyroBias_Update(&benchBias, &restSamples[biasTimeUs & BENCH_INPUT_MASK], biasTimeUs);
+}
+
+// One 1 kHz step per invocation, every 50th also closes a variance block
+static void GyroBias_UpdateRun(uint32_t i) {
+    biasTimeUs += 1000U;
+    sinkU = GyroBias_Update(&benchBias, &restSamples[i & BENCH_INPUT_MASK], biasTimeUs);
+}
+
+/* Magnetometer calibration ----------------------------------------------------*/
+#define MAGCAL_SOLVE_SAMPLES 512U
+
+static CCM_BSS mag_cal_fit_t benchFit;
+static CCM_BSS mag_cal_fit_t solveFit;
+static mag_cal_t benchCal;
+static mag_sample_t magSamples[BENCH_INPUT_SETS];
+
+// Field of 48 uT in a random direction, squashed and shifted like a mounted sensor
+static void MagCal_Sample(mag_sample_t* sample) {
+    float z = (float)(Bench_Rand() & 0xFFFFU) / 32768.0f - 1.0f;
+    float phi = (float)(Bench_Rand() & 0xFFFFU) * (6.2831853f / 65536.0f);
+    float r = sqrtf(1.0f - z * z);
+    sample->mx = 48.0f * 1.08f * r * cosf(phi) + 12.0f;
+    sample->my = 48.0f * 0.95f * r * sinf(phi) - 7.0f;
+    sample->mz = 48.0f * 1.02f * z + 20.0f;
+}
+
+static void MagCal_Setup(void) {
+    benchSeed = 4;
+    for (uint32_t i = 0; i < BENCH_INPUT_SETS; i++)
+        MagCal_Sample(&magSamples[i]);
+
+    mag_sample_t sample;
+    MagCalFit_Reset(&benchFit);
+    MagCalFit_Reset(&solveFit);
+    for (uint32_t i = 0; i < MAGCAL_SOLVE_SAMPLES; i++) {
+        MagCal_Sample(&sample);
+        MagCalFit_Add(&solveFit, &sample);
+    }
+    MagCalFit_Solve(&solveFit, &benchCal);
+}
+
+// One sample into the statistics, every MAG_CAL_BLOCK_SAMPLES-th also folds the block
+static void MagCal_AddRun(uint32_t i) {
+    MagCalFit_Add(&benchFit, &magSamples[i & BENCH_INPUT_MASK]);
+}
+
+static void MagCal_SolveRun(uint32_t i) {
+    (void)i;
+    sinkU = MagCalFit_Solve(&solveFit, &benchCal);
+}
+
+static void MagCal_ApplyRun(uint32_t i) {
+    mag_sample_t out;
+    MagCalFit_Apply(&benchCal, &magSamples[i & BENCH_INPUT_MASK], &out);
+    sinkF = out.mx + out.my + out.mz;
+}
+
+static const bench_kernel_t kernels[] = {
+    { "imu_convert",      Imu_ConvertSetup, Imu_ConvertRun,          NULL,           1 },
+    { "imu_sample",       Imu_ConvertSetup, Imu_SampleRun,           NULL,           1 },
+    { "imu_batch",        Imu_ConvertSetup, Imu_BatchRun,            NULL,           IMU_BATCH_MAX_SAMPLES },
+    { "imu_batch_aos",    Imu_ConvertSetup, Imu_BatchAosRun,         NULL,           IMU_BATCH_MAX_SAMPLES },
+    { "bmp280_temp",      Bmp280_Setup,     Bmp280_TempRun,          NULL,           1 },
+    { "bmp280_press",     Bmp280_Setup,     Bmp280_PressureRun,      NULL,           1 },
+    { "bmp280_temp_f",    Bmp280_Setup,     Bmp280_TempFloatRun,     NULL,           1 },
+    { "bmp280_press_f",   Bmp280_Setup,     Bmp280_PressureFloatRun, NULL,           1 },
+    { "bmp280_temp_dbl",  Bmp280_Setup,     Bmp280_TempDblRun,       NULL,           1 },
+    { "bmp280_press_dbl", Bmp280_Setup,     Bmp280_PressureDblRun,   NULL,           1 },
+    { "bmp388_temp",      Bmp388_Setup,     Bmp388_TempRun,          NULL,           1 },
+    { "bmp388_press",     Bmp388_Setup,     Bmp388_PressureRun,      NULL,           1 },
+    { "bmp388_temp_f",    Bmp388_Setup,     Bmp388_TempFloatRun,     NULL,           1 },
+    { "bmp388_press_f",   Bmp388_Setup,     Bmp388_PressureFloatRun, NULL,           1 },
+    { "altitude_powf",    Bmp280_Setup,     Altitude_Run,            NULL,           1 },
+    { "altitude_exact",   Altitude_Setup,   Altitude_ExactRun,       NULL,           1 },
+    { "altitude_table",   Altitude_Setup,   Altitude_TableRun,       NULL,           1 },
+    { "nmea_gga",         Nmea_GgaSetup,    Nmea_GgaRun,             NULL,           1 },
+    { "nmea_gga_strtok",  NULL,             Nmea_GgaStrtokRun,       NULL,           1 },
+    { "imu_conv_cold",    Imu_ConvertSetup, Imu_ConvertRun,          Bench_FlushArt, 1 },
+    { "imu_conv_ram",     Imu_ConvertSetup, Imu_ConvertRunRam,       Bench_FlushArt, 1 },
+    { "nmea_cksum_cold",  NULL,             Nmea_ChecksumRun,        Bench_FlushArt, 1 },
+    { "nmea_cksum_ram",   NULL,             Nmea_ChecksumRunRam,     Bench_FlushArt, 1 },
+    { "log_capture",      Log_Drain,        Log_CaptureRun,          Log_Drain,      1 },
+    { "log_expand",       Log_ExpandSetup,  Log_ExpandRun,           NULL,           1 },
+    { "logring_putget",   Log_Drain,        LogRing_PutGetRun,       NULL,           1 },
+    { "imuring_putget",   ImuRing_Setup,    ImuRing_PutGetRun,       NULL,           1 },
+    { "attitude_update",  Attitude_Setup,   Attitude_UpdateRun,      NULL,           1 },
+    { "gyrobias_update",  GyroBias_Setup,   GyroBias_UpdateRun,      NULL,           1 },
+    { "magcal_add",       MagCal_Setup,     MagCal_AddRun,           NULL,           1 },
+    { "magcal_solve",     MagCal_Setup,     MagCal_SolveRun,         NULL,           1 },
+    { "magcal_apply",     MagCal_Setup,     MagCal_ApplyRun,         NULL,           1 },
+};
+
+const bench_kernel_t* Bench_GetKernels(uint32_t* count) {
+    *count = sizeof(kernels) / sizeof(kernels[0]);
+    return kernels;
+}
\ No newline at end of file
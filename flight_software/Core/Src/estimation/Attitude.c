@@ -0,0 +1,132 @@
+/**
+ * Attitude estimation task, runs the attitude filter on every IMU sample
+ *
+ * The task sleeps until the acquisition scheduler signals a new sample, then drains its
+ * IMU ring reader so a late wakeup still integrates every sample with its own timestamp.
+ * Each sample updates the rest detector and gyro bias estimate and has the bias removed
+ * before the filter sees it, so nothing waits for a calibration window at boot. The estimate
+ * starts from the stored bias when there is one, and is the only bias correction: the filter
+ * runs without its integral term, which would otherwise chase the same error.
+ * The estimate is published under a sequence lock for any number of readers.
+ */
+
+#include "Attitude.h"
+#include "AcqScheduler.h"
+#include "ImuRing.h"
+#include "Logger.h"
+#include "MemSections.h"
+#include "Timebase.h"
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+
+// Logger tag
+static const char TAG[] = "ATTITUDE";
+
+static CCM_BSS attitude_filter_t filter;
+static CCM_BSS gyro_bias_t gyroBias;
+static uint64_t restSinceUs;
+
+// Stored bias to start from, set before the task starts
+static float seedBias[3];
+static bool seeded;
+
+// Latest estimate, published under a sequence lock (odd while writing)
+static attitude_state_t latestState;
+static volatile uint32_t latestLock;
+static volatile bool published;
+
+// Counters
+static volatile attitude_stats_t stats;
+
+static void Attitude_Publish(uint32_t seq, uint64_t timestampUs) {
+    latestLock++;
+    __DMB();
+    latestState.q = filter.q;
+    latestState.gyroBias[0] = gyroBias.bias[0];
+    latestState.gyroBias[1] = gyroBias.bias[1];
+    latestState.gyroBias[2] = gyroBias.bias[2];
+    latestState.atRest = gyroBias.atRest;
+    latestState.restSince_us = restSinceUs;
+    latestState.seq_n = seq;
+    latestState.timestamp_us = timestampUs;
+    __DMB();
+    latestLock++;
+    published = true;
+}
+
+void Attitude_SetGyroBias(const float bias[3]) {
+    seedBias[0] = bias[0];
+    seedBias[1] = bias[1];
+    seedBias[2] = bias[2];
+    seeded = true;
+}
+
+bool Attitude_GetLatest(attitude_state_t* stateBuff) {
+    if (!published)
+        return false;
+
+    uint32_t lock;
+    do {
+        lock = latestLock;
+        __DMB();
+        *stateBuff = latestState;
+        __DMB();
+    } while ((lock & 1U) || lock != latestLock);
+    return true;
+}
+
+bool Attitude_OnGround(void) {
+    attitude_state_t state;
+    return Attitude_GetLatest(&state) && state.atRest &&
+           state.timestamp_us - state.restSince_us >= ATTITUDE_GROUND_REST_US;
+}
+
+void Attitude_GetStats(attitude_stats_t* statsBuff) {
+    statsBuff->updates = stats.updates;
+    statsBuff->missedSamples = stats.missedSamples;
+    statsBuff->maxCycles = stats.maxCycles;
+    statsBuff->budgetOverruns = stats.budgetOverruns;
+}
+
+void AttitudeTask(void *argument) {
+    (void)argument;
+
+    AttitudeFilter_Init(&filter, ATTITUDE_KP, ATTITUDE_KI);
+    if (seeded)
+        GyroBias_Init(&gyroBias, seedBias, GYRO_BIAS_STORED_VAR);
+    else
+        GyroBias_Init(&gyroBias, NULL, GYRO_BIAS_INIT_VAR);
+    imu_ring_reader_t reader;
+    ImuRing_ReaderInit(&reader);
+
+    LOG(TAG, "Started attitude estimator");
+
+    imu_repo_t repo;
+    for (;;) {
+        osThreadFlagsWait(ACQ_FLAG_IMU, osFlagsWaitAny, osWaitForever);
+
+        bool updated = false;
+        while (ImuRing_Read(&reader, &repo)) {
+            uint32_t start = Timebase_GetCycles();
+            bool wasAtRest = gyroBias.atRest;
+            if (GyroBias_Update(&gyroBias, &repo.data, repo.timestamp_us) && !wasAtRest)
+                restSinceUs = repo.timestamp_us;
+            GyroBias_Apply(&gyroBias, &repo.data);
+            AttitudeFilter_Update(&filter, &repo.data, repo.timestamp_us);
+            uint32_t cycles = Timebase_GetCycles() - start;
+
+            stats.updates++;
+            if (cycles > stats.maxCycles)
+                stats.maxCycles = cycles;
+            if (cycles > ATTITUDE_CYCLE_BUDGET)
+                stats.budgetOverruns++;
+            updated = true;
+        }
+
+        if (updated) {
+            stats.missedSamples = reader.missed;
+            Attitude_Publish(repo.seq_n, repo.timestamp_us);
+        }
+    }
+}
\ No newline at end of file
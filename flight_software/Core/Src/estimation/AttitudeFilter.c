@@ -0,0 +1,130 @@
+/**
+ * Mahony quaternion complementary filter, single precision
+ *
+ * The gyro propagates the quaternion, and the cross product between the measured and the
+ * predicted gravity direction feeds back through a PI controller on the body rates.
+ * Everything stays in float so it maps onto the Cortex-M4F FPU, with one square root per
+ * normalization and no trigonometry in the update path.
+ */
+
+#include "AttitudeFilter.h"
+#include "MemSections.h"
+
+#include <math.h>
+
+#define GRAVITY             9.80665f
+#define ACCEL_GATE_LOW_SQ   (0.8f * 0.8f * GRAVITY * GRAVITY) // correct only between 0.8 g
+#define ACCEL_GATE_HIGH_SQ  (1.2f * 1.2f * GRAVITY * GRAVITY) // and 1.2 g
+#define MAX_STEP_US         100000U                           // longer gaps restart integration
+
+void AttitudeFilter_Init(attitude_filter_t* filter, float kp, float ki) {
+    filter->q = (quat_t){ .w = 1.0f };
+    filter->integral[0] = 0.0f;
+    filter->integral[1] = 0.0f;
+    filter->integral[2] = 0.0f;
+    filter->kp = kp;
+    filter->ki = ki;
+    filter->lastTimestampUs = 0;
+    filter->initialized = false;
+}
+
+// Levels the attitude from a gravity measurement, yaw starts at zero
+static void AttitudeFilter_Level(attitude_filter_t* filter, const imu_sample_t* sample) {
+    float roll = atan2f(sample->ay, sample->az);
+    float pitch = atan2f(-sample->ax, sqrtf(sample->ay * sample->ay + sample->az * sample->az));
+
+    float cr = cosf(roll * 0.5f);
+    float sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f);
+    float sp = sinf(pitch * 0.5f);
+    filter->q.w = cr * cp;
+    filter->q.x = sr * cp;
+    filter->q.y = cr * sp;
+    filter->q.z = -sr * sp;
+}
+
+RAMFUNC void AttitudeFilter_Update(attitude_filter_t* filter, const imu_sample_t* sample, uint64_t timestampUs) {
+    if (!filter->initialized) {
+        AttitudeFilter_Level(filter, sample);
+        filter->lastTimestampUs = timestampUs;
+        filter->initialized = true;
+        return;
+    }
+
+    // Out of order or after a long gap, only re-anchor the time reference
+    uint64_t lastUs = filter->lastTimestampUs;
+    filter->lastTimestampUs = timestampUs;
+    if (timestampUs <= lastUs || timestampUs - lastUs > MAX_STEP_US)
+        return;
+    float dt = (float)(uint32_t)(timestampUs - lastUs) * 1e-6f;
+
+    float q0 = filter->q.w;
+    float q1 = filter->q.x;
+    float q2 = filter->q.y;
+    float q3 = filter->q.z;
+    float gx = sample->gx;
+    float gy = sample->gy;
+    float gz = sample->gz;
+    float ax = sample->ax;
+    float ay = sample->ay;
+    float az = sample->az;
+
+    float accelSq = ax * ax + ay * ay + az * az;
+    if (accelSq > ACCEL_GATE_LOW_SQ && accelSq < ACCEL_GATE_HIGH_SQ) {
+        float recip = 1.0f / sqrtf(accelSq);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        // Gravity direction predicted by the current attitude, in the body frame
+        float vx = 2.0f * (q1 * q3 - q0 * q2);
+        float vy = 2.0f * (q0 * q1 + q2 * q3);
+        float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+
+        // Error is the rotation between measured and predicted gravity
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (filter->ki > 0.0f) {
+            filter->integral[0] += filter->ki * ex * dt;
+            filter->integral[1] += filter->ki * ey * dt;
+            filter->integral[2] += filter->ki * ez * dt;
+            gx += filter->integral[0];
+            gy += filter->integral[1];
+            gz += filter->integral[2];
+        }
+
+        gx += filter->kp * ex;
+        gy += filter->kp * ey;
+        gz += filter->kp * ez;
+    }
+
+    // q += 0.5 * q x omega * dt
+    float half = 0.5f * dt;
+    gx *= half;
+    gy *= half;
+    gz *= half;
+    float nq0 = q0 - q1 * gx - q2 * gy - q3 * gz;
+    float nq1 = q1 + q0 * gx + q2 * gz - q3 * gy;
+    float nq2 = q2 + q0 * gy - q1 * gz + q3 * gx;
+    float nq3 = q3 + q0 * gz + q1 * gy - q2 * gx;
+
+    float recip = 1.0f / sqrtf(nq0 * nq0 + nq1 * nq1 + nq2 * nq2 + nq3 * nq3);
+    filter->q.w = nq0 * recip;
+    filter->q.x = nq1 * recip;
+    filter->q.y = nq2 * recip;
+    filter->q.z = nq3 * recip;
+}
+
+void AttitudeFilter_ToEuler(const quat_t* q, float* roll, float* pitch, float* yaw) {
+    float sinp = 2.0f * (q->w * q->y - q->z * q->x);
+    if (sinp > 1.0f)
+        sinp = 1.0f;
+    else if (sinp < -1.0f)
+        sinp = -1.0f;
+
+    *roll = atan2f(2.0f * (q->w * q->x + q->y * q->z), 1.0f - 2.0f * (q->x * q->x + q->y * q->y));
+    *pitch = asinf(sinp);
+    *yaw = atan2f(2.0f * (q->w * q->z + q->x * q->y), 1.0f - 2.0f * (q->y * q->y + q->z * q->z));
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+/**
+ * Rest detection and recursive gyro bias estimation
+ *
+ * The REV1 driver averaged ten samples at boot, assumed the vehicle was still and level, and
+ * took exactly 1 g off accel Z. Here the vehicle is still when the per axis gyro and accel
+ * variance stayed low over the last GYRO_BIAS_REST_BLOCKS blocks, whatever its attitude. The
+ * window slides one block at a time, so only the sums of the open block are kept.
+ *
+ * The bias of each axis is a random walk measured directly by the gyro while at rest, a scalar
+ * Kalman filter. All three axes share the noise model and so the variance, and the gain is one
+ * division per sample. The variance grows with the drift whether at rest or not, so a bias
+ * that moved with temperature during a flight is picked up quickly at the next stop. The mean
+ * of the block that completes a rest is folded in as one averaged measurement, so the estimate
+ * is usable right after the first detected rest instead of after a fixed calibration window.
+ */
+
+#include "GyroBias.h"
+#include "MemSections.h"
+
+#include <stddef.h>
+
+void GyroBias_Init(gyro_bias_t* est, const float bias[3], float variance) {
+    for (uint32_t i = 0; i < 3; i++)
+        est->bias[i] = (bias != NULL) ? bias[i] : 0.0f;
+    est->variance = variance;
+    est->count = 0;
+    est->blockStartUs = 0;
+    est->lastTimestampUs = 0;
+    est->quietBlocks = 0;
+    est->atRest = false;
+    est->restUpdates = 0;
+}
+
+// One measurement of all three axes with noise variance measVar
+static inline void GyroBias_Correct(gyro_bias_t* est, const float meas[3], float measVar) {
+    float gain = est->variance / (est->variance + measVar);
+    for (uint32_t i = 0; i < 3; i++)
+        est->bias[i] += gain * (meas[i] - est->bias[i]);
+    est->variance -= gain * est->variance;
+}
+
+// Decides on the block that just closed, and at the start of a rest takes its mean
+static void GyroBias_CloseBlock(gyro_bias_t* est) {
+    float invN = 1.0f / (float)est->count;
+    float mean[6];
+    bool quiet = true;
+    for (uint32_t i = 0; i < 6; i++) {
+        mean[i] = est->sum[i] * invN;
+        float var = est->sumSq[i] * invN - mean[i] * mean[i];
+        quiet &= var <= ((i < 3) ? GYRO_BIAS_GYRO_VAR_MAX : GYRO_BIAS_ACCEL_VAR_MAX);
+        mean[i] += est->ref[i];
+    }
+    for (uint32_t i = 0; i < 3; i++)
+        quiet &= mean[i] <= GYRO_BIAS_RATE_MAX && mean[i] >= -GYRO_BIAS_RATE_MAX;
+
+    est->count = 0;
+    if (!quiet) {
+        est->quietBlocks = 0;
+        est->atRest = false;
+        return;
+    }
+
+    if (est->quietBlocks < GYRO_BIAS_REST_BLOCKS)
+        est->quietBlocks++;
+    if (!est->atRest && est->quietBlocks >= GYRO_BIAS_REST_BLOCKS) {
+        est->atRest = true;
+        GyroBias_Correct(est, mean, GYRO_BIAS_MEAS_VAR * invN);
+    }
+}
+
+RAMFUNC bool GyroBias_Update(gyro_bias_t* est, const imu_sample_t* sample, uint64_t timestampUs) {
+    const float v[6] = { sample->gx, sample->gy, sample->gz, sample->ax, sample->ay, sample->az };
+
+    // Out of order or after a long gap, start detecting again
+    uint64_t lastUs = est->lastTimestampUs;
+    est->lastTimestampUs = timestampUs;
+    if (timestampUs <= lastUs || timestampUs - lastUs > GYRO_BIAS_MAX_STEP_US) {
+        est->count = 0;
+        est->quietBlocks = 0;
+        est->atRest = false;
+    } else {
+        est->variance += GYRO_BIAS_DRIFT_VAR * (float)(uint32_t)(timestampUs - lastUs) * 1e-6f;
+    }
+
+    if (est->atRest) {
+        // Gate on the innovation before trusting the sample, a motion ends the rest right here
+        float gate = GYRO_BIAS_GATE_SQ * (est->variance + GYRO_BIAS_MEAS_VAR);
+        bool inGate = true;
+        for (uint32_t i = 0; i < 3; i++) {
+            float e = v[i] - est->bias[i];
+            inGate &= e * e <= gate;
+        }
+
+        if (inGate) {
+            GyroBias_Correct(est, v, GYRO_BIAS_MEAS_VAR);
+            est->restUpdates++;
+        } else {
+            est->count = 0;
+            est->quietBlocks = 0;
+            est->atRest = false;
+        }
+    }
+
+    // Block sums relative to the first sample, so the variance does not cancel in float
+    if (est->count == 0) {
+        est->blockStartUs = timestampUs;
+        for (uint32_t i = 0; i < 6; i++) {
+            est->ref[i] = v[i];
+            est->sum[i] = 0.0f;
+            est->sumSq[i] = 0.0f;
+        }
+    }
+    for (uint32_t i = 0; i < 6; i++) {
+        float d = v[i] - est->ref[i];
+        est->sum[i] += d;
+        est->sumSq[i] += d * d;
+    }
+    est->count++;
+
+    if (timestampUs - est->blockStartUs >= GYRO_BIAS_BLOCK_US)
+        GyroBias_CloseBlock(est);
+    return est->atRest;
+}
\ No newline at end of file
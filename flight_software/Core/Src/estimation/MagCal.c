@@ -0,0 +1,235 @@
+/**
+ * Background magnetometer calibration task, refines the hard and soft iron fit from live samples
+ *
+ * The magnetometer sample callback only sets a thread flag. The task, at the lowest flight
+ * priority, picks up the latest sample and adds it to the ellipsoid fit statistics if it is
+ * far enough from the last one taken, so hours sitting still do not swamp the few seconds of
+ * rotation that actually constrain the fit. Every MAG_CAL_SOLVE_INTERVAL accepted samples it
+ * solves, and a plausible result is swapped in under a sequence lock. Nothing is calibrated
+ * at startup, stored coefficients are used until the fit converges while the vehicle is
+ * handled, and a fit that differs from them is stored for the next boot. Writing a record
+ * stalls every flash read for about 0.6 ms, so it is queued in RAM and only written once the
+ * attitude estimator reports the vehicle on the ground. Being the lowest priority flight task
+ * it is also the one task that writes the CalStore, and stores the gyro bias the attitude
+ * estimator settled on along with its own coefficients. The task wakes on its own period as
+ * well, so the bias is stored and a silent magnetometer restarted without any mag samples.
+ */
+
+#include "MagCal.h"
+#include "AcqScheduler.h"
+#include "Attitude.h"
+#include "CalStore.h"
+#include "Logger.h"
+#include "MemSections.h"
+#include "Timebase.h"
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+
+#include <math.h>
+
+// Logger tag
+static const char TAG[] = "MAGCAL";
+
+static CCM_BSS mag_cal_fit_t fit;
+static osThreadId_t calThread;
+
+// Coefficients in use, published under a sequence lock (odd while writing)
+static mag_cal_t activeCal = {
+    .matrix = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}
+};
+static volatile uint32_t calLock;
+static volatile bool calibrated;
+
+// Record waiting for the ground, only this task touches it
+static cal_data_t queuedRecord;
+static bool queued;
+
+// Counters
+static volatile mag_cal_stats_t stats;
+
+// Wakes the task, called from the magnetometer transfer complete ISR
+static void MagCal_OnSample(const mag_repo_t* repo) {
+    (void)repo;
+    if (calThread != NULL && osKernelGetState() == osKernelRunning)
+        osThreadFlagsSet(calThread, ACQ_FLAG_MAG);
+}
+
+void MagCal_Set(const mag_cal_t* cal) {
+    calLock++;
+    __DMB();
+    activeCal = *cal;
+    __DMB();
+    calLock++;
+    calibrated = true;
+}
+
+bool MagCal_Get(mag_cal_t* calBuff) {
+    uint32_t lock;
+    do {
+        lock = calLock;
+        __DMB();
+        *calBuff = activeCal;
+        __DMB();
+    } while ((lock & 1U) || lock != calLock);
+    return calibrated;
+}
+
+void MagCal_Correct(const mag_sample_t* raw, mag_sample_t* out) {
+    mag_cal_t cal;
+    MagCal_Get(&cal);
+    MagCalFit_Apply(&cal, raw, out);
+}
+
+void MagCal_GetStats(mag_cal_stats_t* statsBuff) {
+    statsBuff->samples = stats.samples;
+    statsBuff->accepted = stats.accepted;
+    statsBuff->fits = stats.fits;
+    statsBuff->rejected = stats.rejected;
+    statsBuff->maxSolveCycles = stats.maxSolveCycles;
+    statsBuff->restarts = stats.restarts;
+}
+
+// The record the next change goes into, the queued one or else the stored one
+static void MagCal_Pending(cal_data_t* record) {
+    if (queued)
+        *record = queuedRecord;
+    else
+        CalStore_Load(record);
+}
+
+// Queues a fit that moved away from the stored one, once converged that is rarely
+static void MagCal_Queue(const mag_cal_t* cal) {
+    cal_data_t stored;
+    MagCal_Pending(&stored);
+    if (stored.valid & CAL_VALID_MAG) {
+        bool moved = false;
+        for (uint32_t i = 0; i < 3; i++) {
+            moved |= fabsf(cal->offset[i] - stored.mag.offset[i]) > MAG_CAL_STORE_UT;
+            for (uint32_t j = 0; j < 3; j++)
+                moved |= fabsf(cal->matrix[i][j] - stored.mag.matrix[i][j]) > MAG_CAL_STORE_MATRIX;
+        }
+        if (!moved)
+            return;
+    }
+
+    queuedRecord = stored;
+    queuedRecord.mag = *cal;
+    queuedRecord.valid |= CAL_VALID_MAG;
+    queued = true;
+}
+
+// Queues the gyro bias settled on the ground if it moved away from the stored one
+static void MagCal_QueueGyroBias(void) {
+    attitude_state_t state;
+    if (!Attitude_GetLatest(&state))
+        return;
+
+    cal_data_t stored;
+    MagCal_Pending(&stored);
+    if (stored.valid & CAL_VALID_GYRO) {
+        bool moved = false;
+        for (uint32_t i = 0; i < 3; i++)
+            moved |= fabsf(state.gyroBias[i] - stored.gyroBias[i]) > GYRO_BIAS_STORE_DELTA;
+        if (!moved)
+            return;
+    }
+
+    queuedRecord = stored;
+    for (uint32_t i = 0; i < 3; i++)
+        queuedRecord.gyroBias[i] = state.gyroBias[i];
+    queuedRecord.valid |= CAL_VALID_GYRO;
+    queued = true;
+}
+
+// Writes the queued record once on the ground. A failed write is not retried, a full sector
+// keeps failing until the next boot compacts it.
+static void MagCal_Flush(void) {
+    if (!Attitude_OnGround())
+        return;
+
+    MagCal_QueueGyroBias();
+    if (!queued)
+        return;
+
+    queued = false;
+    if (CalStore_Save(&queuedRecord))
+        LOG(TAG, "Calibration stored");
+    else
+        LOG_WARN(TAG, "Error storing calibration");
+}
+
+static void MagCal_Solve(void) {
+    mag_cal_t cal;
+    uint32_t start = Timebase_GetCycles();
+    bool solved = MagCalFit_Solve(&fit, &cal);
+    uint32_t cycles = Timebase_GetCycles() - start;
+    if (cycles > stats.maxSolveCycles)
+        stats.maxSolveCycles = cycles;
+
+    if (!solved || cal.fieldUt < MAG_CAL_FIELD_MIN_UT || cal.fieldUt > MAG_CAL_FIELD_MAX_UT ||
+        cal.axisRatio > MAG_CAL_MAX_AXIS_RATIO || cal.residual > MAG_CAL_MAX_RESIDUAL) {
+        stats.rejected++;
+        LOG_DEBUG(TAG, "Fit rejected (solved %d, field %.1f uT, ratio %.3f, residual %.4f)",
+                  solved, cal.fieldUt, cal.axisRatio, cal.residual);
+        return;
+    }
+
+    MagCal_Set(&cal);
+    stats.fits++;
+    LOG(TAG, "Calibration updated, offset [%.2f %.2f %.2f] uT, field %.1f uT, ratio %.3f",
+        cal.offset[0], cal.offset[1], cal.offset[2], cal.fieldUt, cal.axisRatio);
+    MagCal_Queue(&cal);
+}
+
+void MagCalTask(void *argument) {
+    (void)argument;
+
+    MagCalFit_Reset(&fit);
+    calThread = osThreadGetId();
+    Mag_SetSampleCallback(MagCal_OnSample);
+
+    LOG(TAG, "Started magnetometer calibration");
+
+    uint32_t wakeTicks = MAG_CAL_WAKE_MS * osKernelGetTickFreq() / 1000U;
+    mag_repo_t repo;
+    mag_sample_t last = {0};
+    uint32_t lastSeq = 0;
+    uint32_t sinceSolve = 0;
+    uint64_t lastSampleUs = Timebase_GetUs();
+    for (;;) {
+        osThreadFlagsWait(ACQ_FLAG_MAG, osFlagsWaitAny, wakeTicks);
+        MagCal_Flush();
+
+        uint64_t nowUs = Timebase_GetUs();
+        if (!Mag_GetRepo(&repo) || repo.seq_n == lastSeq) {
+            // The driver stops retrying a bus that keeps failing, a direct read starts it again
+            if (nowUs - lastSampleUs >= MAG_CAL_STALL_MS * 1000ULL) {
+                lastSampleUs = nowUs;
+                stats.restarts++;
+                Mag_StartRead();
+            }
+            continue;
+        }
+        lastSeq = repo.seq_n;
+        lastSampleUs = nowUs;
+        stats.samples++;
+
+        float dx = repo.data.mx - last.mx;
+        float dy = repo.data.my - last.my;
+        float dz = repo.data.mz - last.mz;
+        if (stats.accepted != 0 && dx * dx + dy * dy + dz * dz < MAG_CAL_MIN_SPACING_UT * MAG_CAL_MIN_SPACING_UT)
+            continue;
+
+        last = repo.data;
+        MagCalFit_Add(&fit, &repo.data);
+        stats.accepted++;
+        if (++sinceSolve < MAG_CAL_SOLVE_INTERVAL || MagCalFit_Count(&fit) < MAG_CAL_MIN_SAMPLES)
+            continue;
+
+        sinceSolve = 0;
+        MagCal_Solve();
+        if (MagCalFit_Count(&fit) >= MAG_CAL_MAX_SAMPLES)
+            MagCalFit_Scale(&fit, 0.5);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+/**
+ * Incremental least-squares ellipsoid fit for magnetometer hard and soft iron calibration
+ *
+ * Every sample adds its row phi = [x^2 y^2 z^2 2xy 2xz 2yz 2x 2y 2z] to the normal equations
+ * of the general ellipsoid phi * p = 1, so the whole history is 54 sums. The sums of fourth
+ * powers outgrow single precision within a few hundred samples, so they are kept in double,
+ * but the per-sample products run on the FPU in float and only a block of them is folded
+ * into the double sums at a time.
+ *
+ * The solve factors the 9x9 normal matrix, moves the quadric to its centre (the hard iron
+ * offset) and takes the symmetric square root of its shape matrix for the soft iron
+ * correction. The symmetric root, unlike a Cholesky factor, adds no rotation to the frame,
+ * so heading stays in the sensor axes.
+ */
+
+#include "MagCalFit.h"
+
+#include <math.h>
+#include <string.h>
+
+#define JACOBI_MAX_SWEEPS 32U
+
+static void MagCalFit_Fold(mag_cal_fit_t* fit) {
+    for (uint32_t k = 0; k < MAG_CAL_N_SUMS; k++) {
+        fit->ata[k] += fit->blockAta[k];
+        fit->blockAta[k] = 0.0f;
+    }
+    for (uint32_t i = 0; i < MAG_CAL_N_PARAMS; i++) {
+        fit->atb[i] += fit->blockAtb[i];
+        fit->blockAtb[i] = 0.0f;
+    }
+    fit->n += fit->blockCount;
+    fit->blockCount = 0;
+}
+
+void MagCalFit_Reset(mag_cal_fit_t* fit) {
+    memset(fit, 0, sizeof(*fit));
+}
+
+void MagCalFit_Add(mag_cal_fit_t* fit, const mag_sample_t* sample) {
+    const float x = sample->mx * (1.0f / MAG_CAL_SCALE_UT);
+    const float y = sample->my * (1.0f / MAG_CAL_SCALE_UT);
+    const float z = sample->mz * (1.0f / MAG_CAL_SCALE_UT);
+    const float phi[MAG_CAL_N_PARAMS] = {
+        x * x, y * y, z * z, 2.0f * x * y, 2.0f * x * z, 2.0f * y * z, 2.0f * x, 2.0f * y, 2.0f * z
+    };
+
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < MAG_CAL_N_PARAMS; i++) {
+        fit->blockAtb[i] += phi[i];
+        for (uint32_t j = i; j < MAG_CAL_N_PARAMS; j++)
+            fit->blockAta[k++] += phi[i] * phi[j];
+    }
+
+    if (++fit->blockCount == MAG_CAL_BLOCK_SAMPLES)
+        MagCalFit_Fold(fit);
+}
+
+void MagCalFit_Scale(mag_cal_fit_t* fit, double factor) {
+    MagCalFit_Fold(fit);
+    for (uint32_t k = 0; k < MAG_CAL_N_SUMS; k++)
+        fit->ata[k] *= factor;
+    for (uint32_t i = 0; i < MAG_CAL_N_PARAMS; i++)
+        fit->atb[i] *= factor;
+    fit->n *= factor;
+}
+
+uint32_t MagCalFit_Count(const mag_cal_fit_t* fit) {
+    return (uint32_t)fit->n + fit->blockCount;
+}
+
+// Solves a * p = b by Cholesky, a is overwritten with its factor. False if a pivot collapses.
+static bool MagCalFit_CholeskySolve(double a[MAG_CAL_N_PARAMS][MAG_CAL_N_PARAMS], const double* b, double* p) {
+    const uint32_t n = MAG_CAL_N_PARAMS;
+    for (uint32_t j = 0; j < n; j++) {
+        double d = a[j][j];
+        for (uint32_t k = 0; k < j; k++)
+            d -= a[j][k] * a[j][k];
+        if (!(d > MAG_CAL_PIVOT_MIN * a[j][j]))
+            return false;
+
+        double l = sqrt(d);
+        a[j][j] = l;
+        for (uint32_t i = j + 1; i < n; i++) {
+            double s = a[i][j];
+            for (uint32_t k = 0; k < j; k++)
+                s -= a[i][k] * a[j][k];
+            a[i][j] = s / l;
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        double s = b[i];
+        for (uint32_t k = 0; k < i; k++)
+            s -= a[i][k] * p[k];
+        p[i] = s / a[i][i];
+    }
+    for (uint32_t i = n; i-- > 0;) {
+        double s = p[i];
+        for (uint32_t k = i + 1; k < n; k++)
+            s -= a[k][i] * p[k];
+        p[i] = s / a[i][i];
+    }
+    return true;
+}
+
+static bool MagCalFit_Invert3(double m[3][3], double inv[3][3]) {
+    double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+    if (!(fabs(det) > 0.0))
+        return false;
+
+    double r = 1.0 / det;
+    inv[0][0] = c00 * r;
+    inv[1][0] = c01 * r;
+    inv[2][0] = c02 * r;
+    inv[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * r;
+    inv[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * r;
+    inv[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * r;
+    inv[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * r;
+    inv[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * r;
+    inv[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * r;
+    return true;
+}
+
+// Cyclic Jacobi eigen decomposition of a symmetric 3x3, m is diagonalised in place
+static void MagCalFit_Eigen3(double m[3][3], double eig[3], double v[3][3]) {
+    memset(v, 0, sizeof(double) * 9);
+    v[0][0] = v[1][1] = v[2][2] = 1.0;
+
+    for (uint32_t sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++) {
+        double off = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+        double diag = m[0][0] * m[0][0] + m[1][1] * m[1][1] + m[2][2] * m[2][2];
+        if (off <= 1e-30 * diag)
+            break;
+
+        for (uint32_t p = 0; p < 2; p++) {
+            for (uint32_t q = p + 1; q < 3; q++) {
+                if (m[p][q] == 0.0)
+                    continue;
+
+                double theta = (m[q][q] - m[p][p]) / (2.0 * m[p][q]);
+                double t = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0);
+                double s = t * c;
+                for (uint32_t k = 0; k < 3; k++) {
+                    double mkp = m[k][p];
+                    double mkq = m[k][q];
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (uint32_t k = 0; k < 3; k++) {
+                    double mpk = m[p][k];
+                    double mqk = m[q][k];
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (uint32_t k = 0; k < 3; k++) {
+                    double vkp = v[k][p];
+                    double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < 3; i++)
+        eig[i] = m[i][i];
+}
+
+bool MagCalFit_Solve(const mag_cal_fit_t* fit, mag_cal_t* cal) {
+    const uint32_t np = MAG_CAL_N_PARAMS;
+    double n = fit->n + (double)fit->blockCount;
+    if (n < (double)np)
+        return false;
+
+    // Unpack the normal equations, folding in the open block
+    double ata[MAG_CAL_N_SUMS];
+    double a[MAG_CAL_N_PARAMS][MAG_CAL_N_PARAMS];
+    double b[MAG_CAL_N_PARAMS];
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < np; i++) {
+        b[i] = fit->atb[i] + (double)fit->blockAtb[i];
+        for (uint32_t j = i; j < np; j++, k++) {
+            ata[k] = fit->ata[k] + (double)fit->blockAta[k];
+            a[i][j] = a[j][i] = ata[k];
+        }
+    }
+
+    // A collapsed pivot means the samples only cover a plane or a patch of the ellipsoid
+    double p[MAG_CAL_N_PARAMS];
+    if (!MagCalFit_CholeskySolve(a, b, p))
+        return false;
+
+    // Sum of squared residuals from the statistics alone, p^T A p - 2 p^T b + n
+    double r2 = n;
+    k = 0;
+    for (uint32_t i = 0; i < np; i++) {
+        r2 -= 2.0 * p[i] * b[i];
+        for (uint32_t j = i; j < np; j++, k++)
+            r2 += ((i == j) ? 1.0 : 2.0) * ata[k] * p[i] * p[j];
+    }
+
+    // x^T Q x + 2 v^T x = 1, centre c = -Q^-1 v and (x - c)^T Q (x - c) = 1 - v^T c
+    double q[3][3] = {
+        {p[0], p[3], p[4]},
+        {p[3], p[1], p[5]},
+        {p[4], p[5], p[2]}
+    };
+    double qInv[3][3];
+    if (!MagCalFit_Invert3(q, qInv))
+        return false;
+
+    double c[3];
+    for (uint32_t i = 0; i < 3; i++)
+        c[i] = -(qInv[i][0] * p[6] + qInv[i][1] * p[7] + qInv[i][2] * p[8]);
+    double scale = 1.0 - (p[6] * c[0] + p[7] * c[1] + p[8] * c[2]);
+    if (!(scale > 0.0))
+        return false;
+
+    // Shape matrix of the centred ellipsoid, positive definite or it is some other quadric
+    for (uint32_t i = 0; i < 3; i++)
+        for (uint32_t j = 0; j < 3; j++)
+            q[i][j] /= scale;
+
+    double eig[3];
+    double v[3][3];
+    MagCalFit_Eigen3(q, eig, v);
+    if (!(eig[0] > 0.0 && eig[1] > 0.0 && eig[2] > 0.0))
+        return false;
+
+    // Semi-axes are 1/sqrt(eig), their geometric mean is the radius the correction keeps
+    double radius = pow(eig[0] * eig[1] * eig[2], -1.0 / 6.0);
+    double eigMin = fmin(eig[0], fmin(eig[1], eig[2]));
+    double eigMax = fmax(eig[0], fmax(eig[1], eig[2]));
+
+    double w[3];
+    for (uint32_t i = 0; i < 3; i++)
+        w[i] = radius * sqrt(eig[i]);
+    for (uint32_t i = 0; i < 3; i++) {
+        cal->offset[i] = (float)(c[i] * MAG_CAL_SCALE_UT);
+        for (uint32_t j = 0; j < 3; j++)
+            cal->matrix[i][j] = (float)(v[i][0] * w[0] * v[j][0] + v[i][1] * w[1] * v[j][1] + v[i][2] * w[2] * v[j][2]);
+    }
+    cal->fieldUt = (float)(radius * MAG_CAL_SCALE_UT);
+    cal->axisRatio = (float)sqrt(eigMax / eigMin);
+    cal->residual = (float)sqrt(fmax(r2, 0.0) / n);
+    return true;
+}
\ No newline at end of file
@@ -24,6 +24,8 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Timebase.h"
+#include "MemSections.h"
 
 /* USER CODE END Includes */
 
@@ -44,7 +46,8 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+/* heap_4 arena, CPU-only so it lives in CCM (configAPPLICATION_ALLOCATED_HEAP) */
+CCM_BSS uint8_t ucHeap[configTOTAL_HEAP_SIZE];
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -52,6 +55,24 @@
 
 /* USER CODE END FunctionPrototypes */
 
+/* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* USER CODE BEGIN 1 */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+void configureTimerForRunTimeStats(void)
+{
+  // Run time is counted in Timebase microseconds, already running since SystemInitializer_Init
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  // Wraps after ~71 minutes, consumers only use differences between samples
+  return (unsigned long)Timebase_GetUs();
+}
+/* USER CODE END 1 */
+
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
@@ -4,43 +4,238 @@
 
 #include "SystemInitializer.h"
 #include "Logger.h"
+#include "SysMonitor.h"
+#include "Timebase.h"
+#include "CalStore.h"
+#include "MemSections.h"
+#include "IMUInterface.h"
+#include "BaroInterface.h"
+#include "MagInterface.h"
+#include "GpsInterface.h"
+#include "AcqScheduler.h"
+#include "Attitude.h"
+#include "MagCal.h"
+#include "main.h"
+#ifdef FSW_BENCHMARK
+#include "Bench.h"
+#endif
 
+#include "FreeRTOS.h"
 #include "cmsis_os2.h"
 
 // Logger tag
 static const char TAG[] = "SYSINIT";
 
-// Task handles
+// Sensor rates
+#define IMU_RATE_HZ  1000U
+#define IMU_BATCH    1U    // samples per IMU read, above 1 drains the device FIFO in batches (8 kHz)
+#define BARO_RATE_HZ 50U
+#define MAG_RATE_HZ  100U
+
+// Task stacks in bytes, trim against the SysMonitor stack high-water marks
+#define LOGGER_STACK_SIZE   3072U
+#define ATTITUDE_STACK_SIZE 1024U
+#define SYSMON_STACK_SIZE   1024U
+#define MAGCAL_STACK_SIZE   2048U
+#define GPS_STACK_SIZE      1024U
+#define BENCH_STACK_SIZE    3072U
+
+// Declares the statically allocated control block and stack of one task, both in CCM
+#define SYS_TASK_MEMORY(mem, stackBytes)                                    \
+    static CCM_BSS StaticTask_t mem##Cb;                                    \
+    static CCM_BSS uint64_t mem##Stack[(stackBytes) / sizeof(uint64_t)]
+
+// One entry of the task table
+#define SYS_TASK(func, taskName, prio, mem, handle)                         \
+    { func, { .name = taskName, .priority = prio,                           \
+              .cb_mem = &mem##Cb, .cb_size = sizeof(mem##Cb),               \
+              .stack_mem = mem##Stack, .stack_size = sizeof(mem##Stack) },  \
+      handle }
+
+typedef struct {
+    osThreadFunc_t func;
+    osThreadAttr_t attr;
+    osThreadId_t* handle;
+} sys_task_t;
+
+// Every task in the system, created in order by SystemInitializer_Start. Nothing is taken
+// from the FreeRTOS heap, so RAM use is fixed at link time and shows up in tools/ram_budget.py.
+#ifndef FSW_BENCHMARK
 static osThreadId_t loggerTaskHandle;
+static osThreadId_t attitudeTaskHandle;
+static osThreadId_t sysMonitorTaskHandle;
+static osThreadId_t magCalTaskHandle;
+static osThreadId_t gpsTaskHandle;
+SYS_TASK_MEMORY(logger, LOGGER_STACK_SIZE);
+SYS_TASK_MEMORY(attitude, ATTITUDE_STACK_SIZE);
+SYS_TASK_MEMORY(sysMonitor, SYSMON_STACK_SIZE);
+SYS_TASK_MEMORY(magCal, MAGCAL_STACK_SIZE);
+SYS_TASK_MEMORY(gps, GPS_STACK_SIZE);
+
+static const sys_task_t sysTasks[] = {
+    SYS_TASK(LoggerTask,     "Logger",   osPriorityLow,         logger,     &loggerTaskHandle),
+    SYS_TASK(AttitudeTask,   "Attitude", osPriorityHigh,        attitude,   &attitudeTaskHandle),
+    SYS_TASK(SysMonitorTask, "SysMon",   osPriorityBelowNormal, sysMonitor, &sysMonitorTaskHandle),
+    SYS_TASK(MagCalTask,     "MagCal",   osPriorityLow,         magCal,     &magCalTaskHandle),
+    SYS_TASK(GpsTask,        "GPS",      osPriorityBelowNormal, gps,        &gpsTaskHandle),
+};
+#else
+// Benchmark task replaces the flight tasks and owns the CDC link
+static osThreadId_t benchTaskHandle;
+SYS_TASK_MEMORY(bench, BENCH_STACK_SIZE);
+
+static const sys_task_t sysTasks[] = {
+    SYS_TASK(BenchTask, "Bench", osPriorityNormal, bench, &benchTaskHandle),
+};
+#endif
 
 // System Hardware Handles
 static SystemHardwareHandles_t sysHardwareHandles;
 
+// Hands the stored coefficients to the modules that use them, parts not in the record keep their defaults
+static void SystemInitializer_ApplyCalibration(const cal_data_t* cal) {
+    const imu_cal_t* imuCal = (cal->valid & CAL_VALID_IMU) ? &cal->imu : NULL;
+    const float* rotation = (cal->valid & CAL_VALID_BOARD) ? cal->boardRotation : NULL;
+    if (!Imu_SetCalibration(imuCal, rotation))
+        LOG_DIRECT(TAG, "Error applying IMU calibration");
+
+    if (cal->valid & CAL_VALID_MAG)
+        MagCal_Set(&cal->mag);
+    if (cal->valid & CAL_VALID_GYRO)
+        Attitude_SetGyroBias(cal->gyroBias);
+}
+
 bool SystemInitializer_Init(SystemHardwareHandles_t hardwareHandles) {
     sysHardwareHandles = hardwareHandles;
 
-    // Initialize logger first
+    // Timebase first, everything after timestamps against it
+    Timebase_Init();
+
+    // Initialize logger
     if (!Logger_Init(LOGGER_TYPE_UART, sysHardwareHandles.p_huart1)) 
         return false;
     LOG_DIRECT(TAG, "Logger initialized");
 
+#ifdef FSW_BENCHMARK
+    // Benchmark variant runs without sensors
+    LOG_DIRECT(TAG, "Benchmark build, sensors skipped");
+    return true;
+#endif
+
+    // Initialize sensors
+    if (!Imu_Init(sysHardwareHandles, IMU_RATE_HZ))
+        return false;
+    LOG_DIRECT(TAG, "IMU initialized");
+
+    if (!Baro_Init(sysHardwareHandles, BARO_RATE_HZ))
+        return false;
+    LOG_DIRECT(TAG, "Barometer initialized");
+
+    if (!Mag_Init(sysHardwareHandles, MAG_RATE_HZ))
+        return false;
+    LOG_DIRECT(TAG, "Magnetometer initialized");
+
+    if (!Gps_Init(sysHardwareHandles))
+        return false;
+    LOG_DIRECT(TAG, "GPS initialized");
+
+    // Stored calibration instead of calibrating at boot, the estimators refine it online. About
+    // once every 900 saves this also compacts the store, a sector erase that stalls one to two seconds.
+    uint64_t calStartUs = Timebase_GetUs();
+    cal_data_t cal;
+    bool calStored = CalStore_Init() && CalStore_Load(&cal);
+    if (calStored)
+        SystemInitializer_ApplyCalibration(&cal);
+    cal_store_stats_t calStats;
+    CalStore_GetStats(&calStats);
+    LOG_DIRECT(TAG, "Calibration %s in %u us (record %u, %u bytes used, %u erases)",
+               calStored ? "loaded" : "not stored", (uint32_t)(Timebase_GetUs() - calStartUs),
+               calStats.sequence, calStats.bytesUsed, calStats.eraseCount);
+
+    // Sample on the IMU data-ready interrupt
+    if (!AcqScheduler_Init(IMU_BATCH))
+        return false;
+
     LOG_DIRECT(TAG, "System Initialized");
     return true;
 }
 
 void SystemInitializer_Start() {
-    // Create logger task
-    osThreadAttr_t logAttr = {
-        .name = "Logger",
-        .stack_size = 3072,
-        .priority = osPriorityLow
-    };
-    loggerTaskHandle = osThreadNew(LoggerTask, NULL, &logAttr);
+    // Create tasks
+    for (uint32_t i = 0; i < sizeof(sysTasks) / sizeof(sysTasks[0]); i++) {
+        const sys_task_t* task = &sysTasks[i];
+        *task->handle = osThreadNew(task->func, NULL, &task->attr);
+        if (*task->handle == NULL)
+            LOG_DIRECT(TAG, "Error creating %s task", task->attr.name);
+    }
+
+#ifndef FSW_BENCHMARK
+    // Attitude estimator is woken on every IMU sample
+    if (!AcqScheduler_Subscribe(attitudeTaskHandle, ACQ_FLAG_IMU))
+        LOG_DIRECT(TAG, "Error subscribing attitude estimator");
+
+    // Subscribers are in place, let the IMU start pacing the pipeline
+    if (!AcqScheduler_Start())
+        LOG_DIRECT(TAG, "Error starting acquisition scheduler");
+
+    // The barometer and magnetometer pace themselves on their own data-ready lines
+    if (!Baro_SetDataReadyInterrupt(true))
+        LOG_DIRECT(TAG, "Error starting barometer");
+    if (!Mag_SetDataReadyInterrupt(true))
+        LOG_DIRECT(TAG, "Error starting magnetometer");
+
+    // The GPS task is woken by the receive events, the DMA keeps every byte until it runs
+    if (!Gps_Start())
+        LOG_DIRECT(TAG, "Error starting GPS receiver");
+#endif
 
     // Start kernel
     osKernelStart();
 }
 
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin == IMU_INT_Pin)
+        AcqScheduler_OnDataReady(Timebase_GetUs());
+    else if (GPIO_Pin == BARO_INT_Pin)
+        Baro_OnDataReady(Timebase_GetUs());
+    else if (GPIO_Pin == MAG_DRDY_Pin)
+        Mag_OnDataReady(Timebase_GetUs());
+}
+
+// SPI completions are routed to the driver that owns the bus
+RAMFUNC void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == sysHardwareHandles.p_hspi2)
+        Imu_OnTransferComplete();
+    else if (hspi == sysHardwareHandles.p_hspi1)
+        Baro_OnTransferComplete();
+}
+
+// The half duplex mag bus completes in two steps, address out then burst in
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == sysHardwareHandles.p_hspi3)
+        Mag_OnTransferComplete();
+}
+
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == sysHardwareHandles.p_hspi3)
+        Mag_OnTransferComplete();
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == sysHardwareHandles.p_hspi2)
+        Imu_OnTransferError();
+    else if (hspi == sysHardwareHandles.p_hspi1)
+        Baro_OnTransferError();
+    else if (hspi == sysHardwareHandles.p_hspi3)
+        Mag_OnTransferError();
+}
+
+// Circular receive events, half and full buffer and the idle line after each burst
+RAMFUNC void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {
+    if (huart == sysHardwareHandles.p_huart2)
+        Gps_OnRxEvent(Size, Timebase_GetUs());
+}
+
 void SystemInitializer_Stop() {
     // not implemented
     return;
@@ -0,0 +1,123 @@
+/**
+ * Fixed-rate sensor acquisition scheduler, paced by the IMU data-ready interrupt
+ *
+ * Every MPU6500 INT edge starts a DMA read of the IMU. When the sample is published the
+ * scheduler wakes the subscribed tasks with thread flags, which FreeRTOS delivers as direct
+ * task notifications. The IMU consumers therefore run phase-locked to the gyro sample clock
+ * instead of polling on kernel ticks. In FIFO batch mode only every Nth edge drains the
+ * device FIFO, the samples are published one by one and the subscribers woken once per batch. Sensors with their own data-ready line (barometer,
+ * magnetometer) and asynchronous sources (GPS) are not scheduled here, their drivers wake
+ * their own tasks.
+ */
+
+#include "AcqScheduler.h"
+#include "MemSections.h"
+
+#include <stddef.h>
+
+typedef struct {
+    osThreadId_t thread;
+    uint32_t flags;
+} acq_subscriber_t;
+
+static acq_subscriber_t subscribers[ACQ_MAX_SUBSCRIBERS];
+static uint8_t nSubscribers;
+static uint32_t periodUs;
+static uint64_t lastEdgeUs;
+static uint16_t batchEdges;     // edges per read, 1 without the FIFO
+static uint16_t edgeCountdown;  // edges until the next FIFO drain
+
+// Counters
+static volatile acq_stats_t stats;
+
+// Wakes every subscriber, called from the IMU transfer complete ISR
+static RAMFUNC void AcqScheduler_Notify(void) {
+    // Edges may arrive between AcqScheduler_Start and the kernel starting
+    if (osKernelGetState() != osKernelRunning)
+        return;
+
+    for (uint8_t i = 0; i < nSubscribers; i++)
+        osThreadFlagsSet(subscribers[i].thread, subscribers[i].flags);
+}
+
+static RAMFUNC void AcqScheduler_OnSample(const imu_repo_t* repo) {
+    (void)repo;
+    stats.samples++;
+    if (batchEdges == 1U)
+        AcqScheduler_Notify();
+}
+
+// A FIFO batch has been published sample by sample, subscribers drain it in one wakeup
+static RAMFUNC void AcqScheduler_OnBatch(const imu_batch_t* batch) {
+    (void)batch;
+    AcqScheduler_Notify();
+}
+
+bool AcqScheduler_Init(uint16_t fifoBatch) {
+    periodUs = Imu_GetSamplePeriodUs();
+    if (periodUs == 0 || fifoBatch == 0 || fifoBatch > ACQ_MAX_FIFO_BATCH)
+        return false;
+
+    // The FIFO only fills while it is enabled, so it is set up before the first edge
+    if (!Imu_SetFifoMode(fifoBatch > 1U))
+        return false;
+    batchEdges = fifoBatch;
+    edgeCountdown = fifoBatch;
+
+    nSubscribers = 0;
+    lastEdgeUs = 0;
+    stats.edges = 0;
+    stats.samples = 0;
+    stats.overruns = 0;
+    stats.maxJitterUs = 0;
+
+    Imu_SetSampleCallback(AcqScheduler_OnSample);
+    Imu_SetBatchCallback((fifoBatch > 1U) ? AcqScheduler_OnBatch : NULL);
+    return true;
+}
+
+bool AcqScheduler_Subscribe(osThreadId_t thread, uint32_t flags) {
+    if (thread == NULL || nSubscribers >= ACQ_MAX_SUBSCRIBERS)
+        return false;
+
+    subscribers[nSubscribers].thread = thread;
+    subscribers[nSubscribers].flags = flags;
+    nSubscribers++;
+    return true;
+}
+
+bool AcqScheduler_Start(void) {
+    return Imu_SetDataReadyInterrupt(true);
+}
+
+RAMFUNC void AcqScheduler_OnDataReady(uint64_t timestampUs) {
+    stats.edges++;
+
+    // Jitter of the edge interval against the configured sample period
+    if (lastEdgeUs != 0) {
+        uint32_t interval = (uint32_t)(timestampUs - lastEdgeUs);
+        uint32_t jitter = (interval > periodUs) ? interval - periodUs : periodUs - interval;
+        if (jitter > stats.maxJitterUs)
+            stats.maxJitterUs = jitter;
+    }
+    lastEdgeUs = timestampUs;
+
+    if (batchEdges == 1U) {
+        if (!Imu_StartRead())
+            stats.overruns++;
+        return;
+    }
+
+    if (--edgeCountdown != 0)
+        return;
+    edgeCountdown = batchEdges;
+    if (!Imu_StartFifoDrain())
+        stats.overruns++;
+}
+
+void AcqScheduler_GetStats(acq_stats_t* statsBuff) {
+    statsBuff->edges = stats.edges;
+    statsBuff->samples = stats.samples;
+    statsBuff->overruns = stats.overruns;
+    statsBuff->maxJitterUs = stats.maxJitterUs;
+}
\ No newline at end of file
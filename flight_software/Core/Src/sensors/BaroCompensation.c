@@ -0,0 +1,181 @@
+/**
+ * Bosch BMP280 and BMP388 compensation
+ *
+ * The integer paths follow the datasheet (BMP280) and the Bosch BMP3 API (BMP388) operation for
+ * operation, with left shifts of signed values written as multiplications so they stay defined
+ * C. The float paths keep every literal single precision, the FPv4 has no double unit and a
+ * stray double literal pulls in software emulation.
+ */
+
+#include "BaroCompensation.h"
+
+static inline uint16_t Baro_U16(const uint8_t* p) {
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline int16_t Baro_S16(const uint8_t* p) {
+    return (int16_t)Baro_U16(p);
+}
+
+/* BMP280 ----------------------------------------------------------------------*/
+void Bmp280_ParseCalib(const uint8_t raw[BMP280_CALIB_LEN], bmp280_calib_t* calib) {
+    calib->T1 = Baro_U16(&raw[0]);
+    calib->T2 = Baro_S16(&raw[2]);
+    calib->T3 = Baro_S16(&raw[4]);
+    calib->P1 = Baro_U16(&raw[6]);
+    calib->P2 = Baro_S16(&raw[8]);
+    calib->P3 = Baro_S16(&raw[10]);
+    calib->P4 = Baro_S16(&raw[12]);
+    calib->P5 = Baro_S16(&raw[14]);
+    calib->P6 = Baro_S16(&raw[16]);
+    calib->P7 = Baro_S16(&raw[18]);
+    calib->P8 = Baro_S16(&raw[20]);
+    calib->P9 = Baro_S16(&raw[22]);
+}
+
+int32_t Bmp280_CompensateTemp(const bmp280_calib_t* calib, int32_t adcT, int32_t* tFine) {
+    int32_t var1 = (((adcT >> 3) - ((int32_t)calib->T1 * 2)) * (int32_t)calib->T2) >> 11;
+    int32_t var2 = (((((adcT >> 4) - (int32_t)calib->T1) * ((adcT >> 4) - (int32_t)calib->T1)) >> 12) *
+                    (int32_t)calib->T3) >> 14;
+    *tFine = var1 + var2;
+    return (*tFine * 5 + 128) >> 8;
+}
+
+uint32_t Bmp280_CompensatePressure(const bmp280_calib_t* calib, int32_t adcP, int32_t tFine) {
+    int64_t var1 = (int64_t)tFine - 128000;
+    int64_t var2 = var1 * var1 * (int64_t)calib->P6;
+    var2 = var2 + var1 * (int64_t)calib->P5 * 131072;       // << 17
+    var2 = var2 + (int64_t)calib->P4 * 34359738368LL;       // << 35
+    var1 = ((var1 * var1 * (int64_t)calib->P3) >> 8) + var1 * (int64_t)calib->P2 * 4096; // << 12
+    var1 = ((140737488355328LL + var1) * (int64_t)calib->P1) >> 33; // 1 << 47
+    if (var1 == 0)
+        return 0; // avoid division by zero
+
+    int64_t p = 1048576 - adcP;
+    p = ((p * 2147483648LL - var2) * 3125) / var1;          // << 31
+    var1 = ((int64_t)calib->P9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)calib->P8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + (int64_t)calib->P7 * 16; // << 4
+    return (uint32_t)p;
+}
+
+float Bmp280_CompensateTempF(const bmp280_calib_t* calib, int32_t adcT, float* tFine) {
+    float t1 = (float)calib->T1;
+    float x = (float)adcT;
+
+    float var1 = (x / 16384.0f - t1 / 1024.0f) * (float)calib->T2;
+    float d = x / 131072.0f - t1 / 8192.0f;
+    float var2 = d * d * (float)calib->T3;
+    *tFine = var1 + var2;
+    return (var1 + var2) / 5120.0f;
+}
+
+float Bmp280_CompensatePressureF(const bmp280_calib_t* calib, int32_t adcP, float tFine) {
+    float var1 = tFine / 2.0f - 64000.0f;
+    float var2 = var1 * var1 * (float)calib->P6 / 32768.0f;
+    var2 = var2 + var1 * (float)calib->P5 * 2.0f;
+    var2 = var2 / 4.0f + (float)calib->P4 * 65536.0f;
+    var1 = ((float)calib->P3 * var1 * var1 / 524288.0f + (float)calib->P2 * var1) / 524288.0f;
+    var1 = (1.0f + var1 / 32768.0f) * (float)calib->P1;
+    if (var1 == 0.0f)
+        return 0.0f; // avoid division by zero
+
+    float p = 1048576.0f - (float)adcP;
+    p = (p - var2 / 4096.0f) * 6250.0f / var1;
+    var1 = (float)calib->P9 * p * p / 2147483648.0f;
+    var2 = p * (float)calib->P8 / 32768.0f;
+    return p + (var1 + var2 + (float)calib->P7) / 16.0f;
+}
+
+/* BMP388 ----------------------------------------------------------------------*/
+void Bmp388_ParseCalib(const uint8_t raw[BMP388_CALIB_LEN], bmp388_calib_t* calib) {
+    calib->T1 = Baro_U16(&raw[0]);
+    calib->T2 = Baro_U16(&raw[2]);
+    calib->T3 = (int8_t)raw[4];
+    calib->P1 = Baro_S16(&raw[5]);
+    calib->P2 = Baro_S16(&raw[7]);
+    calib->P3 = (int8_t)raw[9];
+    calib->P4 = (int8_t)raw[10];
+    calib->P5 = Baro_U16(&raw[11]);
+    calib->P6 = Baro_U16(&raw[13]);
+    calib->P7 = (int8_t)raw[15];
+    calib->P8 = (int8_t)raw[16];
+    calib->P9 = Baro_S16(&raw[17]);
+    calib->P10 = (int8_t)raw[19];
+    calib->P11 = (int8_t)raw[20];
+
+    // Datasheet 9.1, the powers of two are exact in single precision
+    calib->parT[0] = (float)calib->T1 * 256.0f;                      // 2^8
+    calib->parT[1] = (float)calib->T2 / 1073741824.0f;               // 2^30
+    calib->parT[2] = (float)calib->T3 / 281474976710656.0f;          // 2^48
+    calib->parP[0] = ((float)calib->P1 - 16384.0f) / 1048576.0f;     // 2^20
+    calib->parP[1] = ((float)calib->P2 - 16384.0f) / 536870912.0f;   // 2^29
+    calib->parP[2] = (float)calib->P3 / 4294967296.0f;               // 2^32
+    calib->parP[3] = (float)calib->P4 / 137438953472.0f;             // 2^37
+    calib->parP[4] = (float)calib->P5 * 8.0f;                        // 2^-3
+    calib->parP[5] = (float)calib->P6 / 64.0f;                       // 2^6
+    calib->parP[6] = (float)calib->P7 / 256.0f;                      // 2^8
+    calib->parP[7] = (float)calib->P8 / 32768.0f;                    // 2^15
+    calib->parP[8] = (float)calib->P9 / 281474976710656.0f;          // 2^48
+    calib->parP[9] = (float)calib->P10 / 281474976710656.0f;         // 2^48
+    calib->parP[10] = (float)calib->P11 / 36893488147419103232.0f;   // 2^65
+}
+
+int32_t Bmp388_CompensateTemp(const bmp388_calib_t* calib, uint32_t adcT, int64_t* tLin) {
+    int64_t pd1 = (int64_t)adcT - (int64_t)256 * calib->T1;
+    int64_t pd2 = (int64_t)calib->T2 * pd1;
+    int64_t pd3 = pd1 * pd1;
+    int64_t pd4 = pd3 * calib->T3;
+    int64_t pd5 = pd2 * 262144 + pd4;
+    *tLin = pd5 / 4294967296LL;
+    return (int32_t)((*tLin * 25) / 16384);
+}
+
+uint32_t Bmp388_CompensatePressure(const bmp388_calib_t* calib, uint32_t adcP, int64_t tLin) {
+    int64_t up = adcP;
+
+    int64_t pd1 = tLin * tLin;
+    int64_t pd2 = pd1 / 64;
+    int64_t pd3 = (pd2 * tLin) / 256;
+    int64_t pd4 = (calib->P8 * pd3) / 32;
+    int64_t pd5 = (calib->P7 * pd1) * 16;
+    int64_t pd6 = (calib->P6 * tLin) * 4194304;
+    int64_t offset = (int64_t)calib->P5 * 140737488355328LL + pd4 + pd5 + pd6;
+
+    pd2 = (calib->P4 * pd3) / 32;
+    pd4 = (calib->P3 * pd1) * 4;
+    pd5 = ((int64_t)calib->P2 - 16384) * tLin * 2097152;
+    int64_t sensitivity = ((int64_t)calib->P1 - 16384) * 70368744177664LL + pd2 + pd4 + pd5;
+
+    pd1 = (sensitivity / 16777216) * up;
+    pd2 = calib->P10 * tLin;
+    pd3 = pd2 + (int64_t)65536 * calib->P9;
+    pd4 = (pd3 * up) / 8192;
+    // Divided by 10 and multiplied back to keep up * pd4 in range, as the reference does
+    pd5 = (up * (pd4 / 10)) / 512;
+    pd5 = pd5 * 10;
+    pd6 = up * up;
+    pd2 = (calib->P11 * pd6) / 65536;
+    pd3 = (pd2 * up) / 128;
+    pd4 = offset / 4 + pd1 + pd5 + pd3;
+    return (uint32_t)(((uint64_t)pd4 * 25) / 1099511627776ULL);
+}
+
+float Bmp388_CompensateTempF(const bmp388_calib_t* calib, uint32_t adcT) {
+    float pd1 = (float)adcT - calib->parT[0];
+    float pd2 = pd1 * calib->parT[1];
+    return pd2 + pd1 * pd1 * calib->parT[2];
+}
+
+float Bmp388_CompensatePressureF(const bmp388_calib_t* calib, uint32_t adcP, float tLin) {
+    const float* par = calib->parP;
+    float t2 = tLin * tLin;
+    float t3 = t2 * tLin;
+    float up = (float)adcP;
+
+    float out1 = par[4] + par[5] * tLin + par[6] * t2 + par[7] * t3;
+    float out2 = up * (par[0] + par[1] * tLin + par[2] * t2 + par[3] * t3);
+    float up2 = up * up;
+    float out3 = up2 * (par[8] + par[9] * tLin) + up2 * up * par[10];
+    return out1 + out2 + out3;
+}
\ No newline at end of file
@@ -0,0 +1,291 @@
+/**
+ * Implements the BaroInterface for the BMP388 over SPI
+ *
+ * The device free runs in normal mode and pulses INT when a measurement is ready. The edge
+ * starts one DMA burst over the data registers up to INT_STATUS, which also clears the
+ * interrupt, and the completion ISR compensates and publishes the sample. Nothing waits on
+ * the bus after init.
+ */
+#include "stm32f4xx_hal.h"
+
+#include "BaroInterface.h"
+#include "BaroCompensation.h"
+#include "Logger.h"
+#include "MemSections.h"
+#include "Timebase.h"
+#include "main.h"
+
+#include <string.h>
+
+#define CHIP_ID_VALUE       (0x50)
+#define REG_CHIP_ID         (0x00)
+#define REG_ERR             (0x02) // fatal, command and configuration errors
+#define REG_STATUS          (0x03) // command ready, data ready
+#define REG_DATA_BASE       (0x04) // pressure then temperature, 24 bit LSB first
+#define REG_INT_STATUS      (0x11) // cleared on read
+#define REG_INT_CTRL        (0x19) // INT pin config, data ready enable
+#define REG_PWR_CTRL        (0x1B) // sensor enable, power mode
+#define REG_OSR             (0x1C) // pressure and temperature oversampling
+#define REG_ODR             (0x1D) // output data rate, 200 Hz / 2^n
+#define REG_CONFIG          (0x1F) // IIR filter
+#define REG_CMD             (0x7E)
+#define BURST_LEN_BYTES     (REG_INT_STATUS - REG_DATA_BASE + 1U) // data through INT_STATUS
+
+#define ERR_MASK            (0x07) // fatal_err, cmd_err, conf_err
+#define STATUS_CMD_RDY      (0x10)
+#define INT_CTRL_LEVEL_HIGH (0x02) // push-pull, active high, not latched
+#define INT_CTRL_DRDY_EN    (0x40)
+#define PWR_CTRL_NORMAL     (0x33) // pressure and temperature enabled, normal mode
+#define CONFIG_IIR_COEF_3   (0x04)
+#define CMD_SOFT_RESET      (0xB6)
+
+#define ODR_BASE_HZ         (200U)
+#define ODR_BASE_PERIOD_US  (5000U)
+#define ODR_SEL_MAX         (17U)
+#define OSR_P_MAX           (3U)   // x8, the datasheet drone setting
+
+#define SPI_READ_FLAG       (0x80)
+#define SPI_DUMMY_BYTES     (1U)   // reads clock out one dummy byte after the address
+#define SPI_TIMEOUT_MS      (10U)
+#define RESET_TIMEOUT_MS    (10U)
+
+// Logger tag
+static const char TAG[] = "BARO";
+
+static SPI_HandleTypeDef* hspi;
+static bmp388_calib_t calib;
+
+// DMA transfer buffers, address and dummy byte followed by the data burst
+static DMA_BUFFER uint8_t dmaTxBuff[SPI_DUMMY_BYTES + 1U + BURST_LEN_BYTES];
+static DMA_BUFFER uint8_t dmaRxBuff[SPI_DUMMY_BYTES + 1U + BURST_LEN_BYTES];
+static volatile bool transferBusy;
+static uint64_t transferStartUs;
+
+static baro_sample_callback_t sampleCallback;
+
+// Latest sample, published from the ISR under a sequence lock (odd while writing)
+static baro_repo_t latestRepo;
+static volatile uint32_t latestLock;
+static uint32_t seqCounter;
+
+// Diagnostics
+static volatile uint32_t busErrorCount;
+static volatile uint32_t overrunCount;
+
+static inline void Baro_Select(void) {
+    HAL_GPIO_WritePin(BARO_CS_GPIO_Port, BARO_CS_Pin, GPIO_PIN_RESET);
+}
+
+static inline void Baro_Deselect(void) {
+    HAL_GPIO_WritePin(BARO_CS_GPIO_Port, BARO_CS_Pin, GPIO_PIN_SET);
+}
+
+// Blocking register access, only used during init before the kernel starts
+static bool Baro_WriteReg(uint8_t reg, uint8_t value) {
+    uint8_t buff[2] = {(uint8_t)(reg & ~SPI_READ_FLAG), value};
+    Baro_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, buff, 2, SPI_TIMEOUT_MS);
+    Baro_Deselect();
+    return status == HAL_OK;
+}
+
+static bool Baro_ReadReg(uint8_t reg, uint8_t* pBuff, uint16_t nBytes) {
+    uint8_t header[1 + SPI_DUMMY_BYTES] = {reg | SPI_READ_FLAG, 0};
+    Baro_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, header, sizeof(header), SPI_TIMEOUT_MS);
+    if (status == HAL_OK)
+        status = HAL_SPI_Receive(hspi, pBuff, nBytes, SPI_TIMEOUT_MS);
+    Baro_Deselect();
+    return status == HAL_OK;
+}
+
+// Soft reset, then poll for the command decoder instead of sleeping through the startup time
+static bool Baro_Reset(void) {
+    if (!Baro_WriteReg(REG_CMD, CMD_SOFT_RESET))
+        return false;
+
+    uint32_t start = HAL_GetTick();
+    uint8_t status = 0;
+    do {
+        // The reset drops the device back to I2C, any CSB edge selects SPI again
+        if (Baro_ReadReg(REG_STATUS, &status, 1) && (status & STATUS_CMD_RDY))
+            return true;
+    } while (HAL_GetTick() - start < RESET_TIMEOUT_MS);
+    return false;
+}
+
+// Slowest output data rate setting at or above the requested period, 200 Hz / 2^sel
+static uint8_t Baro_OdrSel(uint16_t rate) {
+    uint8_t sel = 0;
+    while (sel < ODR_SEL_MAX && (ODR_BASE_HZ >> sel) > rate)
+        sel++;
+    return sel;
+}
+
+// Highest pressure oversampling whose conversion fits in the period, datasheet 3.9.2
+static uint8_t Baro_OsrP(uint32_t periodUs) {
+    uint8_t osrP = OSR_P_MAX;
+    while (osrP > 0 && 234U + 392U + 2020U * (1U << osrP) + 163U + 2020U > periodUs)
+        osrP--;
+    return osrP;
+}
+
+static inline uint32_t Baro_U24(const uint8_t* raw) {
+    return (uint32_t)raw[0] | ((uint32_t)raw[1] << 8) | ((uint32_t)raw[2] << 16);
+}
+
+// Publishes a new sample to the latest repo, called from the transfer complete ISR
+static void Baro_Publish(const baro_sample_t* sample, uint32_t seq, uint64_t timestampUs) {
+    latestLock++;
+    __DMB();
+    latestRepo.data = *sample;
+    latestRepo.seq_n = seq;
+    latestRepo.timestamp_us = timestampUs;
+    __DMB();
+    latestLock++;
+
+    if (sampleCallback != NULL)
+        sampleCallback(&latestRepo);
+}
+
+static bool Baro_StartTransfer(void) {
+    transferBusy = true;
+
+    Baro_Select();
+    if (HAL_SPI_TransmitReceive_DMA(hspi, dmaTxBuff, dmaRxBuff, sizeof(dmaTxBuff)) != HAL_OK) {
+        Baro_Deselect();
+        transferBusy = false;
+        busErrorCount++;
+        return false;
+    }
+
+    return true;
+}
+
+bool Baro_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate) {
+    hspi = hardwareHandles.p_hspi1;
+    transferBusy = false;
+    sampleCallback = NULL;
+    latestLock = 0;
+    memset(&latestRepo, 0, sizeof(latestRepo));
+    seqCounter = 0;
+    busErrorCount = 0;
+    overrunCount = 0;
+
+    if (hspi == NULL || rate == 0) {
+        LOG_DIRECT(TAG, "Fatal: Invalid SPI handle or rate");
+        return false;
+    }
+
+    // The device powers up in I2C mode, the first CSB edge switches it to SPI
+    uint8_t chipId = 0;
+    Baro_Deselect();
+    Baro_ReadReg(REG_CHIP_ID, &chipId, 1);
+    if (!Baro_ReadReg(REG_CHIP_ID, &chipId, 1) || chipId != CHIP_ID_VALUE) {
+        LOG_DIRECT(TAG, "Fatal: CHIP_ID mismatch (0x%02X)", chipId);
+        return false;
+    }
+
+    if (!Baro_Reset()) {
+        LOG_DIRECT(TAG, "Fatal: Soft reset timed out");
+        return false;
+    }
+
+    uint8_t raw[BMP388_CALIB_LEN];
+    if (!Baro_ReadReg(BMP388_CALIB_REG, raw, BMP388_CALIB_LEN)) {
+        LOG_DIRECT(TAG, "Fatal: Error reading calibration");
+        return false;
+    }
+    Bmp388_ParseCalib(raw, &calib);
+
+    // Temperature at x1 is plenty for compensation, pressure gets what the period allows
+    uint8_t odrSel = Baro_OdrSel(rate);
+    uint8_t osrP = Baro_OsrP(ODR_BASE_PERIOD_US << odrSel);
+    bool ok = Baro_WriteReg(REG_OSR, osrP);
+    ok &= Baro_WriteReg(REG_ODR, odrSel);
+    ok &= Baro_WriteReg(REG_CONFIG, CONFIG_IIR_COEF_3);
+    ok &= Baro_WriteReg(REG_INT_CTRL, INT_CTRL_LEVEL_HIGH);
+    ok &= Baro_WriteReg(REG_PWR_CTRL, PWR_CTRL_NORMAL);
+
+    // Invalid OSR/ODR combinations are only reported in ERR_REG
+    uint8_t err = 0;
+    ok &= Baro_ReadReg(REG_ERR, &err, 1);
+    if (!ok || (err & ERR_MASK) != 0) {
+        LOG_DIRECT(TAG, "Fatal: Error writing configuration (ERR 0x%02X)", err);
+        return false;
+    }
+
+    // The header is constant, the rest of the TX buffer clocks out zeros
+    memset(dmaTxBuff, 0, sizeof(dmaTxBuff));
+    dmaTxBuff[0] = REG_DATA_BASE | SPI_READ_FLAG;
+
+    LOG_DIRECT(TAG, "BMP388 initialized, %u ms period, pressure x%u", (ODR_BASE_PERIOD_US / 1000U) << odrSel, 1U << osrP);
+    return true;
+}
+
+bool Baro_StartRead(void) {
+    if (transferBusy)
+        return false;
+
+    transferStartUs = Timebase_GetUs();
+    return Baro_StartTransfer();
+}
+
+void Baro_OnDataReady(uint64_t timestampUs) {
+    if (transferBusy) {
+        overrunCount++;
+        return;
+    }
+
+    transferStartUs = timestampUs;
+    Baro_StartTransfer();
+}
+
+bool Baro_SetDataReadyInterrupt(bool enable) {
+    if (transferBusy)
+        return false;
+
+    bool ok = Baro_WriteReg(REG_INT_CTRL, INT_CTRL_LEVEL_HIGH | (enable ? INT_CTRL_DRDY_EN : 0x00));
+
+    // A measurement that completed before INT was routed would hold the status, clear it
+    uint8_t intStatus;
+    ok &= Baro_ReadReg(REG_INT_STATUS, &intStatus, 1);
+
+    if (!ok)
+        LOG_DIRECT(TAG, "Error configuring data ready interrupt");
+    return ok;
+}
+
+bool Baro_GetRepo(baro_repo_t* repoBuff) {
+    uint32_t lock;
+    do {
+        lock = latestLock;
+        __DMB();
+        *repoBuff = latestRepo;
+        __DMB();
+    } while ((lock & 1U) || lock != latestLock);
+
+    return repoBuff->seq_n != 0;
+}
+
+void Baro_SetSampleCallback(baro_sample_callback_t callback) {
+    sampleCallback = callback;
+}
+
+void Baro_OnTransferComplete(void) {
+    Baro_Deselect();
+
+    const uint8_t* data = &dmaRxBuff[1 + SPI_DUMMY_BYTES];
+    baro_sample_t sample;
+    sample.temperature = Bmp388_CompensateTempF(&calib, Baro_U24(&data[3]));
+    sample.pressure = Bmp388_CompensatePressureF(&calib, Baro_U24(&data[0]), sample.temperature);
+    transferBusy = false;
+
+    Baro_Publish(&sample, ++seqCounter, transferStartUs);
+}
+
+void Baro_OnTransferError(void) {
+    Baro_Deselect();
+    busErrorCount++;
+    transferBusy = false;
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * Implements the GpsInterface for the u-blox NEO-8M over UART
+ *
+ * REV1 received one byte per interrupt into a 128 byte linear buffer and read lines with a
+ * blocking loop, so every byte cost an interrupt and bytes arriving while a sentence was parsed
+ * were lost. Here the receive DMA runs in circular mode for good. The UART idle line interrupt
+ * marks the end of each burst the module sends, and together with the half and full buffer
+ * events from the stream that is the only interrupt load, whatever the baud rate. The events
+ * wake GpsTask, which takes everything up to the DMA counter out of the ring and parses it
+ * while the stream keeps receiving.
+ *
+ * Line errors are left to the NMEA checksum. The UART error interrupt is turned off after the
+ * DMA starts, since the HAL would abort the circular transfer on a framing or noise error and a
+ * stopped receiver loses far more than the one sentence the checksum rejects.
+ */
+#include "stm32f4xx_hal.h"
+
+#include "GpsInterface.h"
+#include "Nmea.h"
+#include "DmaRxRing.h"
+#include "Logger.h"
+#include "MemSections.h"
+
+#include "cmsis_os2.h"
+
+#define GPS_RX_BUFF_SIZE   2048U // power of 2, how far the task may fall behind, 44 ms at 460800 baud
+#define GPS_CHUNK_BYTES    128U  // copied out of the ring per pass
+#define GPS_RX_TIMEOUT_MS  1500U // the module sends every second, silence checks the receiver
+#define GPS_FLAG_RX        0x0001U
+
+// Logger tag
+static const char TAG[] = "GPS";
+
+static UART_HandleTypeDef* huart;
+
+static DMA_BUFFER uint8_t rxBuff[GPS_RX_BUFF_SIZE];
+static dma_rx_ring_t rxRing;
+static nmea_parser_t parser;
+
+static osThreadId_t volatile gpsThread;
+static volatile uint64_t lastEventUs;
+
+// Latest fix, published from GpsTask under a sequence lock (odd while writing)
+static gps_repo_t latestRepo;
+static volatile uint32_t latestLock;
+static uint32_t seqCounter;
+
+// Counters
+static gps_stats_t stats;
+
+static void Gps_Publish(const gps_fix_t* fix, uint64_t timestampUs) {
+    latestLock++;
+    __DMB();
+    latestRepo.data = *fix;
+    latestRepo.seq_n = ++seqCounter;
+    latestRepo.timestamp_us = timestampUs;
+    __DMB();
+    latestLock++;
+}
+
+// Stream position from the DMA counter, which counts down from the buffer size and reloads at the wrap
+static uint32_t Gps_DmaPosition(void) {
+    return GPS_RX_BUFF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
+}
+
+bool Gps_Init(SystemHardwareHandles_t hardwareHandles) {
+    huart = hardwareHandles.p_huart2;
+    gpsThread = NULL;
+    lastEventUs = 0;
+    latestLock = 0;
+    seqCounter = 0;
+    stats = (gps_stats_t){0};
+    Nmea_Init(&parser);
+
+    if (huart == NULL || huart->hdmarx == NULL) {
+        LOG_DIRECT(TAG, "Fatal: Invalid UART handle or no receive DMA");
+        return false;
+    }
+
+    LOG_DIRECT(TAG, "NEO-8M receiver initialized, %u baud", huart->Init.BaudRate);
+    return true;
+}
+
+bool Gps_Start(void) {
+    // The stream starts over at the beginning of the buffer
+    DmaRxRing_Init(&rxRing, rxBuff, GPS_RX_BUFF_SIZE, Gps_DmaPosition);
+    Nmea_Reset(&parser);
+    if (HAL_UARTEx_ReceiveToIdle_DMA(huart, rxBuff, GPS_RX_BUFF_SIZE) != HAL_OK) {
+        LOG_WARN(TAG, "Error starting receive DMA");
+        return false;
+    }
+    __HAL_UART_DISABLE_IT(huart, UART_IT_ERR);
+    return true;
+}
+
+bool Gps_GetRepo(gps_repo_t* repoBuff) {
+    uint32_t lock;
+    do {
+        lock = latestLock;
+        __DMB();
+        *repoBuff = latestRepo;
+        __DMB();
+    } while ((lock & 1U) || lock != latestLock);
+
+    return repoBuff->seq_n != 0;
+}
+
+void Gps_GetStats(gps_stats_t* statsBuff) {
+    *statsBuff = stats;
+    statsBuff->rxEvents = rxRing.events;
+    statsBuff->sentences = parser.sentences;
+    statsBuff->checksumErrors = parser.checksumErrors;
+    statsBuff->dropped = rxRing.dropped;
+}
+
+RAMFUNC void Gps_OnRxEvent(uint16_t pos, uint64_t timestampUs) {
+    DmaRxRing_OnEvent(&rxRing, pos);
+    lastEventUs = timestampUs;
+
+    osThreadId_t thread = gpsThread;
+    if (thread != NULL)
+        osThreadFlagsSet(thread, GPS_FLAG_RX);
+}
+
+// Empties the ring, a gap in the stream cuts the sentence it fell into
+static void Gps_Drain(void) {
+    uint64_t timestampUs;
+    do {
+        timestampUs = lastEventUs;
+    } while (timestampUs != lastEventUs);
+
+    uint8_t chunk[GPS_CHUNK_BYTES];
+    uint32_t dropped = rxRing.dropped;
+    for (;;) {
+        uint32_t len = DmaRxRing_Read(&rxRing, chunk, sizeof(chunk));
+        if (rxRing.dropped != dropped) {
+            dropped = rxRing.dropped;
+            Nmea_Reset(&parser);
+        }
+        if (len == 0)
+            return;
+
+        stats.rxBytes += len;
+        for (uint32_t i = 0; i < len; i++) {
+            gps_fix_t fix;
+            if (Nmea_Push(&parser, chunk[i]) && Nmea_ParseGga(parser.line, &fix))
+                Gps_Publish(&fix, timestampUs);
+        }
+    }
+}
+
+void GpsTask(void *argument) {
+    (void)argument;
+    gpsThread = osThreadGetId();
+
+    uint32_t timeoutTicks = GPS_RX_TIMEOUT_MS * osKernelGetTickFreq() / 1000U;
+
+    LOG(TAG, "Started GPS receiver");
+
+    for (;;) {
+        if ((int32_t)osThreadFlagsWait(GPS_FLAG_RX, osFlagsWaitAny, timeoutTicks) >= 0) {
+            Gps_Drain();
+            continue;
+        }
+
+        // A DMA transfer error stops the stream, the HAL leaves the receiver ready again
+        if (huart->RxState == HAL_UART_STATE_READY) {
+            stats.restarts++;
+            LOG_WARN(TAG, "Receiver stopped, restarting");
+            Gps_Start();
+        }
+    }
+}
\ No newline at end of file
@@ -4,25 +4,450 @@
 #include "stm32f4xx_hal.h"
 
 #include "IMUInterface.h"
+#include "ImuConvert.h"
+#include "ImuRing.h"
+#include "Logger.h"
+#include "MemSections.h"
+#include "Timebase.h"
+
+#include <string.h>
 
 #define WHO_AM_I_VALUE      (0x70)
+#define REG_SMPLRT_DIV      (0x19) // sample rate divider, only used with DLPF_CFG 1-6
 #define REG_WHO_AM_I        (0x75)
 #define REG_CONFIG          (0x1A) // FIFO mode, DLPF config
 #define REG_GYRO_CONFIG     (0x1B) // full scale select, DLPF
 #define REG_ACCEL_CONFIG    (0x1C) // full scale select
 #define REG_ACCEL_CONFIG2   (0x1D) // DLPF
+#define REG_FIFO_EN         (0x23) // sensors written to the FIFO
+#define REG_INT_PIN_CFG     (0x37) // INT pin level, latch and clear mode
+#define REG_INT_ENABLE      (0x38) // interrupt sources
 #define REG_DATA_BASE       (0x3B) // start of data reg
+#define REG_USER_CTRL       (0x6A) // FIFO enable/reset, I2C interface disable
+#define REG_PWR_MGMT_1      (0x6B) // device reset, clock select
+#define REG_FIFO_COUNT_H    (0x72) // FIFO_COUNT_H, FIFO_COUNT_L
+#define REG_FIFO_R_W        (0x74) // FIFO data port
 #define DATA_LEN_BYTES      (14U)  // 14 bytes 16bit MSB, 6 accel + 2 temp + 6 gyro
 
+#define USER_CTRL_FIFO_EN   (0x40)
+#define USER_CTRL_I2C_DIS   (0x10)
+#define USER_CTRL_FIFO_RST  (0x04)
+#define FIFO_EN_ACCEL_GYRO  (0x78) // XG, YG, ZG, ACCEL
+#define INT_PIN_ANYRD_CLEAR (0x10) // active high push-pull 50us pulse, cleared by any read
+#define INT_EN_RAW_RDY      (0x01)
+
+#define FIFO_SIZE_BYTES     (512U)
+#define FIFO_FRAME_BYTES    (IMU_FRAME_BYTES)
+#define FIFO_MAX_BYTES      (IMU_BATCH_MAX_SAMPLES * FIFO_FRAME_BYTES)
+
+#define SPI_READ_FLAG       (0x80)
+#define SPI_TIMEOUT_MS      (10U)
+
+// Chip select, SPI2 NSS is driven in software
+#define IMU_CS_PORT         GPIOB
+#define IMU_CS_PIN          GPIO_PIN_12
+
+// Scale factors for +-8g and +-2000dps full scale
+#define ACCEL_SCALE         (8.0f * 9.80665f / 32768.0f)            // LSB -> m/s^2
+#define GYRO_SCALE          (2000.0f / 32768.0f * 3.14159265f / 180.0f) // LSB -> rad/s
+
+// Logger tag
+static const char TAG[] = "IMU";
+
 static SPI_HandleTypeDef* hspi;
 static uint16_t imuRate;
 
+// Transfer in flight, the completion ISR dispatches on this
+typedef enum {
+    IMU_XFER_IDLE,
+    IMU_XFER_SAMPLE,
+    IMU_XFER_FIFO_COUNT,
+    IMU_XFER_FIFO_DATA,
+    IMU_XFER_FIFO_RESET
+} imu_xfer_t;
+
+// DMA transfer buffers, address byte followed by the data burst
+static DMA_BUFFER uint8_t dmaTxBuff[FIFO_MAX_BYTES + 1];
+static DMA_BUFFER uint8_t dmaRxBuff[FIFO_MAX_BYTES + 1];
+static volatile imu_xfer_t transferState;
+static uint64_t transferStartUs;
+
+// FIFO batch mode
+static bool fifoEnabled;
+static bool fifoOverflowed;
+static uint32_t samplePeriodUs;
+static imu_batch_t fifoBatch;
+static imu_batch_callback_t batchCallback;
+static imu_sample_callback_t sampleCallback;
+
+// Raw to SI conversion, scale and mounting fixed at init
+static CCM_BSS imu_convert_t convert;
+
+// Latest sample, published from the ISR under a sequence lock (odd while writing)
+static imu_repo_t latestRepo;
+static volatile uint32_t latestLock;
+static uint32_t seqCounter;
+
+// Diagnostics
+static volatile uint32_t busErrorCount;
+static volatile uint32_t fifoOverflowCount;
+
+static inline void Imu_Select(void) {
+    HAL_GPIO_WritePin(IMU_CS_PORT, IMU_CS_PIN, GPIO_PIN_RESET);
+}
+
+static inline void Imu_Deselect(void) {
+    HAL_GPIO_WritePin(IMU_CS_PORT, IMU_CS_PIN, GPIO_PIN_SET);
+}
+
+// Blocking register access, only used during init before the kernel starts
+static bool Imu_WriteReg(uint8_t reg, uint8_t value) {
+    uint8_t buff[2] = {reg, value};
+    Imu_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, buff, 2, SPI_TIMEOUT_MS);
+    Imu_Deselect();
+    return status == HAL_OK;
+}
+
+static bool Imu_ReadReg(uint8_t reg, uint8_t* pBuff, uint16_t nBytes) {
+    uint8_t addr = reg | SPI_READ_FLAG;
+    Imu_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, &addr, 1, SPI_TIMEOUT_MS);
+    if (status == HAL_OK)
+        status = HAL_SPI_Receive(hspi, pBuff, nBytes, SPI_TIMEOUT_MS);
+    Imu_Deselect();
+    return status == HAL_OK;
+}
+
+static bool Imu_SetSpiPrescaler(uint32_t prescaler) {
+    hspi->Init.BaudRatePrescaler = prescaler;
+    return HAL_SPI_Init(hspi) == HAL_OK;
+}
+
+// Publishes a new sample to the latest repo and the sample ring, called from the transfer complete ISR
+static RAMFUNC void Imu_Publish(const imu_sample_t* sample, uint32_t seq, uint64_t timestampUs) {
+    latestLock++;
+    __DMB();
+    latestRepo.data = *sample;
+    latestRepo.seq_n = seq;
+    latestRepo.timestamp_us = timestampUs;
+    __DMB();
+    latestLock++;
+
+    ImuRing_Publish(&latestRepo);
+
+    if (sampleCallback != NULL)
+        sampleCallback(&latestRepo);
+}
+
+// Starts a full duplex DMA transfer of len bytes, TX buffer must already be filled
+static RAMFUNC bool Imu_StartTransfer(imu_xfer_t xfer, uint16_t len) {
+    transferState = xfer;
+
+    Imu_Select();
+    if (HAL_SPI_TransmitReceive_DMA(hspi, dmaTxBuff, dmaRxBuff, len) != HAL_OK) {
+        Imu_Deselect();
+        transferState = IMU_XFER_IDLE;
+        busErrorCount++;
+        return false;
+    }
+
+    return true;
+}
+
+// Back to the data clock with a zero TX buffer after the FIFO reset write, however it ended
+static void Imu_EndFifoReset(void) {
+    dmaTxBuff[1] = 0;
+    if (!Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_4))
+        busErrorCount++;
+}
+
+// Clears the FIFO and marks the next batch as following a data loss. USER_CTRL is a
+// configuration register, so the write goes out at the 1MHz configuration clock.
+static bool Imu_StartFifoReset(void) {
+    fifoOverflowed = true;
+    fifoOverflowCount++;
+
+    dmaTxBuff[0] = REG_USER_CTRL;
+    dmaTxBuff[1] = USER_CTRL_FIFO_EN | USER_CTRL_I2C_DIS | USER_CTRL_FIFO_RST;
+    if (!Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_64) || !Imu_StartTransfer(IMU_XFER_FIFO_RESET, 2)) {
+        transferState = IMU_XFER_IDLE;
+        Imu_EndFifoReset();
+        return false;
+    }
+    return true;
+}
+
+// FIFO_COUNT arrived: drain every complete frame, or reset if the FIFO has wrapped
+static void Imu_HandleFifoCount(void) {
+    uint16_t count = ((uint16_t)dmaRxBuff[1] << 8) | dmaRxBuff[2];
+
+    // In overwrite mode a full FIFO drops the oldest bytes, the frame boundary is lost
+    if (count > FIFO_SIZE_BYTES - FIFO_FRAME_BYTES || count % FIFO_FRAME_BYTES != 0) {
+        Imu_StartFifoReset();
+        return;
+    }
+
+    uint16_t frames = count / FIFO_FRAME_BYTES;
+    if (frames == 0) {
+        transferState = IMU_XFER_IDLE;
+        return;
+    }
+    if (frames > IMU_BATCH_MAX_SAMPLES)
+        frames = IMU_BATCH_MAX_SAMPLES;
+
+    // Reading the data port repeatedly pops the FIFO, the rest of the TX buffer stays zero
+    dmaTxBuff[0] = REG_FIFO_R_W | SPI_READ_FLAG;
+    dmaTxBuff[1] = 0;
+    Imu_StartTransfer(IMU_XFER_FIFO_DATA, frames * FIFO_FRAME_BYTES + 1);
+}
+
+// FIFO frames arrived: convert, timestamp and hand off the batch
+static void Imu_HandleFifoData(uint16_t len) {
+    uint16_t frames = (len - 1) / FIFO_FRAME_BYTES;
+    ImuConvert_Batch(&convert, &dmaRxBuff[1], frames, &fifoBatch);
+
+    // The newest frame was sampled at most one period before FIFO_COUNT was read
+    fifoBatch.count = frames;
+    fifoBatch.sample_period_us = samplePeriodUs;
+    fifoBatch.first_timestamp_us = transferStartUs - (uint64_t)(frames - 1) * samplePeriodUs;
+    fifoBatch.first_seq_n = seqCounter + 1;
+    fifoBatch.overflowed = fifoOverflowed;
+    fifoOverflowed = false;
+
+    for (uint16_t i = 0; i < frames; i++) {
+        uint64_t timestampUs = fifoBatch.first_timestamp_us + (uint64_t)i * samplePeriodUs;
+        imu_sample_t sample = { fifoBatch.ax[i], fifoBatch.ay[i], fifoBatch.az[i],
+                                fifoBatch.gx[i], fifoBatch.gy[i], fifoBatch.gz[i] };
+        Imu_Publish(&sample, ++seqCounter, timestampUs);
+    }
+
+    transferState = IMU_XFER_IDLE;
+
+    if (batchCallback != NULL)
+        batchCallback(&fifoBatch);
+}
+
 bool Imu_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate)
 {
     hspi = hardwareHandles.p_hspi2;
     imuRate = rate;
+    samplePeriodUs = 0;
+    transferState = IMU_XFER_IDLE;
+    fifoEnabled = false;
+    fifoOverflowed = false;
+    batchCallback = NULL;
+    sampleCallback = NULL;
+    fifoOverflowCount = 0;
+    latestLock = 0;
+    memset(&latestRepo, 0, sizeof(latestRepo));
+    seqCounter = 0;
+    ImuRing_Init();
+    busErrorCount = 0;
+    ImuConvert_Init(&convert, ACCEL_SCALE, GYRO_SCALE, NULL); // sensor axes are the body axes
+
+    if (hspi == NULL || rate == 0) {
+        LOG_DIRECT(TAG, "Fatal: Invalid SPI handle or rate");
+        return false;
+    }
+
+    // The sample clock is 8kHz unfiltered or 1kHz divided by SMPLRT_DIV + 1, any other rate
+    // would silently run at one the rest of the pipeline does not expect
+    if (rate != 8000U && (rate > 1000U || 1000U % rate != 0U || 1000U / rate > 256U)) {
+        LOG_DIRECT(TAG, "Fatal: Unsupported rate %u Hz, use 8000 or a divisor of 1000 from 4", rate);
+        return false;
+    }
+
+    // Configuration registers are limited to 1MHz SPI clock
+    Imu_Deselect();
+    if (!Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_64)) {
+        LOG_DIRECT(TAG, "Fatal: Error configuring SPI clock");
+        return false;
+    }
 
     // Verify imu connection
+    uint8_t whoami = 0;
+    if (!Imu_ReadReg(REG_WHO_AM_I, &whoami, 1) || whoami != WHO_AM_I_VALUE) {
+        LOG_DIRECT(TAG, "Fatal: WHO_AM_I mismatch (0x%02X)", whoami);
+        return false;
+    }
+
+    // Reset and select the PLL clock source, then lock the device to SPI
+    bool ok = Imu_WriteReg(REG_PWR_MGMT_1, 0x80);
+    HAL_Delay(100);
+    ok &= Imu_WriteReg(REG_PWR_MGMT_1, 0x01);
+    ok &= Imu_WriteReg(REG_USER_CTRL, USER_CTRL_I2C_DIS);
+
+    // 8kHz runs the gyro unfiltered, otherwise 1kHz with 184Hz DLPF divided down
+    if (rate == 8000U) {
+        ok &= Imu_WriteReg(REG_CONFIG, 0x07);
+        ok &= Imu_WriteReg(REG_SMPLRT_DIV, 0x00);
+        samplePeriodUs = 125U;
+    } else {
+        uint8_t div = (uint8_t)(1000U / rate - 1U);
+        ok &= Imu_WriteReg(REG_CONFIG, 0x01);
+        ok &= Imu_WriteReg(REG_SMPLRT_DIV, div);
+        samplePeriodUs = 1000U * (div + 1U);
+    }
+    ok &= Imu_WriteReg(REG_GYRO_CONFIG, 0x18);   // 2000 dps
+    ok &= Imu_WriteReg(REG_ACCEL_CONFIG, 0x10);  // 8g
+    ok &= Imu_WriteReg(REG_ACCEL_CONFIG2, 0x01); // 184Hz accel DLPF
+    if (!ok) {
+        LOG_DIRECT(TAG, "Fatal: Error writing configuration");
+        return false;
+    }
+
+    // Sensor data registers can be read at up to 20MHz, APB1 42MHz / 4 = 10.5MHz
+    if (!Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_4)) {
+        LOG_DIRECT(TAG, "Fatal: Error configuring SPI clock");
+        return false;
+    }
+
+    // The address byte is constant, the rest of the TX buffer clocks out zeros
+    memset(dmaTxBuff, 0, sizeof(dmaTxBuff));
+    dmaTxBuff[0] = REG_DATA_BASE | SPI_READ_FLAG;
+
+    LOG_DIRECT(TAG, "MPU6500 initialized at %u Hz", imuRate);
+    return true;
+}
+
+uint32_t Imu_GetSamplePeriodUs(void) {
+    return samplePeriodUs;
+}
+
+bool Imu_SetCalibration(const imu_cal_t* cal, const float rotation[9]) {
+    if (transferState != IMU_XFER_IDLE)
+        return false;
+
+    ImuConvert_Init(&convert, ACCEL_SCALE, GYRO_SCALE, rotation);
+    if (cal != NULL) {
+        ImuConvert_SetAccelGain(&convert, cal->accelGain);
+        ImuConvert_SetBias(&convert, cal->accelBias, cal->gyroBias);
+    }
+    return true;
+}
+
+RAMFUNC bool Imu_StartRead(void) {
+    if (transferState != IMU_XFER_IDLE)
+        return false;
+
+    transferStartUs = Timebase_GetUs();
+    dmaTxBuff[0] = REG_DATA_BASE | SPI_READ_FLAG;
+    return Imu_StartTransfer(IMU_XFER_SAMPLE, DATA_LEN_BYTES + 1);
+}
+
+bool Imu_SetFifoMode(bool enable) {
+    if (transferState != IMU_XFER_IDLE)
+        return false;
+
+    // Configuration registers are limited to 1MHz SPI clock
+    bool ok = Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_64);
+    if (enable) {
+        ok &= Imu_WriteReg(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO);
+        ok &= Imu_WriteReg(REG_USER_CTRL, USER_CTRL_FIFO_EN | USER_CTRL_I2C_DIS | USER_CTRL_FIFO_RST);
+    } else {
+        ok &= Imu_WriteReg(REG_FIFO_EN, 0x00);
+        ok &= Imu_WriteReg(REG_USER_CTRL, USER_CTRL_I2C_DIS | USER_CTRL_FIFO_RST);
+    }
+    ok &= Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_4);
+
+    // The data burst buffer is shared, clear stale register writes
+    memset(dmaTxBuff, 0, sizeof(dmaTxBuff));
+
+    fifoEnabled = enable && ok;
+    fifoOverflowed = false;
+    if (!ok)
+        LOG_DIRECT(TAG, "Error configuring FIFO");
+    return ok;
 }
 
-void Imu_GetSample(imu_sample_t* imuBuff);
\ No newline at end of file
+bool Imu_SetDataReadyInterrupt(bool enable) {
+    if (transferState != IMU_XFER_IDLE)
+        return false;
+
+    // Configuration registers are limited to 1MHz SPI clock
+    bool ok = Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_64);
+    ok &= Imu_WriteReg(REG_INT_PIN_CFG, INT_PIN_ANYRD_CLEAR);
+    ok &= Imu_WriteReg(REG_INT_ENABLE, enable ? INT_EN_RAW_RDY : 0x00);
+    ok &= Imu_SetSpiPrescaler(SPI_BAUDRATEPRESCALER_4);
+
+    // The data burst buffer is shared, clear stale register writes
+    memset(dmaTxBuff, 0, sizeof(dmaTxBuff));
+
+    if (!ok)
+        LOG_DIRECT(TAG, "Error configuring data ready interrupt");
+    return ok;
+}
+
+void Imu_SetSampleCallback(imu_sample_callback_t callback) {
+    sampleCallback = callback;
+}
+
+void Imu_SetBatchCallback(imu_batch_callback_t callback) {
+    batchCallback = callback;
+}
+
+bool Imu_StartFifoDrain(void) {
+    if (!fifoEnabled || transferState != IMU_XFER_IDLE)
+        return false;
+
+    transferStartUs = Timebase_GetUs();
+    dmaTxBuff[0] = REG_FIFO_COUNT_H | SPI_READ_FLAG;
+    dmaTxBuff[1] = 0;
+    return Imu_StartTransfer(IMU_XFER_FIFO_COUNT, 3);
+}
+
+void Imu_GetSample(imu_sample_t* imuBuff) {
+    imu_repo_t repo;
+    Imu_GetRepo(&repo);
+    *imuBuff = repo.data;
+}
+
+bool Imu_GetRepo(imu_repo_t* repoBuff) {
+    uint32_t lock;
+    do {
+        lock = latestLock;
+        __DMB();
+        *repoBuff = latestRepo;
+        __DMB();
+    } while ((lock & 1U) || lock != latestLock);
+
+    return repoBuff->seq_n != 0;
+}
+
+RAMFUNC void Imu_OnTransferComplete(void) {
+    Imu_Deselect();
+
+    switch (transferState) {
+    case IMU_XFER_SAMPLE: {
+        // raw[6..7] is die temperature, unused
+        imu_sample_t sample;
+        ImuConvert_Sample(&convert, &dmaRxBuff[1], &dmaRxBuff[9], &sample);
+        Imu_Publish(&sample, ++seqCounter, transferStartUs);
+        transferState = IMU_XFER_IDLE;
+        break;
+    }
+    case IMU_XFER_FIFO_COUNT:
+        Imu_HandleFifoCount();
+        break;
+    case IMU_XFER_FIFO_DATA:
+        Imu_HandleFifoData(hspi->RxXferSize);
+        break;
+    case IMU_XFER_FIFO_RESET:
+        Imu_EndFifoReset();
+        transferState = IMU_XFER_IDLE;
+        break;
+    default:
+        transferState = IMU_XFER_IDLE;
+        break;
+    }
+}
+
+void Imu_OnTransferError(void) {
+    Imu_Deselect();
+    busErrorCount++;
+
+    if (transferState == IMU_XFER_FIFO_RESET)
+        Imu_EndFifoReset();
+    transferState = IMU_XFER_IDLE;
+}
@@ -0,0 +1,141 @@
+/**
+ * Raw to SI conversion of MPU6500 sample frames
+ *
+ * Axes arrive as big endian int16. With the Cortex-M4 DSP extension two axes go through each
+ * step at once: one REV16 swaps the bytes of both halfwords and one QSUB16 removes both
+ * offsets with saturation. The FPU then applies scale and mount rotation as one 3x3 matrix per
+ * sensor. The portable path does the same integer work one axis at a time, so both paths give
+ * bit identical results and the host build exercises the same arithmetic.
+ */
+
+#include "ImuConvert.h"
+#include "MemSections.h"
+
+#include "stm32f4xx_hal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define IMU_CONVERT_SIMD 1
+#else
+#define IMU_CONVERT_SIMD 0
+#endif
+
+static const float identity[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+void ImuConvert_Init(imu_convert_t* conv, float accelScale, float gyroScale, const float rotation[9]) {
+    if (rotation == NULL)
+        rotation = identity;
+
+    for (uint32_t i = 0; i < 9; i++) {
+        conv->accelMat[i] = rotation[i] * accelScale;
+        conv->gyroMat[i] = rotation[i] * gyroScale;
+    }
+    ImuConvert_SetBias(conv, NULL, NULL);
+}
+
+void ImuConvert_SetBias(imu_convert_t* conv, const int16_t accelBias[3], const int16_t gyroBias[3]) {
+    for (uint32_t i = 0; i < 3; i++) {
+        conv->accelBias[i] = (accelBias != NULL) ? accelBias[i] : 0;
+        conv->gyroBias[i] = (gyroBias != NULL) ? gyroBias[i] : 0;
+    }
+
+    conv->biasPacked[0] = (uint16_t)conv->accelBias[0] | ((uint32_t)(uint16_t)conv->accelBias[1] << 16);
+    conv->biasPacked[1] = (uint16_t)conv->gyroBias[0] | ((uint32_t)(uint16_t)conv->gyroBias[1] << 16);
+    conv->biasPacked[2] = (uint16_t)conv->accelBias[2] | ((uint32_t)(uint16_t)conv->gyroBias[2] << 16);
+}
+
+void ImuConvert_SetAccelGain(imu_convert_t* conv, const float gain[3]) {
+    // Column c of the matrix multiplies sensor axis c
+    for (uint32_t r = 0; r < 3; r++) {
+        for (uint32_t c = 0; c < 3; c++)
+            conv->accelMat[r * 3 + c] *= gain[c];
+    }
+}
+
+#if IMU_CONVERT_SIMD
+// Unaligned loads, frames sit behind the SPI address byte
+static inline uint32_t ImuConvert_Load32(const uint8_t* p) {
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+static inline uint32_t ImuConvert_Load16(const uint8_t* p) {
+    uint16_t half;
+    memcpy(&half, p, sizeof(half));
+    return half;
+}
+#else
+// Big endian axis minus its offset, saturated like QSUB16
+static inline int32_t ImuConvert_Axis(const uint8_t* p, int16_t bias) {
+    int32_t value = (int16_t)(((uint16_t)p[0] << 8) | p[1]) - bias;
+    if (value > INT16_MAX)
+        return INT16_MAX;
+    if (value < INT16_MIN)
+        return INT16_MIN;
+    return value;
+}
+#endif
+
+// Byte swapped, offset corrected axes in the order ax ay az gx gy gz
+static inline __attribute__((always_inline)) void ImuConvert_Raw(const imu_convert_t* conv, const uint8_t* accel,
+                                                                 const uint8_t* gyro, int32_t raw[6]) {
+#if IMU_CONVERT_SIMD
+    uint32_t axy = __QSUB16(__REV16(ImuConvert_Load32(accel)), conv->biasPacked[0]);
+    uint32_t gxy = __QSUB16(__REV16(ImuConvert_Load32(gyro)), conv->biasPacked[1]);
+    uint32_t z = __QSUB16(__REV16(ImuConvert_Load16(accel + 4) | (ImuConvert_Load16(gyro + 4) << 16)),
+                          conv->biasPacked[2]);
+
+    raw[0] = (int16_t)axy;
+    raw[1] = (int16_t)(axy >> 16);
+    raw[2] = (int16_t)z;
+    raw[3] = (int16_t)gxy;
+    raw[4] = (int16_t)(gxy >> 16);
+    raw[5] = (int16_t)(z >> 16);
+#else
+    for (uint32_t i = 0; i < 3; i++) {
+        raw[i] = ImuConvert_Axis(&accel[2 * i], conv->accelBias[i]);
+        raw[3 + i] = ImuConvert_Axis(&gyro[2 * i], conv->gyroBias[i]);
+    }
+#endif
+}
+
+// Applies one scale and rotation matrix to a raw vector
+static inline __attribute__((always_inline)) void ImuConvert_Apply(const float m[9], const int32_t v[3],
+                                                                   float* x, float* y, float* z) {
+    float fx = (float)v[0];
+    float fy = (float)v[1];
+    float fz = (float)v[2];
+    *x = m[0] * fx + m[1] * fy + m[2] * fz;
+    *y = m[3] * fx + m[4] * fy + m[5] * fz;
+    *z = m[6] * fx + m[7] * fy + m[8] * fz;
+}
+
+RAMFUNC void ImuConvert_Sample(const imu_convert_t* conv, const uint8_t* accel, const uint8_t* gyro, imu_sample_t* sample) {
+    int32_t raw[6];
+    ImuConvert_Raw(conv, accel, gyro, raw);
+    ImuConvert_Apply(conv->accelMat, &raw[0], &sample->ax, &sample->ay, &sample->az);
+    ImuConvert_Apply(conv->gyroMat, &raw[3], &sample->gx, &sample->gy, &sample->gz);
+}
+
+RAMFUNC void ImuConvert_Samples(const imu_convert_t* conv, const uint8_t* frames, uint16_t count, imu_sample_t* samples) {
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t* frame = &frames[i * IMU_FRAME_BYTES];
+        int32_t raw[6];
+        ImuConvert_Raw(conv, frame, frame + 6, raw);
+        ImuConvert_Apply(conv->accelMat, &raw[0], &samples[i].ax, &samples[i].ay, &samples[i].az);
+        ImuConvert_Apply(conv->gyroMat, &raw[3], &samples[i].gx, &samples[i].gy, &samples[i].gz);
+    }
+}
+
+RAMFUNC void ImuConvert_Batch(const imu_convert_t* conv, const uint8_t* frames, uint16_t count, imu_batch_t* batch) {
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t* frame = &frames[i * IMU_FRAME_BYTES];
+        int32_t raw[6];
+        ImuConvert_Raw(conv, frame, frame + 6, raw);
+        ImuConvert_Apply(conv->accelMat, &raw[0], &batch->ax[i], &batch->ay[i], &batch->az[i]);
+        ImuConvert_Apply(conv->gyroMat, &raw[3], &batch->gx[i], &batch->gy[i], &batch->gz[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/**
+ * Lock-free single producer / multi consumer ring of IMU samples
+ *
+ * Each slot is guarded by its own sequence lock: the producer makes the lock odd while
+ * writing and even when done, readers retry a copy that overlapped a write. Readers never
+ * write shared state, so any number of tasks can consume without slowing the ISR.
+ */
+
+#include "ImuRing.h"
+#include "MemSections.h"
+
+#include "stm32f4xx_hal.h"
+
+#define IMU_RING_MASK (IMU_RING_SIZE - 1U)
+
+typedef struct {
+    volatile uint32_t lock;
+    uint32_t position;
+    imu_repo_t repo;
+} imu_ring_slot_t;
+
+static CCM_BSS imu_ring_slot_t slots[IMU_RING_SIZE];
+static volatile uint32_t head; // ring position of the next write
+
+void ImuRing_Init(void) {
+    for (uint32_t i = 0; i < IMU_RING_SIZE; i++) {
+        slots[i].lock = 0;
+        slots[i].position = 0;
+    }
+    head = 0;
+}
+
+RAMFUNC void ImuRing_Publish(const imu_repo_t* repo) {
+    uint32_t pos = head;
+    imu_ring_slot_t* slot = &slots[pos & IMU_RING_MASK];
+
+    slot->lock++;
+    __DMB();
+    slot->repo = *repo;
+    slot->position = pos;
+    __DMB();
+    slot->lock++;
+    __DMB();
+    head = pos + 1U;
+}
+
+void ImuRing_ReaderInit(imu_ring_reader_t* reader) {
+    uint32_t newest = head;
+    reader->cursor = newest;
+    // Gaps count from the newest sample, seq_n starts at 1 so an empty ring counts from 0
+    reader->last_seq_n = (newest != 0U) ? slots[(newest - 1U) & IMU_RING_MASK].repo.seq_n : 0U;
+    reader->missed = 0;
+}
+
+bool ImuRing_Read(imu_ring_reader_t* reader, imu_repo_t* repoBuff) {
+    for (;;) {
+        uint32_t newest = head;
+        if (reader->cursor == newest)
+            return false;
+
+        // Lapped: the oldest slot may be mid-write, start one past it
+        if (newest - reader->cursor >= IMU_RING_SIZE)
+            reader->cursor = newest - IMU_RING_SIZE + 1U;
+
+        const imu_ring_slot_t* slot = &slots[reader->cursor & IMU_RING_MASK];
+        uint32_t lock = slot->lock;
+        if (lock & 1U)
+            continue;
+        __DMB();
+        *repoBuff = slot->repo;
+        uint32_t position = slot->position;
+        __DMB();
+        if (lock != slot->lock || position != reader->cursor)
+            continue; // overwritten while copying, re-check for a lap
+
+        reader->cursor++;
+
+        // Gaps cover both ring overruns and samples the driver itself lost
+        if (repoBuff->seq_n - reader->last_seq_n > 1U)
+            reader->missed += repoBuff->seq_n - reader->last_seq_n - 1U;
+        reader->last_seq_n = repoBuff->seq_n;
+
+        return true;
+    }
+}
@@ -0,0 +1,320 @@
+/**
+ * Implements the MagInterface for the LIS2MDL over 3-wire SPI
+ *
+ * The device free runs in continuous mode and holds DRDY high until the output registers are
+ * read. SDO shares its pin with DRDY, so the bus runs half duplex: the DRDY edge sends the
+ * address byte under interrupt, its completion turns the line around for a DMA receive of
+ * STATUS and the outputs, and the receive completion publishes the sample. Nothing waits on
+ * the bus after init.
+ *
+ * Only the rising edge of DRDY interrupts, so a sample left unread holds the line high with no
+ * further edge. That happens when a measurement lands while a burst is in flight or when a burst
+ * fails, so the end of every transfer samples the pin and reads again if it is still high.
+ */
+#include "stm32f4xx_hal.h"
+
+#include "MagInterface.h"
+#include "Logger.h"
+#include "MemSections.h"
+#include "Timebase.h"
+#include "main.h"
+
+#include <string.h>
+
+#define WHO_AM_I_VALUE      (0x40)
+#define REG_WHO_AM_I        (0x4F)
+#define REG_CFG_A           (0x60) // temperature compensation, reset, ODR, mode
+#define REG_CFG_B           (0x61) // offset cancellation, low-pass filter
+#define REG_CFG_C           (0x62) // DRDY routing, I2C disable, BDU, SPI mode
+#define REG_STATUS          (0x67)
+#define REG_OUTX_L          (0x68) // X, Y, Z, 16 bit LSB first
+#define BURST_LEN_BYTES     (7U)   // STATUS and the outputs, reading OUTZ_H releases DRDY
+
+#define CFG_A_COMP_TEMP_EN  (0x80)
+#define CFG_A_SOFT_RST      (0x20)
+#define CFG_A_ODR_SHIFT     (2U)
+#define CFG_A_MD_CONTINUOUS (0x00)
+#define CFG_B_OFF_CANC      (0x02) // set/reset every sample, removes the bridge offset drift
+#define CFG_C_I2C_DIS       (0x20)
+#define CFG_C_BDU           (0x10)
+#define CFG_C_DRDY_ON_PIN   (0x01)
+#define STATUS_ZYXOR        (0x80)
+
+#define ODR_SEL_MAX         (3U)   // 10, 20, 50, 100 Hz
+#define SENSITIVITY_UT      (0.15f) // 1.5 mgauss/LSB
+
+#define SPI_READ_FLAG       (0x80)
+#define SPI_TIMEOUT_MS      (10U)
+#define RESET_TIMEOUT_MS    (10U)
+#define MAX_RETRIES         (3U)    // back to back failed bursts restarted from the ISR
+
+typedef enum {
+    XFER_IDLE = 0,
+    XFER_ADDRESS,  // read address going out under interrupt
+    XFER_DATA      // line turned around, DMA receiving the burst
+} mag_xfer_state_t;
+
+// Logger tag
+static const char TAG[] = "MAG";
+
+static const uint16_t odrHz[ODR_SEL_MAX + 1U] = {10U, 20U, 50U, 100U};
+
+static SPI_HandleTypeDef* hspi;
+
+// Address byte for the burst, then the DMA receive buffer
+static uint8_t burstAddr;
+static DMA_BUFFER uint8_t dmaRxBuff[BURST_LEN_BYTES];
+static volatile mag_xfer_state_t transferState;
+static uint64_t transferStartUs;
+static bool drdyEnabled;
+static uint32_t retryCount;
+
+static mag_sample_callback_t sampleCallback;
+
+// Latest sample, published from the ISR under a sequence lock (odd while writing)
+static mag_repo_t latestRepo;
+static volatile uint32_t latestLock;
+static uint32_t seqCounter;
+
+// Diagnostics
+static volatile uint32_t busErrorCount;
+static volatile uint32_t overrunCount;
+static volatile uint32_t deviceOverrunCount;
+static volatile uint32_t recoveryCount;
+
+static inline void Mag_Select(void) {
+    HAL_GPIO_WritePin(MAG_CS_GPIO_Port, MAG_CS_Pin, GPIO_PIN_RESET);
+}
+
+static inline void Mag_Deselect(void) {
+    HAL_GPIO_WritePin(MAG_CS_GPIO_Port, MAG_CS_Pin, GPIO_PIN_SET);
+}
+
+// Blocking register access, only used during init before the kernel starts
+static bool Mag_WriteReg(uint8_t reg, uint8_t value) {
+    uint8_t buff[2] = {(uint8_t)(reg & ~SPI_READ_FLAG), value};
+    Mag_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, buff, 2, SPI_TIMEOUT_MS);
+    Mag_Deselect();
+    return status == HAL_OK;
+}
+
+static bool Mag_ReadReg(uint8_t reg, uint8_t* pBuff, uint16_t nBytes) {
+    uint8_t header = reg | SPI_READ_FLAG;
+    Mag_Select();
+    HAL_StatusTypeDef status = HAL_SPI_Transmit(hspi, &header, 1, SPI_TIMEOUT_MS);
+    if (status == HAL_OK)
+        status = HAL_SPI_Receive(hspi, pBuff, nBytes, SPI_TIMEOUT_MS);
+    Mag_Deselect();
+    return status == HAL_OK;
+}
+
+// Soft reset, then poll for the self-clearing bit instead of sleeping through it
+static bool Mag_Reset(void) {
+    if (!Mag_WriteReg(REG_CFG_A, CFG_A_SOFT_RST))
+        return false;
+
+    uint32_t start = HAL_GetTick();
+    uint8_t cfgA = CFG_A_SOFT_RST;
+    do {
+        if (Mag_ReadReg(REG_CFG_A, &cfgA, 1) && !(cfgA & CFG_A_SOFT_RST))
+            return true;
+    } while (HAL_GetTick() - start < RESET_TIMEOUT_MS);
+    return false;
+}
+
+// Slowest output data rate at or above the requested rate
+static uint8_t Mag_OdrSel(uint16_t rate) {
+    uint8_t sel = 0;
+    while (sel < ODR_SEL_MAX && odrHz[sel] < rate)
+        sel++;
+    return sel;
+}
+
+static inline int16_t Mag_S16(const uint8_t* raw) {
+    return (int16_t)((uint16_t)raw[0] | ((uint16_t)raw[1] << 8));
+}
+
+// Publishes a new sample to the latest repo, called from the transfer complete ISR
+static void Mag_Publish(const mag_sample_t* sample, uint32_t seq, uint64_t timestampUs) {
+    latestLock++;
+    __DMB();
+    latestRepo.data = *sample;
+    latestRepo.seq_n = seq;
+    latestRepo.timestamp_us = timestampUs;
+    __DMB();
+    latestLock++;
+
+    if (sampleCallback != NULL)
+        sampleCallback(&latestRepo);
+}
+
+static void Mag_AbortTransfer(void) {
+    Mag_Deselect();
+    transferState = XFER_IDLE;
+    busErrorCount++;
+}
+
+static bool Mag_StartTransfer(void) {
+    transferState = XFER_ADDRESS;
+
+    Mag_Select();
+    if (HAL_SPI_Transmit_IT(hspi, &burstAddr, 1) != HAL_OK) {
+        Mag_AbortTransfer();
+        return false;
+    }
+
+    return true;
+}
+
+// DRDY still high after a transfer means a sample nobody will raise an edge for, read it now.
+// Failed bursts are retried MAX_RETRIES times in a row, a bus that keeps failing is left to the
+// next Mag_StartRead instead of looping in the ISR.
+static void Mag_CheckDataReady(void) {
+    if (!drdyEnabled || HAL_GPIO_ReadPin(MAG_DRDY_GPIO_Port, MAG_DRDY_Pin) != GPIO_PIN_SET)
+        return;
+    if (retryCount >= MAX_RETRIES)
+        return;
+
+    recoveryCount++;
+    transferStartUs = Timebase_GetUs();
+    Mag_StartTransfer();
+}
+
+bool Mag_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate) {
+    hspi = hardwareHandles.p_hspi3;
+    transferState = XFER_IDLE;
+    drdyEnabled = false;
+    retryCount = 0;
+    sampleCallback = NULL;
+    latestLock = 0;
+    memset(&latestRepo, 0, sizeof(latestRepo));
+    seqCounter = 0;
+    busErrorCount = 0;
+    overrunCount = 0;
+    deviceOverrunCount = 0;
+    recoveryCount = 0;
+
+    if (hspi == NULL || rate == 0) {
+        LOG_DIRECT(TAG, "Fatal: Invalid SPI handle or rate");
+        return false;
+    }
+
+    uint8_t whoAmI = 0;
+    Mag_Deselect();
+    if (!Mag_ReadReg(REG_WHO_AM_I, &whoAmI, 1) || whoAmI != WHO_AM_I_VALUE) {
+        LOG_DIRECT(TAG, "Fatal: WHO_AM_I mismatch (0x%02X)", whoAmI);
+        return false;
+    }
+
+    if (!Mag_Reset()) {
+        LOG_DIRECT(TAG, "Fatal: Soft reset timed out");
+        return false;
+    }
+
+    // Stays in 3-wire mode, 4WSPI would take the DRDY pin for SDO
+    uint8_t odrSel = Mag_OdrSel(rate);
+    uint8_t cfgA = CFG_A_COMP_TEMP_EN | (uint8_t)(odrSel << CFG_A_ODR_SHIFT) | CFG_A_MD_CONTINUOUS;
+    bool ok = Mag_WriteReg(REG_CFG_C, CFG_C_I2C_DIS | CFG_C_BDU);
+    ok &= Mag_WriteReg(REG_CFG_B, CFG_B_OFF_CANC);
+    ok &= Mag_WriteReg(REG_CFG_A, cfgA);
+
+    uint8_t readBack = 0;
+    ok &= Mag_ReadReg(REG_CFG_A, &readBack, 1);
+    if (!ok || readBack != cfgA) {
+        LOG_DIRECT(TAG, "Fatal: Error writing configuration (CFG_REG_A 0x%02X)", readBack);
+        return false;
+    }
+
+    burstAddr = REG_STATUS | SPI_READ_FLAG;
+
+    LOG_DIRECT(TAG, "LIS2MDL initialized, %u Hz", odrHz[odrSel]);
+    return true;
+}
+
+bool Mag_StartRead(void) {
+    if (transferState != XFER_IDLE)
+        return false;
+
+    retryCount = 0;
+    transferStartUs = Timebase_GetUs();
+    return Mag_StartTransfer();
+}
+
+void Mag_OnDataReady(uint64_t timestampUs) {
+    if (transferState != XFER_IDLE) {
+        overrunCount++;
+        return;
+    }
+
+    transferStartUs = timestampUs;
+    Mag_StartTransfer();
+}
+
+bool Mag_SetDataReadyInterrupt(bool enable) {
+    if (transferState != XFER_IDLE)
+        return false;
+
+    bool ok = Mag_WriteReg(REG_CFG_C, CFG_C_I2C_DIS | CFG_C_BDU | (enable ? CFG_C_DRDY_ON_PIN : 0x00));
+
+    // DRDY is a level, a measurement that completed before it was routed would hold it high
+    // with no edge to come. Reading the outputs releases it.
+    uint8_t discard[BURST_LEN_BYTES];
+    ok &= Mag_ReadReg(REG_STATUS, discard, BURST_LEN_BYTES);
+
+    drdyEnabled = enable && ok;
+    if (!ok)
+        LOG_DIRECT(TAG, "Error configuring data ready interrupt");
+    return ok;
+}
+
+bool Mag_GetRepo(mag_repo_t* repoBuff) {
+    uint32_t lock;
+    do {
+        lock = latestLock;
+        __DMB();
+        *repoBuff = latestRepo;
+        __DMB();
+    } while ((lock & 1U) || lock != latestLock);
+
+    return repoBuff->seq_n != 0;
+}
+
+void Mag_SetSampleCallback(mag_sample_callback_t callback) {
+    sampleCallback = callback;
+}
+
+void Mag_OnTransferComplete(void) {
+    if (transferState == XFER_ADDRESS) {
+        // Address is out, the HAL switches the line to receive for the burst
+        transferState = XFER_DATA;
+        if (HAL_SPI_Receive_DMA(hspi, dmaRxBuff, BURST_LEN_BYTES) != HAL_OK) {
+            Mag_AbortTransfer();
+            retryCount++;
+            Mag_CheckDataReady();
+        }
+        return;
+    }
+
+    Mag_Deselect();
+
+    if (dmaRxBuff[0] & STATUS_ZYXOR)
+        deviceOverrunCount++;
+
+    const uint8_t* data = &dmaRxBuff[1];
+    mag_sample_t sample;
+    sample.mx = (float)Mag_S16(&data[0]) * SENSITIVITY_UT;
+    sample.my = (float)Mag_S16(&data[2]) * SENSITIVITY_UT;
+    sample.mz = (float)Mag_S16(&data[4]) * SENSITIVITY_UT;
+    transferState = XFER_IDLE;
+    retryCount = 0;
+
+    Mag_Publish(&sample, ++seqCounter, transferStartUs);
+    Mag_CheckDataReady();
+}
+
+void Mag_OnTransferError(void) {
+    Mag_AbortTransfer();
+    retryCount++;
+    Mag_CheckDataReady();
+}
\ No newline at end of file
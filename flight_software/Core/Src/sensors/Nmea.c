@@ -0,0 +1,172 @@
+/**
+ * NMEA 0183 sentence assembly and GGA parsing
+ *
+ * Replaces the REV1 readLine, validateChecksum and parseGGA. Those waited for a whole line in a
+ * linear buffer, walked it again for the checksum and then tokenized it with strtok_r and atof.
+ * Here each byte is handled as it is read out of the DMA ring, the checksum is complete when
+ * the '*' arrives, and GGA fields are parsed in place as fixed point integers, so no float
+ * rounding touches the position.
+ */
+
+#include "Nmea.h"
+
+#define NMEA_GGA_FIELDS 10U // type, time, lat, N/S, lon, E/W, quality, satellites, HDOP, altitude
+
+void Nmea_Init(nmea_parser_t* parser) {
+    parser->line[0] = '\0';
+    parser->len = 0;
+    parser->checksum = 0;
+    parser->expected = 0;
+    parser->state = NMEA_IDLE;
+    parser->sentences = 0;
+    parser->checksumErrors = 0;
+    parser->overlong = 0;
+}
+
+void Nmea_Reset(nmea_parser_t* parser) {
+    parser->len = 0;
+    parser->state = NMEA_IDLE;
+}
+
+static inline int32_t Nmea_Hex(uint8_t c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool Nmea_Push(nmea_parser_t* parser, uint8_t c) {
+    // '$' never appears inside a sentence, whatever came before was cut short
+    if (c == '$') {
+        parser->len = 0;
+        parser->checksum = 0;
+        parser->state = NMEA_BODY;
+        return false;
+    }
+
+    int32_t nibble;
+    switch (parser->state) {
+    case NMEA_BODY:
+        if (c == '*') {
+            parser->line[parser->len] = '\0';
+            parser->state = NMEA_CK_HIGH;
+        } else if (c < 0x20U || c > 0x7EU) {
+            parser->state = NMEA_IDLE;
+        } else if (parser->len >= NMEA_MAX_LEN) {
+            parser->overlong++;
+            parser->state = NMEA_IDLE;
+        } else {
+            parser->line[parser->len++] = (char)c;
+            parser->checksum ^= c;
+        }
+        return false;
+
+    case NMEA_CK_HIGH:
+        nibble = Nmea_Hex(c);
+        parser->expected = (uint8_t)(nibble << 4);
+        parser->state = (nibble < 0) ? NMEA_IDLE : NMEA_CK_LOW;
+        return false;
+
+    case NMEA_CK_LOW:
+        nibble = Nmea_Hex(c);
+        parser->state = NMEA_IDLE;
+        if (nibble >= 0 && (parser->expected | (uint8_t)nibble) == parser->checksum) {
+            parser->sentences++;
+            return true;
+        }
+        parser->checksumErrors++;
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+// Unsigned decimal field scaled by 10^decimals, further decimals are truncated. An empty field is 0.
+static bool Nmea_Fixed(const char* s, uint32_t decimals, uint32_t* value) {
+    uint32_t v = 0;
+    uint32_t frac = 0;
+    bool point = false;
+    for (; *s != ',' && *s != '\0'; s++) {
+        if (*s == '.' && !point) {
+            point = true;
+            continue;
+        }
+        if (*s < '0' || *s > '9')
+            return false;
+        if (point && frac == decimals)
+            continue;
+        if (v > (UINT32_MAX - 9U) / 10U)
+            return false;
+        v = v * 10U + (uint32_t)(*s - '0');
+        frac += point;
+    }
+    for (; frac < decimals; frac++) {
+        if (v > UINT32_MAX / 10U)
+            return false;
+        v *= 10U;
+    }
+    *value = v;
+    return true;
+}
+
+// [d]ddmm.mmmmm and a hemisphere to 1e-7 degrees
+static bool Nmea_Degrees(const char* s, char hemisphere, uint32_t maxDeg, int32_t* value) {
+    uint32_t ddmm;
+    if (!Nmea_Fixed(s, 5U, &ddmm))
+        return false;
+
+    uint32_t deg = ddmm / 10000000U;
+    uint32_t minE5 = ddmm % 10000000U;
+    if (deg > maxDeg || minE5 >= 6000000U)
+        return false;
+
+    // minutes / 60 in 1e-7 degrees is minE5 * 100 / 60, rounded
+    int32_t v = (int32_t)(deg * 10000000U + (minE5 * 10U + 3U) / 6U);
+    *value = (hemisphere == 'S' || hemisphere == 'W') ? -v : v;
+    return true;
+}
+
+bool Nmea_ParseGga(const char* line, gps_fix_t* fix) {
+    const char* field[NMEA_GGA_FIELDS];
+    uint32_t n = 0;
+    field[n++] = line;
+    for (const char* s = line; *s != '\0' && n < NMEA_GGA_FIELDS; s++) {
+        if (*s == ',')
+            field[n++] = s + 1;
+    }
+    if (n < NMEA_GGA_FIELDS || field[1] - line != 6 ||
+        line[2] != 'G' || line[3] != 'G' || line[4] != 'A')
+        return false;
+
+    uint32_t hhmmss = 0, quality = 0, sats = 0, hdop = 0, alt = 0;
+    int32_t lat = 0, lon = 0;
+    const char* altField = field[9];
+    bool negative = (*altField == '-');
+    if (!Nmea_Fixed(field[1], 3U, &hhmmss))
+        return false;
+    if (!Nmea_Degrees(field[2], *field[3], 90U, &lat) || !Nmea_Degrees(field[4], *field[5], 180U, &lon))
+        return false;
+    if (!Nmea_Fixed(field[6], 0U, &quality) || quality > 9U)
+        return false;
+    if (!Nmea_Fixed(field[7], 0U, &sats) || sats > 255U)
+        return false;
+    if (!Nmea_Fixed(field[8], 2U, &hdop) || !Nmea_Fixed(altField + negative, 2U, &alt))
+        return false;
+
+    // Nothing is written to the fix until every field parsed
+    uint32_t hh = hhmmss / 10000000U;
+    uint32_t mm = (hhmmss / 100000U) % 100U;
+    uint32_t ss = (hhmmss / 1000U) % 100U;
+    fix->lat_e7 = lat;
+    fix->lon_e7 = lon;
+    fix->timeOfDayMs = ((hh * 60U + mm) * 60U + ss) * 1000U + hhmmss % 1000U;
+    fix->fixQuality = (uint8_t)quality;
+    fix->numSats = (uint8_t)sats;
+    fix->hdop = (float)hdop * 0.01f;
+    fix->altMsl = (negative ? -(float)alt : (float)alt) * 0.01f;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,333 @@
+/**
+ * Sensor calibration store in two reserved flash sectors
+ *
+ * The REV1 drivers calibrated at every boot with blocking delays, about 6.1 s before the first
+ * sample (IMU 500 ms + 10 x 30 ms, barometer 10 x 30 ms, magnetometer 5 s of hand rotation).
+ * Coefficients now come from here in tens of microseconds and the online estimators refine
+ * them in flight.
+ *
+ * Flash bits can only be cleared by programming, and a sector erases as a whole in one to two
+ * seconds with every flash read stalled meanwhile. So records are only ever appended to the
+ * active sector, and once it is full, about every 900 saves, the next boot compacts into the
+ * other one. The newest record is copied there and verified before anything that holds it is
+ * erased, so there is no moment where the only copy of the calibration is in RAM. The full
+ * sector stays as it is until the following compaction erases it. A record is a header
+ * followed by a cal_data_t, all whole words:
+ *
+ *   magic | version:16 length:16 | sequence | eraseCount | crc | payload...
+ *
+ * The magic is programmed first and the CRC last. A write cut short by a reset leaves either a
+ * record whose CRC does not match, which is skipped, or a header the scan cannot follow, which
+ * makes the next boot compact the sector. The active sector is the one holding the highest
+ * intact sequence number. eraseCount is carried into every record, so the wear of the sectors
+ * survives their own erases. Records of another layout version are skipped.
+ */
+
+#include "CalStore.h"
+
+#include "stm32f4xx_hal.h"
+
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    uint32_t sequence;
+    uint32_t eraseCount;
+    uint32_t crc;
+} cal_record_t;
+
+#define CAL_ERASED_WORD   0xFFFFFFFFU
+#define CAL_HEADER_WORDS  (sizeof(cal_record_t) / sizeof(uint32_t))
+#define CAL_PAYLOAD_WORDS (sizeof(cal_data_t) / sizeof(uint32_t))
+#define CAL_RECORD_WORDS  (CAL_HEADER_WORDS + CAL_PAYLOAD_WORDS)
+#define CAL_CRC_WORD      (offsetof(cal_record_t, crc) / sizeof(uint32_t))
+#define CAL_SECTOR_WORDS  (CAL_STORE_SIZE / sizeof(uint32_t))
+
+#define CAL_FLASH_ERRORS  (FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | \
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+_Static_assert(sizeof(cal_record_t) % sizeof(uint32_t) == 0U, "record header must be whole words");
+_Static_assert(sizeof(cal_data_t) % sizeof(uint32_t) == 0U, "cal_data_t must be whole words");
+
+// Start of the first sector, from the linker script, the second follows it
+extern uint32_t _scalib[];
+static const uint32_t sectorIds[2] = { CAL_STORE_SECTOR0, CAL_STORE_SECTOR1 };
+
+// What a walk over one sector found
+typedef struct {
+    uint32_t recent[CAL_STORE_RECENT]; // word offsets of the newest records, oldest overwritten
+    uint32_t found;                    // records, including unreadable ones
+    uint32_t end;                      // words in use, all of them after a broken header
+    bool intact;                       // one of the newest records checks out
+    uint32_t sequence;                 // sequence and eraseCount of the newest that does
+    uint32_t eraseCount;
+} cal_scan_t;
+
+// Newest loadable record, a copy in RAM so readers never touch flash
+static cal_data_t current;
+static bool loaded;
+
+static uint32_t active;      // sector records are appended to
+static uint32_t writeOffset; // words into it
+static uint32_t nextSequence;
+static uint32_t eraseCount;
+
+// Counters
+static volatile cal_store_stats_t stats;
+
+// CRC-32 (IEEE, reflected) four bits at a time, a 64 byte table instead of 1 KB
+static const uint32_t crcTable[16] = {
+    0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+    0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+static uint32_t CalStore_CrcWords(uint32_t crc, const volatile uint32_t* words, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        // A whole little endian word at once, same result as byte by byte
+        crc ^= words[i];
+        for (uint32_t j = 0; j < 8; j++)
+            crc = (crc >> 4) ^ crcTable[crc & 0xFU];
+    }
+    return crc;
+}
+
+// Covers the header words after the magic, up to the CRC, then the payload
+static uint32_t CalStore_RecordCrc(const volatile uint32_t* record, uint32_t payloadWords) {
+    uint32_t crc = CalStore_CrcWords(0xFFFFFFFFU, &record[1], CAL_CRC_WORD - 1U);
+    crc = CalStore_CrcWords(crc, &record[CAL_HEADER_WORDS], payloadWords);
+    return ~crc;
+}
+
+static inline uint32_t CalStore_Length(const volatile uint32_t* record) {
+    return record[offsetof(cal_record_t, version) / sizeof(uint32_t)] >> 16;
+}
+
+static inline uint32_t CalStore_Version(const volatile uint32_t* record) {
+    return record[offsetof(cal_record_t, version) / sizeof(uint32_t)] & 0xFFFFU;
+}
+
+static inline volatile uint32_t* CalStore_Sector(uint32_t s) {
+    return &_scalib[s * CAL_SECTOR_WORDS];
+}
+
+static inline bool CalStore_Intact(const volatile uint32_t* record) {
+    return CalStore_RecordCrc(record, CalStore_Length(record) / sizeof(uint32_t)) == record[CAL_CRC_WORD];
+}
+
+// The ART data cache can still hold the words as they were before an erase or program
+static void CalStore_FlushCache(void) {
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_RESET();
+    __HAL_FLASH_DATA_CACHE_ENABLE();
+}
+
+static bool CalStore_Erase(uint32_t s) {
+    FLASH_EraseInitTypeDef erase = {
+        .TypeErase = FLASH_TYPEERASE_SECTORS,
+        .Sector = sectorIds[s],
+        .NbSectors = 1,
+        .VoltageRange = FLASH_VOLTAGE_RANGE_3
+    };
+    uint32_t sectorError = 0;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(CAL_FLASH_ERRORS);
+    bool ok = HAL_FLASHEx_Erase(&erase, &sectorError) == HAL_OK;
+    HAL_FLASH_Lock();
+    CalStore_FlushCache();
+
+    eraseCount++;
+    stats.eraseCount = eraseCount;
+    return ok;
+}
+
+static bool CalStore_Append(const cal_data_t* data) {
+    if ((writeOffset + CAL_RECORD_WORDS) * sizeof(uint32_t) > CAL_STORE_SIZE)
+        return false;
+
+    uint32_t words[CAL_RECORD_WORDS];
+    cal_record_t header = {
+        .magic = CAL_STORE_MAGIC,
+        .version = CAL_STORE_VERSION,
+        .length = sizeof(cal_data_t),
+        .sequence = nextSequence,
+        .eraseCount = eraseCount
+    };
+    memcpy(words, &header, sizeof(header));
+    memcpy(&words[CAL_HEADER_WORDS], data, sizeof(cal_data_t));
+    words[CAL_CRC_WORD] = CalStore_RecordCrc(words, CAL_PAYLOAD_WORDS);
+
+    // Magic first, CRC last, so an interrupted record never checks out
+    volatile uint32_t* dst = &CalStore_Sector(active)[writeOffset];
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(CAL_FLASH_ERRORS);
+    bool ok = true;
+    for (uint32_t i = 0; i < CAL_RECORD_WORDS && ok; i++) {
+        if (i != CAL_CRC_WORD)
+            ok = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, (uintptr_t)&dst[i], words[i]) == HAL_OK;
+    }
+    if (ok)
+        ok = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, (uintptr_t)&dst[CAL_CRC_WORD], words[CAL_CRC_WORD]) == HAL_OK;
+    HAL_FLASH_Lock();
+    CalStore_FlushCache();
+
+    // The space is used even if the write failed
+    writeOffset += CAL_RECORD_WORDS;
+    stats.records++;
+    stats.bytesUsed = writeOffset * sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < CAL_RECORD_WORDS && ok; i++)
+        ok = dst[i] == words[i];
+    if (!ok)
+        return false;
+
+    stats.sequence = nextSequence++;
+    return true;
+}
+
+// Walks the headers to the first erased word, remembering the newest few records
+static void CalStore_Scan(uint32_t s, cal_scan_t* scan) {
+    const volatile uint32_t* sector = CalStore_Sector(s);
+    uint32_t offset = 0;
+    scan->found = 0;
+    scan->end = CAL_SECTOR_WORDS;
+    while ((offset + CAL_HEADER_WORDS) * sizeof(uint32_t) <= CAL_STORE_SIZE) {
+        const volatile uint32_t* record = &sector[offset];
+        if (record[0] == CAL_ERASED_WORD) {
+            scan->end = offset;
+            break;
+        }
+
+        uint32_t length = CalStore_Length(record);
+        uint32_t room = CAL_STORE_SIZE - (offset + CAL_HEADER_WORDS) * sizeof(uint32_t);
+        if (record[0] != CAL_STORE_MAGIC || length % sizeof(uint32_t) != 0U || length > room)
+            break; // interrupted header, nothing after it can be trusted
+
+        scan->recent[scan->found % CAL_STORE_RECENT] = offset;
+        scan->found++;
+        offset += CAL_HEADER_WORDS + length / sizeof(uint32_t);
+    }
+
+    // The newest intact record carries the counters forward
+    scan->intact = false;
+    uint32_t tries = (scan->found < CAL_STORE_RECENT) ? scan->found : CAL_STORE_RECENT;
+    for (uint32_t i = 0; i < tries && !scan->intact; i++) {
+        const volatile uint32_t* record = &sector[scan->recent[(scan->found - 1U - i) % CAL_STORE_RECENT]];
+        if (!CalStore_Intact(record))
+            continue;
+        scan->intact = true;
+        scan->sequence = record[offsetof(cal_record_t, sequence) / sizeof(uint32_t)];
+        scan->eraseCount = record[offsetof(cal_record_t, eraseCount) / sizeof(uint32_t)];
+    }
+}
+
+// Loads the newest intact record of this layout version among the newest few of a sector
+static bool CalStore_LoadNewest(uint32_t s, const cal_scan_t* scan) {
+    const volatile uint32_t* sector = CalStore_Sector(s);
+    uint32_t tries = (scan->found < CAL_STORE_RECENT) ? scan->found : CAL_STORE_RECENT;
+    for (uint32_t i = 0; i < tries; i++) {
+        const volatile uint32_t* record = &sector[scan->recent[(scan->found - 1U - i) % CAL_STORE_RECENT]];
+        if (CalStore_Version(record) != CAL_STORE_VERSION || CalStore_Length(record) != sizeof(cal_data_t) ||
+            !CalStore_Intact(record))
+            continue;
+
+        uint32_t payload[CAL_PAYLOAD_WORDS];
+        for (uint32_t w = 0; w < CAL_PAYLOAD_WORDS; w++)
+            payload[w] = record[CAL_HEADER_WORDS + w];
+        memcpy(&current, payload, sizeof(current));
+        stats.sequence = record[offsetof(cal_record_t, sequence) / sizeof(uint32_t)];
+        return true;
+    }
+    return false;
+}
+
+// Copies the loaded record into the other sector, which becomes active once it reads back
+static bool CalStore_Compact(const cal_scan_t* spareScan) {
+    uint32_t full = active;
+    uint32_t fullOffset = writeOffset;
+    uint32_t spare = active ^ 1U;
+
+    // Nothing is ever programmed past an erased first word, a blank sector needs no erase
+    if (spareScan->end != 0U && !CalStore_Erase(spare))
+        return false;
+
+    active = spare;
+    writeOffset = 0;
+    stats.records = 0;
+    stats.bytesUsed = 0;
+    if (!loaded || CalStore_Append(&current))
+        return true;
+
+    // The full sector still holds the record and stays active, saves fail until the next boot
+    active = full;
+    writeOffset = fullOffset;
+    return false;
+}
+
+bool CalStore_Init(void) {
+    memset(&current, 0, sizeof(current));
+    loaded = false;
+    nextSequence = 1;
+    eraseCount = 0;
+    stats.sequence = 0;
+    stats.saves = 0;
+    stats.failures = 0;
+
+    cal_scan_t scans[2];
+    CalStore_Scan(0, &scans[0]);
+    CalStore_Scan(1, &scans[1]);
+
+    // Counters continue from the newest record in either sector, which is also the active one
+    active = 0;
+    for (uint32_t s = 0; s < 2U; s++) {
+        if (!scans[s].intact)
+            continue;
+        if (scans[s].sequence >= nextSequence) {
+            nextSequence = scans[s].sequence + 1U;
+            active = s;
+        }
+        if (scans[s].eraseCount > eraseCount)
+            eraseCount = scans[s].eraseCount;
+    }
+    writeOffset = scans[active].end;
+    stats.records = scans[active].found;
+    stats.bytesUsed = writeOffset * sizeof(uint32_t);
+    stats.eraseCount = eraseCount;
+
+    // The other sector only holds older records, a fallback when the active one has none to load
+    loaded = CalStore_LoadNewest(active, &scans[active]) || CalStore_LoadNewest(active ^ 1U, &scans[active ^ 1U]);
+
+    // Compact when another record would not fit, the only place a sector is erased
+    if ((writeOffset + CAL_RECORD_WORDS) * sizeof(uint32_t) > CAL_STORE_SIZE && !CalStore_Compact(&scans[active ^ 1U]))
+        stats.failures++;
+    return loaded;
+}
+
+bool CalStore_Load(cal_data_t* data) {
+    *data = current;
+    return loaded;
+}
+
+bool CalStore_Save(const cal_data_t* data) {
+    if (!CalStore_Append(data)) {
+        stats.failures++;
+        return false;
+    }
+
+    current = *data;
+    loaded = true;
+    stats.saves++;
+    return true;
+}
+
+void CalStore_GetStats(cal_store_stats_t* statsBuff) {
+    statsBuff->records = stats.records;
+    statsBuff->bytesUsed = stats.bytesUsed;
+    statsBuff->sequence = stats.sequence;
+    statsBuff->eraseCount = stats.eraseCount;
+    statsBuff->saves = stats.saves;
+    statsBuff->failures = stats.failures;
+}
\ No newline at end of file
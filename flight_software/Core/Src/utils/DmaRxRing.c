@@ -0,0 +1,82 @@
+/**
+ * Reader of a UART receive DMA running in circular mode
+ *
+ * The stream never stops, so nothing the reader does can hold the sender back. The interrupt
+ * side turns the position of each HAL receive event into a free running count of bytes
+ * written. The reader adds how far the stream has moved since, read from the DMA counter, and
+ * keeps its own count of bytes read, so the difference is exactly what waits and the oldest
+ * byte is intact until the stream is a full buffer past it.
+ */
+
+#include "DmaRxRing.h"
+#include "MemSections.h"
+#include "stm32f4xx_hal.h"
+
+#include <string.h>
+
+bool DmaRxRing_Init(dma_rx_ring_t* ring, const volatile uint8_t* buff, uint32_t size, dma_rx_position_t position) {
+    if (size == 0U || (size & (size - 1U)) != 0U || position == NULL)
+        return false;
+
+    ring->buff = buff;
+    ring->size = size;
+    ring->position = position;
+    ring->lastPos = 0;
+    ring->written = 0;
+    ring->events = 0;
+    ring->read = 0;
+    ring->dropped = 0;
+    return true;
+}
+
+RAMFUNC void DmaRxRing_OnEvent(dma_rx_ring_t* ring, uint32_t pos) {
+    // Transfer complete reports the end of the buffer, which is the start of the next lap
+    uint32_t mask = ring->size - 1U;
+    pos &= mask;
+    ring->written += (pos - ring->lastPos) & mask;
+    ring->lastPos = pos;
+    ring->events++;
+}
+
+// Bytes received so far, retried if an event lands between the fields
+static uint32_t DmaRxRing_Head(const dma_rx_ring_t* ring) {
+    uint32_t events, written, lastPos, pos;
+    do {
+        events = ring->events;
+        __DMB();
+        written = ring->written;
+        lastPos = ring->lastPos;
+        pos = ring->position();
+        __DMB();
+    } while (events != ring->events);
+
+    return written + ((pos - lastPos) & (ring->size - 1U));
+}
+
+// Skips everything received so far, the stream is already over the oldest of it
+static uint32_t DmaRxRing_Drop(dma_rx_ring_t* ring, uint32_t head) {
+    ring->dropped += head - ring->read;
+    ring->read = head;
+    return 0;
+}
+
+uint32_t DmaRxRing_Read(dma_rx_ring_t* ring, uint8_t* dst, uint32_t maxLen) {
+    uint32_t head = DmaRxRing_Head(ring);
+    uint32_t avail = head - ring->read;
+    if (avail > ring->size)
+        return DmaRxRing_Drop(ring, head);
+
+    uint32_t len = (avail < maxLen) ? avail : maxLen;
+    uint32_t idx = ring->read & (ring->size - 1U);
+    uint32_t first = (len < ring->size - idx) ? len : ring->size - idx;
+    memcpy(dst, (const uint8_t*)ring->buff + idx, first);
+    memcpy(dst + first, (const uint8_t*)ring->buff, len - first);
+
+    // The stream ran on during the copy, if it came round to the copied bytes they are torn
+    head = DmaRxRing_Head(ring);
+    if (head - ring->read > ring->size)
+        return DmaRxRing_Drop(ring, head);
+
+    ring->read += len;
+    return len;
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * Lock-free multi producer / single consumer ring of variable length log records
+ *
+ * Producers reserve space by advancing head with a compare-and-swap, copy their payload in,
+ * then publish a header word with the COMMITTED bit set. Records never wrap: a reservation
+ * that would cross the end of the buffer also claims the tail end as a padding record.
+ * The consumer stops at the first uncommitted header, and zeroes every record it releases
+ * so a stale payload word can never be mistaken for a committed header.
+ */
+
+#include "LogRing.h"
+#include "MemSections.h"
+
+#include <string.h>
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1U)
+
+// Record header word
+#define LOG_REC_COMMITTED 0x80000000U
+#define LOG_REC_PAD       0x40000000U
+#define LOG_REC_LEN_MASK  0x0000FFFFU // payload length in bytes
+#define LOG_REC_HDR_SIZE  4U
+
+// Header plus payload, rounded up so every header stays word aligned
+#define LOG_REC_SIZE(len) ((LOG_REC_HDR_SIZE + (len) + 3U) & ~3U)
+
+_Static_assert((LOG_RING_SIZE & LOG_RING_MASK) == 0U, "LOG_RING_SIZE must be a power of 2");
+_Static_assert(LOG_RING_SIZE <= 32768U, "padding records must fit the header length field");
+_Static_assert(LOG_REC_SIZE(LOG_RING_MAX_RECORD) <= LOG_RING_SIZE, "LOG_RING_MAX_RECORD too large");
+
+static CCM_BSS uint32_t ring[LOG_RING_SIZE / 4U];
+static volatile uint32_t head; // bytes reserved by producers, free running
+static volatile uint32_t tail; // bytes released by the consumer, free running
+
+// Counters
+static volatile uint32_t drops;
+static volatile uint32_t highWater;
+
+void LogRing_Init(void) {
+    memset(ring, 0, sizeof(ring));
+    head = 0;
+    tail = 0;
+    drops = 0;
+    highWater = 0;
+}
+
+bool LogRing_Write(const void* data, uint16_t len) {
+    if (len == 0 || len > LOG_RING_MAX_RECORD) {
+        __atomic_fetch_add(&drops, 1U, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint32_t recSize = LOG_REC_SIZE(len);
+    uint32_t pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    uint32_t pad;
+    uint32_t next;
+    do {
+        uint32_t offset = pos & LOG_RING_MASK;
+        pad = (offset + recSize > LOG_RING_SIZE) ? LOG_RING_SIZE - offset : 0U;
+        next = pos + pad + recSize;
+
+        // Acquire pairs with the consumer zeroing released records before moving tail
+        if (next - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) > LOG_RING_SIZE) {
+            __atomic_fetch_add(&drops, 1U, __ATOMIC_RELAXED);
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&head, &pos, next, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    // Track the deepest the ring has been, a stale tail only overestimates
+    uint32_t used = next - tail;
+    uint32_t prevHigh = __atomic_load_n(&highWater, __ATOMIC_RELAXED);
+    while (used > prevHigh &&
+           !__atomic_compare_exchange_n(&highWater, &prevHigh, used, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    if (pad > 0U) {
+        uint32_t* padHdr = &ring[(pos & LOG_RING_MASK) / 4U];
+        __atomic_store_n(padHdr, LOG_REC_COMMITTED | LOG_REC_PAD | (pad - LOG_REC_HDR_SIZE), __ATOMIC_RELEASE);
+    }
+
+    uint32_t* hdr = &ring[((pos + pad) & LOG_RING_MASK) / 4U];
+    memcpy(hdr + 1, data, len);
+    __atomic_store_n(hdr, LOG_REC_COMMITTED | len, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint16_t LogRing_Read(void* dst, uint16_t maxLen) {
+    for (;;) {
+        uint32_t pos = tail;
+        if (pos == __atomic_load_n(&head, __ATOMIC_RELAXED))
+            return 0;
+
+        uint32_t* hdr = &ring[(pos & LOG_RING_MASK) / 4U];
+        uint32_t word = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+        if (!(word & LOG_REC_COMMITTED))
+            return 0; // reserved but the producer is still copying
+
+        uint16_t len = word & LOG_REC_LEN_MASK;
+        uint32_t recSize = LOG_REC_SIZE(len);
+        uint16_t copied = 0;
+        if (!(word & LOG_REC_PAD)) {
+            copied = (len < maxLen) ? len : maxLen;
+            memcpy(dst, hdr + 1, copied);
+        }
+
+        memset(hdr, 0, recSize);
+        __atomic_store_n(&tail, pos + recSize, __ATOMIC_RELEASE);
+
+        if (!(word & LOG_REC_PAD))
+            return copied;
+    }
+}
+
+void LogRing_GetStats(log_ring_stats_t* statsBuff) {
+    statsBuff->drops = drops;
+    statsBuff->highWater = highWater;
+    statsBuff->used = head - tail;
+}
\ No newline at end of file
@@ -1,72 +1,706 @@
 /**
  * Thread safe Logging Utility that can be configured for UART or USB-CDC
+ *
+ * LOG() only captures the format pointer and raw argument words into a lock-free record ring,
+ * so it is safe to call from interrupt handlers. LoggerTask expands the records
+ * (or, with LOG_BINARY_OUTPUT, emits them as binary frames for tools/log_decode.py) straight
+ * into one of two TX buffers while the other is drained by UART DMA or the CDC IN endpoint.
+ * Messages that arrive during a transfer coalesce into the next one, so the task never
+ * waits on the serial link byte by byte. A transfer that never completes, as when USB resets
+ * with the CDC IN endpoint busy, is abandoned after LOGGER_TX_TIMEOUT_MS and its messages
+ * counted as drops.
  */
 
 #include "Logger.h"
+#include "LogRing.h"
+#include "MemSections.h"
+#include "Timebase.h"
 
 #include "usb_device.h"
 #include "usbd_cdc_if.h"
 #include "cmsis_os2.h"
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 // Logger tag
 static const char TAG[] = "LOGGER";
 
+// Thread flags raised by the transfer complete ISR and by producers
+#define LOGGER_FLAG_TX_DONE 0x01U
+#define LOGGER_FLAG_DATA    0x02U
+#define LOGGER_FLAG_RX      0x04U
+
+#define LOGGER_TX_TIMEOUT_MS 500U
+
 // RTOS handles and flags
 static volatile bool loggerTaskRunning;
-static osMessageQueueId_t queue;
+static osThreadId_t volatile loggerThread;
+
+// Double buffered TX, LoggerTask fills one while the other is in flight
+static DMA_BUFFER uint8_t txBuff[2][LOG_TX_BUFF_SIZE];
+static uint16_t txFill;         // bytes formatted into the fill buffer
+static uint16_t txFillMsgs;     // messages formatted into the fill buffer
+static uint8_t fillIdx;         // buffer LoggerTask is formatting into
+static volatile bool txBusy;    // other buffer is in flight
+static volatile uint16_t txLen; // length of the buffer in flight
+static uint16_t txMsgs;         // messages in the buffer in flight
+static uint32_t txStartTick;    // kernel tick the buffer in flight was handed over
+
+// Counters
+static volatile log_stats_t stats;
+
+// Runtime level filters, entries are only ever added so readers need no lock
+typedef struct {
+    char tag[LOG_MAX_TAG_LEN + 1];
+    volatile log_level_t level;
+} log_tag_filter_t;
+
+static log_tag_filter_t tagFilters[LOG_MAX_TAG_FILTERS];
+static volatile uint8_t nTagFilters;
+static volatile log_level_t defaultLevel;
+static volatile log_level_t lowestLevel;  // lowest threshold in use, anything below is dropped outright
+static volatile log_level_t highestLevel; // highest threshold in use, anything at or above passes outright
+
+static const char* const levelNames[] = { "debug", "info", "warn", "error", "none" };
+
+// Command line received over CDC, owned by the ISR until rxLineReady is set
+static char rxLine[LOG_MAX_CMD_LEN];
+static volatile uint8_t rxLen;
+static volatile bool rxLineReady;
+
+// Argument classes of a printf conversion, decides how many words are captured
+typedef enum {
+    LOG_ARG_NONE,   // "%%"
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_INTMAX,
+    LOG_ARG_FLOAT,  // passed as double, stored as float
+    LOG_ARG_PTR,    // %s and %p
+    LOG_ARG_INVALID
+} log_arg_t;
+
+#define LOG_ARG_WORDS(type) ((sizeof(type) + 3U) / 4U)
+
+// Packs a value of the given type into the record, stops capturing once the record is full
+#define LOG_PUSH_ARG(type, value)                                   \
+    do {                                                            \
+        type val_ = (type)(value);                                  \
+        if (n + LOG_ARG_WORDS(type) > LOG_MAX_ARG_WORDS)            \
+            return n;                                               \
+        memcpy(&words[n], &val_, sizeof(type));                     \
+        n += LOG_ARG_WORDS(type);                                   \
+    } while (0)
+
+// Unpacks a value of the given type from the record, evaluates to false if the record ran out
+#define LOG_POP_ARG(type, dst)                                      \
+    ((idx + LOG_ARG_WORDS(type) <= msg->nWords)                     \
+        ? (memcpy(&(dst), &msg->args[idx], sizeof(type)), idx += LOG_ARG_WORDS(type), true) \
+        : false)
+
+// Ring record carrying a data frame, its leading fields match log_msg_t
+// and a NULL format tells it apart from a message
+typedef struct {
+    uint64_t timestampUs;
+    const char* tag;
+    const char* format;
+    uint8_t type;
+    uint8_t len;
+    uint8_t payload[LOG_MAX_FRAME_LEN];
+} log_frame_t;
+
+typedef union {
+    log_msg_t msg;
+    log_frame_t frame;
+} log_record_t;
+
+_Static_assert(sizeof(log_frame_t) <= LOG_RING_MAX_RECORD, "LOG_MAX_FRAME_LEN too large for the record ring");
+
+/**
+ * @brief Parses one conversion spec
+ * @param p Pointer to the '%' starting the spec
+ * @param type Filled with the argument class of the conversion
+ * @returns Pointer to the first character after the spec
+ */
+static const char* Logger_ParseSpec(const char* p, log_arg_t* type) {
+    p++; // skip '%'
+    if (*p == '%') {
+        *type = LOG_ARG_NONE;
+        return p + 1;
+    }
+
+    // flags, width, precision
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL)
+        p++;
+    while (*p >= '0' && *p <= '9')
+        p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+
+    // length modifier, 'q' stands in for "ll"
+    char mod = '\0';
+    if (*p == 'h') {
+        p++;
+        if (*p == 'h')
+            p++;
+    } else if (*p == 'l') {
+        mod = 'l';
+        p++;
+        if (*p == 'l') {
+            mod = 'q';
+            p++;
+        }
+    } else if (*p != '\0' && strchr("zjt", *p) != NULL) {
+        mod = *p++;
+    }
+
+    char conv = *p;
+    if (conv == '\0') {
+        *type = LOG_ARG_INVALID;
+        return p;
+    }
+    p++;
+
+    switch (conv) {
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        switch (mod) {
+        case 'l': *type = LOG_ARG_LONG; break;
+        case 'q': *type = LOG_ARG_LLONG; break;
+        case 'z': *type = LOG_ARG_SIZE; break;
+        case 't': *type = LOG_ARG_PTRDIFF; break;
+        case 'j': *type = LOG_ARG_INTMAX; break;
+        default:  *type = LOG_ARG_INT; break;
+        }
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *type = LOG_ARG_FLOAT;
+        break;
+    case 's': case 'p':
+        *type = LOG_ARG_PTR;
+        break;
+    default:
+        *type = LOG_ARG_INVALID;
+        break;
+    }
+    return p;
+}
+
+/**
+ * @brief Packs the variadic arguments of a format into raw words
+ * @returns Number of words used
+ */
+static uint8_t Logger_CaptureArgs(const char* format, va_list args, uint32_t* words) {
+    uint8_t n = 0;
+    const char* p = format;
+    while (*p != '\0') {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+
+        log_arg_t type;
+        p = Logger_ParseSpec(p, &type);
+        switch (type) {
+        case LOG_ARG_NONE:    break;
+        case LOG_ARG_INT:     LOG_PUSH_ARG(int, va_arg(args, int)); break;
+        case LOG_ARG_LONG:    LOG_PUSH_ARG(long, va_arg(args, long)); break;
+        case LOG_ARG_LLONG:   LOG_PUSH_ARG(long long, va_arg(args, long long)); break;
+        case LOG_ARG_SIZE:    LOG_PUSH_ARG(size_t, va_arg(args, size_t)); break;
+        case LOG_ARG_PTRDIFF: LOG_PUSH_ARG(ptrdiff_t, va_arg(args, ptrdiff_t)); break;
+        case LOG_ARG_INTMAX:  LOG_PUSH_ARG(intmax_t, va_arg(args, intmax_t)); break;
+        case LOG_ARG_FLOAT:   LOG_PUSH_ARG(float, va_arg(args, double)); break;
+        case LOG_ARG_PTR:     LOG_PUSH_ARG(const void*, va_arg(args, const void*)); break;
+        default:              return n;
+        }
+    }
+    return n;
+}
+
+// Writes the "[seconds.micros] [tag] " line prefix, returns its length
+static uint16_t Logger_FormatPrefix(char* dst, uint16_t limit, uint64_t timestampUs, const char* tag, bool* truncated) {
+    *truncated = false;
+
+    uint32_t seconds = (uint32_t)(timestampUs / 1000000U);
+    uint32_t micros = (uint32_t)(timestampUs - (uint64_t)seconds * 1000000U);
+    int ret = snprintf(dst, limit, "[%lu.%06lu] [%s] ", (unsigned long)seconds, (unsigned long)micros, tag);
+    if (ret < 0)
+        ret = 0; // snprintf fail
+    if (ret >= limit) {
+        *truncated = true;
+        return limit - 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Expands a deferred record as "[seconds.micros] [tag] msg\r\n"
+ * @param dst Output buffer
+ * @param space Size of the output buffer, at least 3 bytes
+ * @param truncated Set if the line was cut short to fit
+ * @returns Number of bytes written
+ */
+static uint16_t Logger_FormatRecord(char* dst, uint16_t space, const log_msg_t* msg, bool* truncated) {
+    uint16_t limit = space - 2; // keep room for "\r\n"
+    uint8_t idx = 0;
+    char spec[16];
+    int ret;
+    uint16_t pos = Logger_FormatPrefix(dst, limit, msg->timestampUs, msg->tag, truncated);
 
-// Pointer to print function
+    const char* p = msg->format;
+    while (!*truncated && *p != '\0') {
+        // literal text
+        if (*p != '%') {
+            if (pos >= limit - 1) {
+                *truncated = true;
+                break;
+            }
+            dst[pos++] = *p++;
+            continue;
+        }
+
+        const char* start = p;
+        log_arg_t type;
+        p = Logger_ParseSpec(p, &type);
+        size_t specLen = p - start;
+        if (type == LOG_ARG_INVALID || specLen >= sizeof(spec))
+            break;
+        memcpy(spec, start, specLen);
+        spec[specLen] = '\0';
+
+        char* out = dst + pos;
+        size_t outSpace = limit - pos;
+        ret = -1;
+        switch (type) {
+        case LOG_ARG_NONE: {
+            ret = snprintf(out, outSpace, "%%");
+            break;
+        }
+        case LOG_ARG_INT: {
+            int v;
+            if (LOG_POP_ARG(int, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_LONG: {
+            long v;
+            if (LOG_POP_ARG(long, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_LLONG: {
+            long long v;
+            if (LOG_POP_ARG(long long, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_SIZE: {
+            size_t v;
+            if (LOG_POP_ARG(size_t, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_PTRDIFF: {
+            ptrdiff_t v;
+            if (LOG_POP_ARG(ptrdiff_t, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_INTMAX: {
+            intmax_t v;
+            if (LOG_POP_ARG(intmax_t, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        case LOG_ARG_FLOAT: {
+            float v;
+            if (LOG_POP_ARG(float, v)) ret = snprintf(out, outSpace, spec, (double)v);
+            break;
+        }
+        case LOG_ARG_PTR: {
+            const void* v;
+            if (LOG_POP_ARG(const void*, v)) ret = snprintf(out, outSpace, spec, v);
+            break;
+        }
+        default:
+            break;
+        }
+
+        // ran out of captured arguments or snprintf fail
+        if (ret < 0)
+            break;
+        if ((size_t)ret >= outSpace) {
+            pos = limit - 1;
+            *truncated = true;
+        } else {
+            pos += ret;
+        }
+    }
+
+    dst[pos++] = '\r';
+    dst[pos++] = '\n';
+    return pos;
+}
+
+#ifndef LOG_BINARY_OUTPUT
+/**
+ * @brief Expands a data frame as "[seconds.micros] [tag] #type hex\r\n"
+ * @param dst Output buffer
+ * @param space Size of the output buffer, at least 3 bytes
+ * @param truncated Set if the line was cut short to fit
+ * @returns Number of bytes written
+ */
+static uint16_t Logger_FormatFrame(char* dst, uint16_t space, const log_frame_t* frame, bool* truncated) {
+    static const char hex[] = "0123456789abcdef";
+    uint16_t limit = space - 2; // keep room for "\r\n"
+    uint16_t pos = Logger_FormatPrefix(dst, limit, frame->timestampUs, frame->tag, truncated);
+
+    if (!*truncated) {
+        int ret = snprintf(dst + pos, limit - pos, "#%02x ", frame->type);
+        if (ret < 0 || ret >= limit - pos)
+            *truncated = true;
+        else
+            pos += ret;
+    }
+
+    for (uint8_t i = 0; i < frame->len && !*truncated; i++) {
+        if (pos + 2U >= limit) {
+            *truncated = true;
+            break;
+        }
+        dst[pos++] = hex[frame->payload[i] >> 4];
+        dst[pos++] = hex[frame->payload[i] & 0x0FU];
+    }
+
+    dst[pos++] = '\r';
+    dst[pos++] = '\n';
+    return pos;
+}
+#endif
+
+#ifdef LOG_BINARY_OUTPUT
+/**
+ * @brief Encodes a deferred record as a binary frame:
+ *        sync0, sync1, payload length, timestamp (2 words), tag address, format address, argument words (little endian)
+ * @returns Number of bytes written, or -1 if the frame does not fit
+ */
+static int Logger_EncodeRecord(uint8_t* dst, uint16_t space, const log_msg_t* msg) {
+    uint32_t header[4] = {
+        (uint32_t)msg->timestampUs,
+        (uint32_t)(msg->timestampUs >> 32),
+        (uint32_t)(uintptr_t)msg->tag,
+        (uint32_t)(uintptr_t)msg->format
+    };
+    uint16_t payloadLen = sizeof(header) + msg->nWords * sizeof(uint32_t);
+    if (payloadLen + 3U > space)
+        return -1;
+
+    dst[0] = LOG_FRAME_SYNC0;
+    dst[1] = LOG_FRAME_SYNC1;
+    dst[2] = (uint8_t)payloadLen;
+    memcpy(&dst[3], header, sizeof(header));
+    memcpy(&dst[3 + sizeof(header)], msg->args, msg->nWords * sizeof(uint32_t));
+    return payloadLen + 3;
+}
+
+/**
+ * @brief Encodes a data frame as a binary frame:
+ *        sync0, LOG_DATA_SYNC1, payload length, timestamp (2 words), type, frame payload
+ * @returns Number of bytes written, or -1 if the frame does not fit
+ */
+static int Logger_EncodeFrame(uint8_t* dst, uint16_t space, const log_frame_t* frame) {
+    uint32_t header[2] = {
+        (uint32_t)frame->timestampUs,
+        (uint32_t)(frame->timestampUs >> 32)
+    };
+    uint16_t payloadLen = sizeof(header) + 1U + frame->len;
+    if (payloadLen + 3U > space)
+        return -1;
+
+    dst[0] = LOG_FRAME_SYNC0;
+    dst[1] = LOG_DATA_SYNC1;
+    dst[2] = (uint8_t)payloadLen;
+    memcpy(&dst[3], header, sizeof(header));
+    dst[3 + sizeof(header)] = frame->type;
+    memcpy(&dst[4 + sizeof(header)], frame->payload, frame->len);
+    return payloadLen + 3;
+}
+#endif
+
+// Returns the filter entry of a tag, NULL if it has none
+static log_tag_filter_t* Logger_FindFilter(const char* tag) {
+    uint8_t n = nTagFilters;
+    __DMB();
+    for (uint8_t i = 0; i < n; i++) {
+        if (strncmp(tagFilters[i].tag, tag, LOG_MAX_TAG_LEN) == 0)
+            return &tagFilters[i];
+    }
+    return NULL;
+}
+
+// Checks a message against the level of its tag, the table is only searched when the bounds can't decide
+static bool Logger_LevelEnabled(log_level_t level, const char* tag) {
+    if (level < lowestLevel)
+        return false;
+    if (level >= highestLevel)
+        return true;
+
+    const log_tag_filter_t* filter = Logger_FindFilter(tag);
+    return level >= ((filter != NULL) ? filter->level : defaultLevel);
+}
+
+// Recomputes the threshold bounds after the table changed
+static void Logger_UpdateLevelBounds(void) {
+    log_level_t lowest = defaultLevel;
+    log_level_t highest = defaultLevel;
+    for (uint8_t i = 0; i < nTagFilters; i++) {
+        if (tagFilters[i].level < lowest)
+            lowest = tagFilters[i].level;
+        if (tagFilters[i].level > highest)
+            highest = tagFilters[i].level;
+    }
+    lowestLevel = lowest;
+    highestLevel = highest;
+}
+
+// Applies a "loglevel <tag|*> <level>" command received over CDC
+static void Logger_HandleCommand(char* line) {
+    char* save;
+    char* cmd = strtok_r(line, " \t", &save);
+    char* tag = strtok_r(NULL, " \t", &save);
+    char* name = strtok_r(NULL, " \t", &save);
+    if (cmd == NULL || strcmp(cmd, "loglevel") != 0)
+        return;
+
+    log_level_t level = LOG_LEVEL_NONE + 1;
+    for (log_level_t i = 0; name != NULL && i <= LOG_LEVEL_NONE; i++) {
+        if (strcmp(name, levelNames[i]) == 0)
+            level = i;
+    }
+    if (tag == NULL || !Logger_SetTagLevel(tag, level)) {
+        LOG_WARN(TAG, "Usage: loglevel <tag|*> <debug|info|warn|error|none>, at most %u tags",
+                 (unsigned)LOG_MAX_TAG_FILTERS);
+        return;
+    }
+
+    // Reply with the table copy of the tag, the command line is reused
+    const log_tag_filter_t* filter = (strcmp(tag, "*") == 0) ? NULL : Logger_FindFilter(tag);
+    LOG(TAG, "Level of %s set to %s", (filter != NULL) ? filter->tag : "*", levelNames[level]);
+}
+
+// Pointer to blocking print function, used by LOG_DIRECT
 static void (*serialPrint)(uint8_t*, int);
+// Pointer to non-blocking transmit function, completion reported through Logger_TxCpltCallback
+static bool (*serialStartTx)(uint8_t*, uint16_t);
 
 // Hardware print functions
 static void CDC_Print(uint8_t* buff, int len) {
     CDC_Transmit_FS(buff, len);
 }
 
+static bool CDC_StartTx(uint8_t* buff, uint16_t len) {
+    return CDC_Transmit_FS(buff, len) == USBD_OK;
+}
+
 static UART_HandleTypeDef* loggerUart;
 static void UART_Print(uint8_t* buff, int len) {
     HAL_UART_Transmit(loggerUart, buff, len, HAL_MAX_DELAY);
 }
 
+static bool UART_StartTx(uint8_t* buff, uint16_t len) {
+    return HAL_UART_Transmit_DMA(loggerUart, buff, len) == HAL_OK;
+}
+
+// Hands the fill buffer to the serial link if it is idle, then swaps buffers
+static void Logger_Flush(void) {
+    if (txFill == 0 || txBusy)
+        return;
+
+    txLen = txFill;
+    txMsgs = txFillMsgs;
+    txStartTick = osKernelGetTickCount();
+    txBusy = true;
+    if (!serialStartTx(txBuff[fillIdx], txFill)) {
+        // link refused the transfer (e.g. USB not enumerated), the buffer is lost
+        txBusy = false;
+        stats.drops += txFillMsgs;
+    } else {
+        stats.messagesCoalesced += txFillMsgs - 1U;
+        fillIdx ^= 1U;
+    }
+
+    txFill = 0;
+    txFillMsgs = 0;
+}
+
+// Gives up on a buffer in flight for longer than the timeout, its completion is never coming.
+// A completion racing this only miscounts the buffer, both sides just clear txBusy.
+static void Logger_CheckTxTimeout(uint32_t timeoutTicks) {
+    if (txBusy && osKernelGetTickCount() - txStartTick >= timeoutTicks)
+        Logger_TxAbortCallback();
+}
+
+// Blocks until the buffer in flight completes or is abandoned, False on timeout
+static bool Logger_WaitTxDone(uint32_t timeoutTicks) {
+    while (txBusy) {
+        if ((int32_t)osThreadFlagsWait(LOGGER_FLAG_TX_DONE, osFlagsWaitAny, timeoutTicks) < 0) {
+            Logger_CheckTxTimeout(timeoutTicks);
+            return !txBusy;
+        }
+    }
+    return true;
+}
+
+// Expands a record directly into the fill buffer, flushing first if it does not fit
+static void Logger_Format(const log_record_t* rec, uint32_t timeoutTicks) {
+    bool isFrame = rec->msg.format == NULL;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint16_t space = LOG_TX_BUFF_SIZE - txFill;
+        uint8_t* dst = &txBuff[fillIdx][txFill];
+#ifndef LOG_BINARY_OUTPUT
+        bool truncated = true;
+        int len = 0;
+        if (space > 2) {
+            len = isFrame ? Logger_FormatFrame((char*)dst, space, &rec->frame, &truncated)
+                          : Logger_FormatRecord((char*)dst, space, &rec->msg, &truncated);
+        }
+        // a line too long for an empty buffer is sent truncated
+        bool fits = !truncated || txFill == 0;
+#else
+        int len = isFrame ? Logger_EncodeFrame(dst, space, &rec->frame)
+                          : Logger_EncodeRecord(dst, space, &rec->msg);
+        bool fits = len >= 0;
+#endif
+
+        if (fits) {
+            txFill += len;
+            txFillMsgs++;
+            return;
+        }
+
+        // Doesn't fit: wait for the other buffer to free up, then retry in an empty buffer
+        if (!Logger_WaitTxDone(timeoutTicks))
+            break;
+        Logger_Flush();
+    }
+
+    stats.drops++;
+}
+
 bool Logger_Init(log_type_t logType, UART_HandleTypeDef* huart) {
     loggerTaskRunning = false;
     loggerUart = huart;
+    txFill = 0;
+    txFillMsgs = 0;
+    fillIdx = 0;
+    txBusy = false;
+    txMsgs = 0;
+    memset((void*)&stats, 0, sizeof(stats));
+    nTagFilters = 0;
+    defaultLevel = LOG_DEFAULT_LEVEL;
+    Logger_UpdateLevelBounds();
+    rxLen = 0;
+    rxLineReady = false;
 
     // Logging via UART1 before USB CDC is ready
     if (logType == LOGGER_TYPE_UART) {
         serialPrint = UART_Print;
+        serialStartTx = UART_StartTx;
     } else if (logType == LOGGER_TYPE_USBCDC) {
         serialPrint = CDC_Print;
+        serialStartTx = CDC_StartTx;
     }
 
-    // Initialize the message queue
-    queue = osMessageQueueNew(LOG_QUEUE_SIZE, sizeof(log_msg_t), NULL);
-    if (queue == NULL) {
-        LOG_DIRECT(TAG, "Fatal: Error creating log message queue");
-        return false;
-    }
+    // Initialize the record ring
+    LogRing_Init();
 
     return true;
 }
 
-void LOG(const char* tag, const char* format, ...) {
+void Logger_Log(log_level_t level, const char* tag, const char* format, ...) {
+    // Filter before any capture work
+    if (!Logger_LevelEnabled(level, tag))
+        return;
+
     // New message
     log_msg_t msg;
-    msg.timeTicks = osKernelGetTickCount();
+    msg.timestampUs = Timebase_GetUs();
     msg.tag = tag;
+    msg.format = format;
 
-    // Format and fill  message
+    // Capture raw args, formatting happens in LoggerTask
     va_list args;
     va_start(args, format);
-    vsnprintf(msg.msg, LOG_MAX_MSG_LEN, format, args);
+    msg.nWords = Logger_CaptureArgs(format, args, msg.args);
     va_end(args);
 
-    // Push to queue
-    osMessageQueuePut(queue, &msg, 0, 0);
+    // Push only the captured words to the ring, drops are counted there
+    if (!LogRing_Write(&msg, offsetof(log_msg_t, args) + msg.nWords * sizeof(uint32_t)))
+        return;
+
+    // Wake LoggerTask, records written before it starts wait in the ring
+    osThreadId_t thread = loggerThread;
+    if (thread != NULL)
+        osThreadFlagsSet(thread, LOGGER_FLAG_DATA);
+}
+
+bool Logger_LogFrame(const char* tag, uint8_t type, const void* payload, uint8_t len) {
+    if (len > LOG_MAX_FRAME_LEN || !Logger_LevelEnabled(LOG_LEVEL_INFO, tag))
+        return false;
+
+    log_frame_t frame;
+    frame.timestampUs = Timebase_GetUs();
+    frame.tag = tag;
+    frame.format = NULL;
+    frame.type = type;
+    frame.len = len;
+    memcpy(frame.payload, payload, len);
+
+    if (!LogRing_Write(&frame, offsetof(log_frame_t, payload) + len))
+        return false;
+
+    osThreadId_t thread = loggerThread;
+    if (thread != NULL)
+        osThreadFlagsSet(thread, LOGGER_FLAG_DATA);
+    return true;
+}
+
+bool Logger_SetTagLevel(const char* tag, log_level_t level) {
+    if (level > LOG_LEVEL_NONE)
+        return false;
+
+    if (tag == NULL || strcmp(tag, "*") == 0) {
+        defaultLevel = level;
+    } else {
+        log_tag_filter_t* filter = Logger_FindFilter(tag);
+        if (filter != NULL) {
+            filter->level = level;
+        } else {
+            uint8_t n = nTagFilters;
+            if (n >= LOG_MAX_TAG_FILTERS)
+                return false;
+
+            // Fill the entry before publishing it
+            strncpy(tagFilters[n].tag, tag, LOG_MAX_TAG_LEN);
+            tagFilters[n].tag[LOG_MAX_TAG_LEN] = '\0';
+            tagFilters[n].level = level;
+            __DMB();
+            nTagFilters = n + 1U;
+        }
+    }
+
+    Logger_UpdateLevelBounds();
+    return true;
+}
+
+log_level_t Logger_GetTagLevel(const char* tag) {
+    if (tag == NULL || strcmp(tag, "*") == 0)
+        return defaultLevel;
+
+    const log_tag_filter_t* filter = Logger_FindFilter(tag);
+    return (filter != NULL) ? filter->level : defaultLevel;
 }
 
 void LOG_DIRECT(const char* tag, const char* format, ...) {
@@ -74,22 +708,22 @@ void LOG_DIRECT(const char* tag, const char* format, ...) {
     if (loggerTaskRunning)
         return;
 
-    char msg[LOG_TOTAL_MSG_SIZE_DIRECT]; 
+    char msg[LOG_TOTAL_MSG_SIZE_DIRECT];
 
     // Add tag first
     int offset = snprintf(msg, LOG_TOTAL_MSG_SIZE_DIRECT, "[%s] ", tag);
     if (offset < 0 || offset >= LOG_TOTAL_MSG_SIZE_DIRECT)
         offset = 0; // snprintf fail
-    
+
     // Format msg
     va_list args;
     va_start(args, format);
     int msgLen = vsnprintf(msg + offset, LOG_TOTAL_MSG_SIZE_DIRECT - offset - 3, format, args);
     va_end(args);
-    
+
     if (msgLen < 0)
         msgLen = 0; // vsnprintf fail
-    
+
     int totalLen = offset + msgLen;
     msg[totalLen++] = '\r';
     msg[totalLen++] = '\n';
@@ -98,7 +732,80 @@ void LOG_DIRECT(const char* tag, const char* format, ...) {
     serialPrint((uint8_t*)msg, totalLen);
 }
 
+void Logger_RxCallback(const uint8_t* buff, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        // LoggerTask still owns the previous line
+        if (rxLineReady)
+            return;
+
+        char c = (char)buff[i];
+        if (c == '\r' || c == '\n') {
+            if (rxLen == 0)
+                continue;
+            rxLine[rxLen] = '\0';
+            rxLineReady = true;
+            if (loggerThread != NULL)
+                osThreadFlagsSet(loggerThread, LOGGER_FLAG_RX);
+        } else if (rxLen < LOG_MAX_CMD_LEN - 1U) {
+            rxLine[rxLen++] = c;
+        } else {
+            rxLen = 0; // too long for any command, discard
+        }
+    }
+}
+
+uint16_t Logger_Expand(char* dst, uint16_t space, const log_msg_t* msg) {
+    if (space < 3U)
+        return 0;
+
+    bool truncated;
+    return Logger_FormatRecord(dst, space, msg, &truncated);
+}
+
+void Logger_TxCpltCallback(void) {
+    if (!txBusy)
+        return;
+
+    stats.bytesSent += txLen;
+    txBusy = false;
+    osThreadFlagsSet(loggerThread, LOGGER_FLAG_TX_DONE);
+}
+
+void Logger_TxAbortCallback(void) {
+    if (!txBusy)
+        return;
+
+    stats.drops += txMsgs;
+    txBusy = false;
+    if (loggerThread != NULL)
+        osThreadFlagsSet(loggerThread, LOGGER_FLAG_TX_DONE);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {
+    if (huart == loggerUart)
+        Logger_TxCpltCallback();
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {
+    if (huart == loggerUart)
+        Logger_TxAbortCallback();
+}
+
+void Logger_GetStats(log_stats_t* statsBuff) {
+    log_ring_stats_t ringStats;
+    LogRing_GetStats(&ringStats);
+
+    statsBuff->bytesSent = stats.bytesSent;
+    statsBuff->messagesCoalesced = stats.messagesCoalesced;
+    statsBuff->drops = stats.drops;
+    statsBuff->ringDrops = ringStats.drops;
+    statsBuff->ringHighWater = ringStats.highWater;
+    statsBuff->ringUsed = ringStats.used;
+}
+
 void LoggerTask(void *argument) {
+    (void)argument;
+    loggerThread = osThreadGetId();
     loggerTaskRunning = true;
 
     // Initialize USB after RTOS kernel starts
@@ -106,26 +813,28 @@ void LoggerTask(void *argument) {
 
     // Set up timing constants
     uint32_t tickFreq = osKernelGetTickFreq();
-    uint32_t timeoutTicks = 500 * tickFreq / 1000U; // 500ms in ticks timeout
+    uint32_t timeoutTicks = LOGGER_TX_TIMEOUT_MS * tickFreq / 1000U;
 
-    LOG(TAG, "Started Logger queue TX loop");
+    LOG(TAG, "Started Logger ring TX loop");
 
-    log_msg_t msgBuff;
-    char msg[LOG_TOTAL_MSG_SIZE];
+    log_record_t recBuff;
     while (loggerTaskRunning) {
-        // Pop off queue
-        if (osMessageQueueGet(queue, &msgBuff, NULL, timeoutTicks) != osOK) {
-            // timed out
-            continue;
-        }
+        // A filled buffer waits on the one in flight, whose completion wakes the task to flush it.
+        // The timeout bounds that wait when the completion is lost with the link.
+        osThreadFlagsWait(LOGGER_FLAG_DATA | LOGGER_FLAG_RX | LOGGER_FLAG_TX_DONE, osFlagsWaitAny, timeoutTicks);
+        Logger_CheckTxTimeout(timeoutTicks);
 
-        // Get time - truncated to 8 digits (rolls over in 24h)
-        uint32_t timeMs = (msgBuff.timeTicks * 1000U) / tickFreq;
-        timeMs %= 100000000;
+        // Apply a pending command line, then hand the line buffer back to the ISR
+        if (rxLineReady) {
+            Logger_HandleCommand(rxLine);
+            rxLen = 0;
+            rxLineReady = false;
+        }
 
-        // Format string
-        snprintf(msg, LOG_TOTAL_MSG_SIZE, "[%lu] [%s] %s\r\n", timeMs, msgBuff.tag, msgBuff.msg);
+        // Format every committed record
+        while (LogRing_Read(&recBuff, sizeof(recBuff)) > 0)
+            Logger_Format(&recBuff, timeoutTicks);
 
-        serialPrint((uint8_t*)msg, strlen(msg));
+        Logger_Flush();
     }
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+/**
+ * System monitor
+ *
+ * CPU shares come from the FreeRTOS run time counters (Timebase microseconds, see freertos.c),
+ * differenced against the previous sample so every frame covers one period. Stack figures are the
+ * FreeRTOS high-water marks, i.e. the least free stack a task has ever had, which is what stack
+ * sizes in SystemInitializer_Start should be trimmed against.
+ */
+
+#include "SysMonitor.h"
+#include "Logger.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os2.h"
+
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(offsetof(sysmon_frame_t, tasks) + SYSMON_MAX_TASKS * sizeof(sysmon_task_entry_t) <= LOG_MAX_FRAME_LEN,
+               "SYSMON_MAX_TASKS too large for a logger frame");
+
+// Logger tag
+static const char TAG[] = "SYSMON";
+
+// Task snapshots, static to keep them off the monitor stack
+static TaskStatus_t taskStatus[SYSMON_MAX_TASKS];
+static sysmon_frame_t frame;
+
+// Run time counters of the previous sample, by task number
+static UBaseType_t prevTaskNumber[SYSMON_MAX_TASKS];
+static uint32_t prevRunTime[SYSMON_MAX_TASKS];
+static UBaseType_t nPrev;
+static uint32_t prevTotalRunTime;
+
+// Run time a task used since the previous sample, its whole run time if it is new
+static uint32_t SysMonitor_RunTimeDelta(const TaskStatus_t* status) {
+    for (UBaseType_t i = 0; i < nPrev; i++) {
+        if (prevTaskNumber[i] == status->xTaskNumber)
+            return status->ulRunTimeCounter - prevRunTime[i];
+    }
+    return status->ulRunTimeCounter;
+}
+
+// Fills the frame from a fresh snapshot, returns the payload length, 0 if the snapshot failed
+static uint8_t SysMonitor_Sample(void) {
+    uint32_t totalRunTime;
+    UBaseType_t nTasks = uxTaskGetSystemState(taskStatus, SYSMON_MAX_TASKS, &totalRunTime);
+    if (nTasks == 0)
+        return 0; // more tasks than SYSMON_MAX_TASKS
+
+    uint32_t period = totalRunTime - prevTotalRunTime;
+    for (UBaseType_t i = 0; i < nTasks; i++) {
+        const TaskStatus_t* status = &taskStatus[i];
+        sysmon_task_entry_t* entry = &frame.tasks[i];
+
+        strncpy(entry->name, status->pcTaskName, SYSMON_NAME_LEN);
+        entry->priority = (uint8_t)status->uxCurrentPriority;
+        entry->state = (uint8_t)status->eCurrentState;
+        entry->stackFreeBytes = (uint16_t)(status->usStackHighWaterMark * sizeof(StackType_t));
+
+        uint32_t permille = (period > 0) ? (uint32_t)((uint64_t)SysMonitor_RunTimeDelta(status) * 1000U / period) : 0;
+        entry->cpuPermille = (uint16_t)((permille > 1000U) ? 1000U : permille);
+    }
+
+    // Remember this sample for the next period
+    for (UBaseType_t i = 0; i < nTasks; i++) {
+        prevTaskNumber[i] = taskStatus[i].xTaskNumber;
+        prevRunTime[i] = taskStatus[i].ulRunTimeCounter;
+    }
+    nPrev = nTasks;
+    prevTotalRunTime = totalRunTime;
+
+    log_stats_t logStats;
+    Logger_GetStats(&logStats);
+
+    frame.heapFree = (uint32_t)xPortGetFreeHeapSize();
+    frame.heapMinFree = (uint32_t)xPortGetMinimumEverFreeHeapSize();
+    frame.logRingUsed = (uint16_t)logStats.ringUsed;
+    frame.logRingHighWater = (uint16_t)logStats.ringHighWater;
+    frame.logDrops = logStats.ringDrops + logStats.drops;
+    frame.nTasks = (uint8_t)nTasks;
+
+    return (uint8_t)(offsetof(sysmon_frame_t, tasks) + nTasks * sizeof(sysmon_task_entry_t));
+}
+
+void SysMonitorTask(void *argument) {
+    (void)argument;
+
+    uint32_t periodTicks = SYSMON_PERIOD_MS * osKernelGetTickFreq() / 1000U;
+    uint32_t nextWake = osKernelGetTickCount();
+    bool warned = false;
+
+    LOG(TAG, "Started system monitor, %u ms period", (unsigned)SYSMON_PERIOD_MS);
+
+    for (;;) {
+        nextWake += periodTicks;
+        osDelayUntil(nextWake);
+
+        uint8_t len = SysMonitor_Sample();
+        if (len == 0) {
+            if (!warned)
+                LOG_WARN(TAG, "More than %u tasks, raise SYSMON_MAX_TASKS", (unsigned)SYSMON_MAX_TASKS);
+            warned = true;
+            continue;
+        }
+
+        Logger_LogFrame(TAG, LOG_DATA_SYSMON, &frame, len);
+    }
+}
\ No newline at end of file
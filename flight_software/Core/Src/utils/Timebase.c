@@ -0,0 +1,64 @@
+/**
+ * Monotonic microsecond timebase built on the DWT cycle counter
+ *
+ * CYCCNT runs at the core clock and wraps every 2^32 cycles (about 25 s at 168 MHz).
+ * Every read folds the cycles elapsed since the previous read into a 64-bit microsecond
+ * count, carrying the sub-microsecond remainder, so only 32-bit divides are needed.
+ * The fold runs with interrupts masked for a handful of instructions, which makes it
+ * callable from any context. Timebase_Tick guarantees a read between wraps.
+ */
+
+#include "Timebase.h"
+
+#include "stm32f4xx_hal.h"
+
+static uint32_t cyclesPerUs;
+static uint32_t lastCycles;   // counter at the previous fold
+static uint32_t cycleRemain;  // cycles not yet worth a full microsecond
+static uint64_t elapsedUs;
+
+void Timebase_Init(void) {
+    cyclesPerUs = SystemCoreClock / 1000000U;
+
+    // Enable trace and the cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    lastCycles = 0;
+    cycleRemain = 0;
+    elapsedUs = 0;
+}
+
+uint64_t Timebase_GetUs(void) {
+    // The HAL tick starts before Timebase_Init, nothing to fold until the rate is known
+    if (cyclesPerUs == 0U)
+        return 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t now = DWT->CYCCNT;
+    cycleRemain += now - lastCycles;
+    lastCycles = now;
+
+    uint32_t us = cycleRemain / cyclesPerUs;
+    cycleRemain -= us * cyclesPerUs;
+    elapsedUs += us;
+    uint64_t result = elapsedUs;
+
+    __set_PRIMASK(primask);
+    return result;
+}
+
+void Timebase_Tick(void) {
+    (void)Timebase_GetUs();
+}
+
+uint32_t Timebase_GetCycles(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t Timebase_GetCyclesPerUs(void) {
+    return cyclesPerUs;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * Register level model of the BMP388 on the fake SPI bus, lets the real driver run on the host
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @brief Resets the model and attaches it to an SPI handle, chip select on BARO_CS
+ * @param hspi Handle passed to Baro_Init
+ */
+void FakeBmp388_Attach(SPI_HandleTypeDef* hspi);
+
+/**
+ * @brief Reads the register file as the driver left it
+ * @param reg Register address
+ * @returns Last value written or latched
+ */
+uint8_t FakeBmp388_GetReg(uint8_t reg);
+
+/**
+ * @brief Overrides a register, e.g. the chip ID to model a different part
+ * @param reg Register address
+ * @param value Value served from now on
+ */
+void FakeBmp388_SetReg(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Sets the raw conversion results latched at every following data-ready
+ * @param adcP 24-bit raw pressure
+ * @param adcT 24-bit raw temperature
+ */
+void FakeBmp388_SetRaw(uint32_t adcP, uint32_t adcT);
+
+/**
+ * @brief Runs the measurement clock up to a point in time. In normal mode every elapsed ODR
+ *        period latches a measurement, and with data ready enabled raises an edge on BARO_INT
+ *        through HAL_GPIO_EXTI_Callback, exactly like the INT pin on target.
+ * @param nowUs Current time in microseconds
+ */
+void FakeBmp388_Advance(uint64_t nowUs);
\ No newline at end of file
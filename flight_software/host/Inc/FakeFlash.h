@@ -0,0 +1,47 @@
+/**
+ * Emulated calibration sectors behind the fake HAL flash calls, lets CalStore run on the host
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Emulator counters
+ * @param programs Words programmed
+ * @param erases Sector erases, either sector
+ * @param overwrites Programs onto a word that was not erased, AND-ed in like real flash
+ * @param lockViolations Programs or erases while locked or outside the sectors, refused
+ */
+typedef struct {
+    uint32_t programs;
+    uint32_t erases;
+    uint32_t overwrites;
+    uint32_t lockViolations;
+} fake_flash_stats_t;
+
+/**
+ * @brief Erases both sectors and clears the counters, the state of a new board
+ */
+void FakeFlash_Reset(void);
+
+/**
+ * @brief Replaces the sectors with an image saved by FakeFlash_SaveFile, to keep the store across runs
+ * @param path Image file
+ * @returns False if the file is missing or short, the sectors are left erased
+ */
+bool FakeFlash_LoadFile(const char* path);
+
+/**
+ * @brief Writes both sectors to an image file
+ * @param path Image file
+ * @returns False if the file could not be written
+ */
+bool FakeFlash_SaveFile(const char* path);
+
+/**
+ * @brief Copies the emulator counters
+ * @param stats Pointer to a fake_flash_stats_t to fill
+ */
+void FakeFlash_GetStats(fake_flash_stats_t* stats);
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * Register level model of the LIS2MDL on the fake SPI bus, lets the real driver run on the host
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @brief Resets the model and attaches it to an SPI handle, chip select on MAG_CS
+ * @param hspi Handle passed to Mag_Init
+ */
+void FakeLis2mdl_Attach(SPI_HandleTypeDef* hspi);
+
+/**
+ * @brief Reads the register file as the driver left it
+ * @param reg Register address
+ * @returns Last value written or latched
+ */
+uint8_t FakeLis2mdl_GetReg(uint8_t reg);
+
+/**
+ * @brief Overrides a register, e.g. the chip ID to model a different part
+ * @param reg Register address
+ * @param value Value served from now on
+ */
+void FakeLis2mdl_SetReg(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Sets the raw field latched at every following measurement
+ * @param x,y,z Output register values in LSB (1.5 mgauss/LSB)
+ */
+void FakeLis2mdl_SetRaw(int16_t x, int16_t y, int16_t z);
+
+/**
+ * @brief Runs the measurement clock up to a point in time. In continuous mode every elapsed ODR
+ *        period latches a measurement. DRDY is a level that follows the data-ready status when
+ *        routed to the pin, its rising edges call HAL_GPIO_EXTI_Callback(MAG_DRDY_Pin) exactly
+ *        like the pin on target, so a sample left unread holds it high and no further edges come.
+ * @param nowUs Current time in microseconds
+ */
+void FakeLis2mdl_Advance(uint64_t nowUs);
\ No newline at end of file
@@ -0,0 +1,63 @@
+/**
+ * Register level model of the MPU6500 on the fake SPI bus, lets the real driver run on the host
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @brief Resets the model and attaches it to an SPI handle, chip select on PB12
+ * @param hspi Handle passed to Imu_Init
+ */
+void FakeMpu6500_Attach(SPI_HandleTypeDef* hspi);
+
+/**
+ * @brief Sets the raw values served from the data registers
+ * @param accel Accel X, Y, Z in LSB
+ * @param gyro Gyro X, Y, Z in LSB
+ */
+void FakeMpu6500_SetRaw(const int16_t accel[3], const int16_t gyro[3]);
+
+/**
+ * @brief Reads the register file as the driver left it
+ * @param reg Register address
+ * @returns Last value written or served
+ */
+uint8_t FakeMpu6500_GetReg(uint8_t reg);
+
+/**
+ * @brief Overrides a register, e.g. WHO_AM_I to model a different part
+ * @param reg Register address
+ * @param value Value served from now on
+ */
+void FakeMpu6500_SetReg(uint8_t reg, uint8_t value);
+
+/**
+ * @brief Appends one accel and gyro frame to the FIFO, as the sample clock does. A full FIFO
+ *        drops its oldest bytes, so an overflow leaves the frame boundary wherever it falls.
+ * @param accel Accel X, Y, Z in LSB
+ * @param gyro Gyro X, Y, Z in LSB
+ * @returns False if the driver has not enabled the accel and gyro FIFO
+ */
+bool FakeMpu6500_PushFifo(const int16_t accel[3], const int16_t gyro[3]);
+
+/**
+ * @brief Appends raw bytes to the FIFO, e.g. part of a frame the device is still writing
+ * @param data Bytes to append
+ * @param len Number of bytes
+ */
+void FakeMpu6500_PushFifoBytes(const uint8_t* data, uint16_t len);
+
+/**
+ * @brief Gets the number of bytes waiting in the FIFO
+ */
+uint16_t FakeMpu6500_GetFifoCount(void);
+
+/**
+ * @brief Gets the number of register writes clocked above 1MHz since FakeMpu6500_Attach
+ */
+uint32_t FakeMpu6500_GetFastWrites(void);
\ No newline at end of file
@@ -0,0 +1,21 @@
+/**
+ * Host fake of the FreeRTOS base types and heap queries used alongside CMSIS-RTOS2.
+ * The host has no FreeRTOS heap, both queries return 0.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+// Storage for statically allocated tasks, the host threads ignore it
+typedef struct {
+    void* reserved[24];
+} StaticTask_t;
+
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
\ No newline at end of file
@@ -0,0 +1,28 @@
+/**
+ * Simulated IMU for host builds, driven by a synthetic sample clock
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "IMUInterface.h"
+
+/**
+ * @brief Sets the sample returned by every following simulated read
+ * @param sample Accel and gyro values in SI units
+ */
+void ImuSim_SetSample(const imu_sample_t* sample);
+
+/**
+ * @brief Advances the synthetic clock by whole sample periods. Each period raises a
+ *        data-ready edge into the acquisition scheduler, exactly like the INT pin on target.
+ * @param nSamples Number of sample periods to run
+ */
+void ImuSim_Step(uint32_t nSamples);
+
+/**
+ * @brief Gets the synthetic clock
+ * @returns Microseconds of simulated time since Imu_Init
+ */
+uint64_t ImuSim_GetTimeUs(void);
\ No newline at end of file
@@ -0,0 +1,18 @@
+/**
+ * Host stand-in for the CubeMX main.h, carries the board pin labels
+ */
+
+#pragma once
+
+#include "stm32f4xx_hal.h"
+
+#define BARO_CS_Pin GPIO_PIN_4
+#define BARO_CS_GPIO_Port GPIOA
+#define MAG_DRDY_Pin GPIO_PIN_4
+#define MAG_DRDY_GPIO_Port GPIOC
+#define BARO_INT_Pin GPIO_PIN_0
+#define BARO_INT_GPIO_Port GPIOB
+#define IMU_INT_Pin GPIO_PIN_1
+#define IMU_INT_GPIO_Port GPIOB
+#define MAG_CS_Pin GPIO_PIN_15
+#define MAG_CS_GPIO_Port GPIOA
\ No newline at end of file
@@ -0,0 +1,287 @@
+/**
+ * Host fake of the STM32F4 HAL, only the parts the flight modules use
+ *
+ * Peripherals are served by device models attached to their handles. "DMA" and
+ * interrupt driven transfers complete synchronously, the completion callback runs
+ * on the calling thread before the start function returns, unless a test holds SPI
+ * completions back with HalFake_SpiDefer.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+// Barriers map onto full fences, the host has no interrupt mask
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __ISB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* GPIO -----------------------------------------------------------------------*/
+typedef struct {
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+extern GPIO_TypeDef halFakeGpioA;
+extern GPIO_TypeDef halFakeGpioB;
+extern GPIO_TypeDef halFakeGpioC;
+#define GPIOA (&halFakeGpioA)
+#define GPIOB (&halFakeGpioB)
+#define GPIOC (&halFakeGpioC)
+
+#define GPIO_PIN_0  ((uint16_t)0x0001)
+#define GPIO_PIN_1  ((uint16_t)0x0002)
+#define GPIO_PIN_2  ((uint16_t)0x0004)
+#define GPIO_PIN_3  ((uint16_t)0x0008)
+#define GPIO_PIN_4  ((uint16_t)0x0010)
+#define GPIO_PIN_5  ((uint16_t)0x0020)
+#define GPIO_PIN_6  ((uint16_t)0x0040)
+#define GPIO_PIN_7  ((uint16_t)0x0080)
+#define GPIO_PIN_8  ((uint16_t)0x0100)
+#define GPIO_PIN_9  ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+
+/**
+ * @brief Observer of GPIO writes, lets device models follow their chip select
+ */
+typedef void (*hal_fake_gpio_hook_t)(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+#define HAL_FAKE_GPIO_HOOKS 4U
+
+/**
+ * @brief Adds a GPIO write observer, one per device model, adding the same one twice is a no-op
+ * @returns False if every hook slot is taken
+ */
+bool HalFake_AddGpioHook(hal_fake_gpio_hook_t hook);
+
+/**
+ * @brief Drives an input pin from outside, as a device output would. HAL_GPIO_ReadPin sees the
+ *        level, no EXTI callback runs and no hooks are called.
+ */
+void HalFake_GpioDrive(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+/* SPI ------------------------------------------------------------------------*/
+#define SPI_BAUDRATEPRESCALER_2   0x00000000U
+#define SPI_BAUDRATEPRESCALER_4   0x00000008U
+#define SPI_BAUDRATEPRESCALER_8   0x00000010U
+#define SPI_BAUDRATEPRESCALER_16  0x00000018U
+#define SPI_BAUDRATEPRESCALER_32  0x00000020U
+#define SPI_BAUDRATEPRESCALER_64  0x00000028U
+#define SPI_BAUDRATEPRESCALER_128 0x00000030U
+#define SPI_BAUDRATEPRESCALER_256 0x00000038U
+
+typedef struct {
+    uint32_t BaudRatePrescaler;
+} SPI_InitTypeDef;
+
+/**
+ * @brief Device model on an SPI bus, sees every byte clocked while its handle is used
+ * @param transfer Full duplex exchange of len bytes, tx or rx may be NULL
+ */
+typedef struct {
+    HAL_StatusTypeDef (*transfer)(void* ctx, const uint8_t* tx, uint8_t* rx, uint16_t len);
+    void* ctx;
+} hal_fake_spi_device_t;
+
+typedef enum {
+    HAL_FAKE_SPI_NONE = 0,
+    HAL_FAKE_SPI_TXRX,
+    HAL_FAKE_SPI_TX,
+    HAL_FAKE_SPI_RX
+} hal_fake_spi_pending_t;
+
+typedef struct __SPI_HandleTypeDef {
+    SPI_InitTypeDef Init;
+    uint16_t TxXferSize;
+    uint16_t RxXferSize;
+    const hal_fake_spi_device_t* device;
+    bool deferred;
+    hal_fake_spi_pending_t pending;
+} SPI_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, const uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, const uint8_t* pTxData, uint8_t* pRxData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Transmit_IT(SPI_HandleTypeDef* hspi, const uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi);
+
+/**
+ * @brief Holds back the completion callbacks of DMA and interrupt transfers on a handle, so a
+ *        test can look at a driver while its transfer is in flight. The bytes are still
+ *        exchanged when the transfer starts.
+ * @param hspi Handle to defer
+ * @param defer True to defer, False to complete inside the start call again
+ */
+void HalFake_SpiDefer(SPI_HandleTypeDef* hspi, bool defer);
+
+/**
+ * @brief Runs the completion callback of the deferred transfer, as the DMA interrupt would
+ * @param hspi Deferred handle
+ * @returns False if no transfer was pending
+ */
+bool HalFake_SpiComplete(SPI_HandleTypeDef* hspi);
+
+/* I2C ------------------------------------------------------------------------*/
+#define I2C_MEMADD_SIZE_8BIT  0x00000001U
+#define I2C_MEMADD_SIZE_16BIT 0x00000010U
+
+/**
+ * @brief Device models on an I2C bus, addressed with the 8-bit (shifted) device address
+ */
+typedef struct {
+    HAL_StatusTypeDef (*memRead)(void* ctx, uint16_t devAddress, uint16_t memAddress, uint8_t* data, uint16_t len);
+    HAL_StatusTypeDef (*memWrite)(void* ctx, uint16_t devAddress, uint16_t memAddress, const uint8_t* data, uint16_t len);
+    void* ctx;
+} hal_fake_i2c_device_t;
+
+typedef struct __I2C_HandleTypeDef {
+    const hal_fake_i2c_device_t* device;
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, const uint8_t* pData, uint16_t Size);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+/* DMA ------------------------------------------------------------------------*/
+/**
+ * @brief Emulated DMA stream, only the count of items left in the transfer
+ */
+typedef struct __DMA_HandleTypeDef {
+    volatile uint32_t NDTR;
+} DMA_HandleTypeDef;
+
+#define __HAL_DMA_GET_COUNTER(__HANDLE__) ((__HANDLE__)->NDTR)
+
+/* UART -----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t BaudRate;
+} UART_InitTypeDef;
+
+typedef enum {
+    HAL_UART_STATE_RESET = 0x00U,
+    HAL_UART_STATE_READY = 0x20U,
+    HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+/**
+ * @brief UART handles write to a host file descriptor, stdout when left at 0. Reception only
+ *        exists as a circular receive-to-idle DMA on hdmarx, linked by the caller like the
+ *        MSP does on target, and fed by HalFake_UartReceive.
+ */
+typedef struct __UART_HandleTypeDef {
+    int fd;
+    UART_InitTypeDef Init;
+    uint8_t* pRxBuffPtr;
+    uint16_t RxXferSize;
+    DMA_HandleTypeDef* hdmarx;
+    volatile HAL_UART_StateTypeDef RxState;
+} UART_HandleTypeDef;
+
+// Interrupt enables have nothing to act on, lines here never see framing or noise errors
+#define UART_IT_ERR 0x10000001U
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((void)(__HANDLE__), (void)(__INTERRUPT__))
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size);
+
+/**
+ * @brief Bytes arriving on the RX line of a UART, stored by its circular receive DMA. Events
+ *        follow the HAL in circular mode: HAL_UARTEx_RxEventCallback with half the buffer and
+ *        with all of it as the stream passes those points, then with the stream position if
+ *        the line goes idle while it is inside the buffer. Bytes are dropped while no
+ *        reception is running.
+ * @param huart Handle passed to HAL_UARTEx_ReceiveToIdle_DMA
+ * @param data Bytes on the line
+ * @param len Number of bytes
+ * @param idle True if the line goes quiet after the last byte
+ */
+void HalFake_UartReceive(UART_HandleTypeDef* huart, const uint8_t* data, uint32_t len, bool idle);
+
+/* TIM ------------------------------------------------------------------------*/
+typedef struct __TIM_HandleTypeDef {
+    void* Instance;
+} TIM_HandleTypeDef;
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
+
+/* FLASH ----------------------------------------------------------------------*/
+// ART accelerator cache control, the host has no flash cache to flush
+#define __HAL_FLASH_INSTRUCTION_CACHE_DISABLE() ((void)0)
+#define __HAL_FLASH_INSTRUCTION_CACHE_ENABLE()  ((void)0)
+#define __HAL_FLASH_INSTRUCTION_CACHE_RESET()   ((void)0)
+#define __HAL_FLASH_DATA_CACHE_DISABLE()        ((void)0)
+#define __HAL_FLASH_DATA_CACHE_ENABLE()         ((void)0)
+#define __HAL_FLASH_DATA_CACHE_RESET()          ((void)0)
+
+// Programming and erase go to the emulated calibration sectors, see FakeFlash.h
+#define FLASH_TYPEPROGRAM_WORD  0x00000002U
+#define FLASH_TYPEERASE_SECTORS 0x00000000U
+#define FLASH_VOLTAGE_RANGE_3   0x00000002U
+#define FLASH_SECTOR_10         10U
+#define FLASH_SECTOR_11         11U
+
+#define FLASH_FLAG_EOP    0x00000001U
+#define FLASH_FLAG_OPERR  0x00000002U
+#define FLASH_FLAG_WRPERR 0x00000010U
+#define FLASH_FLAG_PGAERR 0x00000020U
+#define FLASH_FLAG_PGPERR 0x00000040U
+#define FLASH_FLAG_PGSERR 0x00000080U
+#define __HAL_FLASH_CLEAR_FLAG(__FLAG__) ((void)(__FLAG__))
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Sector;
+    uint32_t NbSectors;
+    uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+// Address is a host pointer here, uintptr_t keeps the target call sites unchanged
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uintptr_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef* pEraseInit, uint32_t* SectorError);
+
+/* Core -----------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
\ No newline at end of file
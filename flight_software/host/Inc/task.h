@@ -0,0 +1,34 @@
+/**
+ * Host fake of the FreeRTOS task introspection API, backed by the pthreads CMSIS-RTOS2.
+ * Run time is thread CPU time in microseconds; stack high-water marks are not measured
+ * and report the whole stack as free.
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    const char* pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    StackType_t* pxStackBase;
+    uint16_t usStackHighWaterMark;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t* const pulTotalRunTime);
\ No newline at end of file
@@ -0,0 +1,7 @@
+/**
+ * Host fake of the USB device stack
+ */
+
+#pragma once
+
+void MX_USB_DEVICE_Init(void);
\ No newline at end of file
@@ -0,0 +1,13 @@
+/**
+ * Host fake of the USB CDC interface, transmits to stdout
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define USBD_OK   0U
+#define USBD_BUSY 1U
+#define USBD_FAIL 3U
+
+uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
\ No newline at end of file
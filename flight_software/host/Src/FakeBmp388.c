@@ -0,0 +1,177 @@
+/**
+ * Register level model of the BMP388 on the fake SPI bus, lets the real driver run on the host
+ *
+ * Follows the 4-wire SPI protocol (address byte with the read flag, one dummy byte before read
+ * data, register/value pairs on writes) and keeps writes in a register file. Soft reset,
+ * clear-on-read ERR_REG and INT_STATUS, and the ODR measurement clock are modelled, filtering
+ * and the FIFO are not. Calibration is the synthetic set the benchmarks use.
+ */
+
+#include "FakeBmp388.h"
+#include "main.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define REG_CHIP_ID        0x00
+#define REG_ERR            0x02
+#define REG_STATUS         0x03
+#define REG_DATA_BASE      0x04
+#define REG_INT_STATUS     0x11
+#define REG_INT_CTRL       0x19
+#define REG_PWR_CTRL       0x1B
+#define REG_ODR            0x1D
+#define REG_CALIB_BASE     0x31
+#define REG_CMD            0x7E
+#define CHIP_ID_VALUE      0x50
+#define SPI_READ_FLAG      0x80
+
+#define STATUS_CMD_RDY     0x10
+#define STATUS_DRDY        0x60 // pressure and temperature
+#define INT_STATUS_DRDY    0x08
+#define INT_CTRL_DRDY_EN   0x40
+#define PWR_MODE_NORMAL    0x30
+#define ERR_CONF           0x04
+#define ODR_SEL_MAX        17U
+#define CMD_SOFT_RESET     0xB6
+#define ODR_BASE_PERIOD_US 5000U
+
+static const uint8_t calibRaw[] = {
+    0x78, 0x69, 0x38, 0x4A, 0xF9, 0x90, 0x02, 0x50, 0xFB, 0x0C, 0x04,
+    0xA8, 0x61, 0x30, 0x75, 0xF8, 0xF6, 0x80, 0x3E, 0x0A, 0xC4
+};
+
+static uint8_t regs[128];
+static uint32_t rawP;
+static uint32_t rawT;
+static uint64_t nextMeasurementUs;
+
+// Bus state within one chip select frame
+static bool firstByte;
+static bool reading;
+static bool dummyPending;
+static bool expectAddr;
+static uint8_t addr;
+
+static void FakeBmp388_Reset(void) {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_CHIP_ID] = CHIP_ID_VALUE;
+    regs[REG_STATUS] = STATUS_CMD_RDY;
+    memcpy(&regs[REG_CALIB_BASE], calibRaw, sizeof(calibRaw));
+    nextMeasurementUs = 0;
+}
+
+static void FakeBmp388_Write(uint8_t reg, uint8_t value) {
+    switch (reg) {
+    case REG_CMD:
+        if (value == CMD_SOFT_RESET)
+            FakeBmp388_Reset();
+        return;
+    case REG_ODR:
+        if (value > ODR_SEL_MAX) {
+            regs[REG_ERR] |= ERR_CONF;
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    regs[reg] = value;
+}
+
+static uint8_t FakeBmp388_Read(uint8_t reg) {
+    uint8_t value = regs[reg];
+    if (reg == REG_ERR || reg == REG_INT_STATUS)
+        regs[reg] = 0;
+    return value;
+}
+
+static void FakeBmp388_ChipSelect(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    if (port == BARO_CS_GPIO_Port && (pin & BARO_CS_Pin) && state == GPIO_PIN_RESET)
+        firstByte = true;
+}
+
+static HAL_StatusTypeDef FakeBmp388_Transfer(void* ctx, const uint8_t* tx, uint8_t* rx, uint16_t len) {
+    (void)ctx;
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t out = (tx != NULL) ? tx[i] : 0U;
+        uint8_t in = 0;
+        if (firstByte) {
+            addr = out & 0x7FU;
+            reading = (out & SPI_READ_FLAG) != 0U;
+            dummyPending = reading;
+            expectAddr = false;
+            firstByte = false;
+        } else if (dummyPending) {
+            dummyPending = false;
+        } else if (reading) {
+            in = FakeBmp388_Read(addr);
+            addr = (addr + 1U) & 0x7FU;
+        } else if (expectAddr) {
+            addr = out & 0x7FU;
+            expectAddr = false;
+        } else {
+            FakeBmp388_Write(addr, out);
+            expectAddr = true;
+        }
+
+        if (rx != NULL)
+            rx[i] = in;
+    }
+    return HAL_OK;
+}
+
+static const hal_fake_spi_device_t device = {
+    .transfer = FakeBmp388_Transfer,
+    .ctx = NULL
+};
+
+// Latches one conversion into the data registers, LSB first
+static void FakeBmp388_Measure(void) {
+    for (int i = 0; i < 3; i++) {
+        regs[REG_DATA_BASE + i] = (uint8_t)(rawP >> (8 * i));
+        regs[REG_DATA_BASE + 3 + i] = (uint8_t)(rawT >> (8 * i));
+    }
+    regs[REG_STATUS] |= STATUS_DRDY;
+    regs[REG_INT_STATUS] |= INT_STATUS_DRDY;
+}
+
+void FakeBmp388_Attach(SPI_HandleTypeDef* hspi) {
+    FakeBmp388_Reset();
+    rawP = 7140000U; // about 101 kPa and 22 degC with the synthetic calibration
+    rawT = 8150000U;
+    firstByte = true;
+    hspi->device = &device;
+    HalFake_AddGpioHook(FakeBmp388_ChipSelect);
+}
+
+uint8_t FakeBmp388_GetReg(uint8_t reg) {
+    return regs[reg & 0x7FU];
+}
+
+void FakeBmp388_SetReg(uint8_t reg, uint8_t value) {
+    regs[reg & 0x7FU] = value;
+}
+
+void FakeBmp388_SetRaw(uint32_t adcP, uint32_t adcT) {
+    rawP = adcP & 0xFFFFFFU;
+    rawT = adcT & 0xFFFFFFU;
+}
+
+void FakeBmp388_Advance(uint64_t nowUs) {
+    if ((regs[REG_PWR_CTRL] & PWR_MODE_NORMAL) != PWR_MODE_NORMAL) {
+        nextMeasurementUs = 0;
+        return;
+    }
+
+    uint64_t periodUs = (uint64_t)ODR_BASE_PERIOD_US << regs[REG_ODR];
+    if (nextMeasurementUs == 0)
+        nextMeasurementUs = nowUs + periodUs;
+
+    while (nowUs >= nextMeasurementUs) {
+        nextMeasurementUs += periodUs;
+        FakeBmp388_Measure();
+        if (regs[REG_INT_CTRL] & INT_CTRL_DRDY_EN)
+            HAL_GPIO_EXTI_Callback(BARO_INT_Pin);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/**
+ * Emulated calibration sectors behind the fake HAL flash calls
+ *
+ * Provides _scalib, the two sectors the linker script reserves on target, as a host array. Like
+ * the real flash, programming can only clear bits, a whole sector erases to 0xFF, and both are
+ * refused while the controller is locked. Program and erase block for their typical STM32F405
+ * times, so boot measurements on the host show the same cost a compaction has on target.
+ */
+
+#include "FakeFlash.h"
+#include "CalStore.h"
+#include "stm32f4xx_hal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FAKE_FLASH_PROGRAM_NS 16000L // word program, x32 parallelism
+#define FAKE_FLASH_ERASE_MS   1000L  // 128 KB sector
+
+#define FAKE_FLASH_SECTOR_WORDS (CAL_STORE_SIZE / sizeof(uint32_t))
+
+uint32_t _scalib[2U * FAKE_FLASH_SECTOR_WORDS];
+
+static bool unlocked;
+static fake_flash_stats_t stats;
+
+static void FakeFlash_Busy(long ns) {
+    struct timespec ts = { .tv_sec = ns / 1000000000L, .tv_nsec = ns % 1000000000L };
+    nanosleep(&ts, NULL);
+}
+
+void FakeFlash_Reset(void) {
+    memset(_scalib, 0xFF, sizeof(_scalib));
+    memset(&stats, 0, sizeof(stats));
+    unlocked = false;
+}
+
+bool FakeFlash_LoadFile(const char* path) {
+    FakeFlash_Reset();
+    FILE* f = fopen(path, "rb");
+    if (f == NULL)
+        return false;
+
+    size_t n = fread(_scalib, 1, sizeof(_scalib), f);
+    fclose(f);
+    if (n != sizeof(_scalib)) {
+        FakeFlash_Reset();
+        return false;
+    }
+    return true;
+}
+
+bool FakeFlash_SaveFile(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+
+    bool ok = fwrite(_scalib, 1, sizeof(_scalib), f) == sizeof(_scalib);
+    return (fclose(f) == 0) && ok;
+}
+
+void FakeFlash_GetStats(fake_flash_stats_t* statsBuff) {
+    *statsBuff = stats;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    unlocked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    unlocked = false;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uintptr_t Address, uint64_t Data) {
+    uintptr_t base = (uintptr_t)_scalib;
+    if (!unlocked || TypeProgram != FLASH_TYPEPROGRAM_WORD || Address < base ||
+        Address >= base + sizeof(_scalib) || (Address & 3U) != 0U) {
+        stats.lockViolations++;
+        return HAL_ERROR;
+    }
+
+    uint32_t* word = &_scalib[(Address - base) / sizeof(uint32_t)];
+    if (*word != 0xFFFFFFFFU)
+        stats.overwrites++;
+    *word &= (uint32_t)Data;
+    stats.programs++;
+    FakeFlash_Busy(FAKE_FLASH_PROGRAM_NS);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef* pEraseInit, uint32_t* SectorError) {
+    *SectorError = 0xFFFFFFFFU;
+    bool known = pEraseInit->Sector == CAL_STORE_SECTOR0 || pEraseInit->Sector == CAL_STORE_SECTOR1;
+    if (!unlocked || pEraseInit->TypeErase != FLASH_TYPEERASE_SECTORS || !known || pEraseInit->NbSectors != 1U) {
+        stats.lockViolations++;
+        *SectorError = pEraseInit->Sector;
+        return HAL_ERROR;
+    }
+
+    uint32_t first = (pEraseInit->Sector == CAL_STORE_SECTOR0) ? 0U : FAKE_FLASH_SECTOR_WORDS;
+    memset(&_scalib[first], 0xFF, FAKE_FLASH_SECTOR_WORDS * sizeof(uint32_t));
+    stats.erases++;
+    FakeFlash_Busy(FAKE_FLASH_ERASE_MS * 1000000L);
+    return HAL_OK;
+}
\ No newline at end of file
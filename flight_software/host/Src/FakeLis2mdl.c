@@ -0,0 +1,176 @@
+/**
+ * Register level model of the LIS2MDL on the fake SPI bus, lets the real driver run on the host
+ *
+ * Follows the 3-wire SPI protocol (address byte with the read flag, then data with the address
+ * incrementing on both reads and writes) and keeps writes in a register file. Soft reset, the
+ * continuous mode measurement clock, data-ready and overrun status, and the DRDY level are
+ * modelled. With 4WSPI set the data moves to the SDO pin, so reads on the shared line return
+ * an undriven bus. Offset cancellation, filtering and temperature are not modelled.
+ */
+
+#include "FakeLis2mdl.h"
+#include "main.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define REG_WHO_AM_I       0x4F
+#define REG_CFG_A          0x60
+#define REG_CFG_C          0x62
+#define REG_STATUS         0x67
+#define REG_OUTX_L         0x68
+#define REG_OUTZ_H         0x6D
+#define WHO_AM_I_VALUE     0x40
+#define SPI_READ_FLAG      0x80
+
+#define CFG_A_SOFT_RST     0x20
+#define CFG_A_ODR_SHIFT    2U
+#define CFG_A_ODR_MASK     0x0C
+#define CFG_A_MD_MASK      0x03
+#define CFG_A_MD_IDLE      0x03
+#define CFG_C_4WSPI        0x04
+#define CFG_C_DRDY_ON_PIN  0x01
+#define STATUS_ZYXDA       0x08
+#define STATUS_ZYXOR       0x80
+
+static const uint32_t odrPeriodUs[] = {100000U, 50000U, 20000U, 10000U};
+
+static uint8_t regs[128];
+static int16_t rawX;
+static int16_t rawY;
+static int16_t rawZ;
+static uint64_t nextMeasurementUs;
+static bool drdyLevel;
+
+// Bus state within one chip select frame
+static bool firstByte;
+static bool reading;
+static uint8_t addr;
+
+// Follows the level on the DRDY pin, the caller raises the EXTI on a rising edge
+static void FakeLis2mdl_SetDrdy(bool level) {
+    drdyLevel = level;
+    HalFake_GpioDrive(MAG_DRDY_GPIO_Port, MAG_DRDY_Pin, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+static void FakeLis2mdl_Reset(void) {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_WHO_AM_I] = WHO_AM_I_VALUE;
+    regs[REG_CFG_A] = CFG_A_MD_IDLE;
+    nextMeasurementUs = 0;
+    FakeLis2mdl_SetDrdy(false);
+}
+
+static void FakeLis2mdl_Write(uint8_t reg, uint8_t value) {
+    if (reg == REG_CFG_A && (value & CFG_A_SOFT_RST)) {
+        FakeLis2mdl_Reset();
+        return;
+    }
+    if (reg >= REG_CFG_A && reg <= REG_CFG_C)
+        regs[reg] = value;
+    if (reg == REG_CFG_C && !(value & CFG_C_DRDY_ON_PIN))
+        FakeLis2mdl_SetDrdy(false);
+}
+
+static uint8_t FakeLis2mdl_Read(uint8_t reg) {
+    uint8_t value = regs[reg];
+    // Reading the last output releases data-ready and DRDY
+    if (reg == REG_OUTZ_H) {
+        regs[REG_STATUS] = 0;
+        FakeLis2mdl_SetDrdy(false);
+    }
+    return value;
+}
+
+static void FakeLis2mdl_ChipSelect(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    if (port == MAG_CS_GPIO_Port && (pin & MAG_CS_Pin) && state == GPIO_PIN_RESET)
+        firstByte = true;
+}
+
+static HAL_StatusTypeDef FakeLis2mdl_Transfer(void* ctx, const uint8_t* tx, uint8_t* rx, uint16_t len) {
+    (void)ctx;
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t out = (tx != NULL) ? tx[i] : 0U;
+        uint8_t in = 0;
+        if (firstByte) {
+            addr = out & 0x7FU;
+            reading = (out & SPI_READ_FLAG) != 0U;
+            firstByte = false;
+        } else if (reading) {
+            in = FakeLis2mdl_Read(addr);
+            if (regs[REG_CFG_C] & CFG_C_4WSPI)
+                in = 0xFF;
+            addr = (addr + 1U) & 0x7FU;
+        } else {
+            FakeLis2mdl_Write(addr, out);
+            addr = (addr + 1U) & 0x7FU;
+        }
+
+        if (rx != NULL)
+            rx[i] = in;
+    }
+    return HAL_OK;
+}
+
+static const hal_fake_spi_device_t device = {
+    .transfer = FakeLis2mdl_Transfer,
+    .ctx = NULL
+};
+
+// Latches one measurement into the output registers, LSB first
+static void FakeLis2mdl_Measure(void) {
+    const int16_t raw[3] = {rawX, rawY, rawZ};
+    for (int i = 0; i < 3; i++) {
+        regs[REG_OUTX_L + 2 * i] = (uint8_t)((uint16_t)raw[i] & 0xFFU);
+        regs[REG_OUTX_L + 2 * i + 1] = (uint8_t)((uint16_t)raw[i] >> 8);
+    }
+    if (regs[REG_STATUS] & STATUS_ZYXDA)
+        regs[REG_STATUS] |= STATUS_ZYXOR;
+    regs[REG_STATUS] |= STATUS_ZYXDA;
+}
+
+void FakeLis2mdl_Attach(SPI_HandleTypeDef* hspi) {
+    FakeLis2mdl_Reset();
+    rawX = 200; // about 30, -7.5, -42 uT
+    rawY = -50;
+    rawZ = -280;
+    firstByte = true;
+    hspi->device = &device;
+    HalFake_AddGpioHook(FakeLis2mdl_ChipSelect);
+}
+
+uint8_t FakeLis2mdl_GetReg(uint8_t reg) {
+    return regs[reg & 0x7FU];
+}
+
+void FakeLis2mdl_SetReg(uint8_t reg, uint8_t value) {
+    regs[reg & 0x7FU] = value;
+}
+
+void FakeLis2mdl_SetRaw(int16_t x, int16_t y, int16_t z) {
+    rawX = x;
+    rawY = y;
+    rawZ = z;
+}
+
+void FakeLis2mdl_Advance(uint64_t nowUs) {
+    if ((regs[REG_CFG_A] & CFG_A_MD_MASK) != 0U) {
+        nextMeasurementUs = 0;
+        return;
+    }
+
+    uint64_t periodUs = odrPeriodUs[(regs[REG_CFG_A] & CFG_A_ODR_MASK) >> CFG_A_ODR_SHIFT];
+    if (nextMeasurementUs == 0)
+        nextMeasurementUs = nowUs + periodUs;
+
+    while (nowUs >= nextMeasurementUs) {
+        nextMeasurementUs += periodUs;
+        FakeLis2mdl_Measure();
+
+        bool level = (regs[REG_CFG_C] & CFG_C_DRDY_ON_PIN) && (regs[REG_STATUS] & STATUS_ZYXDA);
+        bool rising = level && !drdyLevel;
+        FakeLis2mdl_SetDrdy(level);
+        if (rising)
+            HAL_GPIO_EXTI_Callback(MAG_DRDY_Pin);
+    }
+}
\ No newline at end of file
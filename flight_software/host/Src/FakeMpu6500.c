@@ -0,0 +1,175 @@
+/**
+ * Register level model of the MPU6500 on the fake SPI bus, lets the real driver run on the host
+ *
+ * Follows the SPI protocol (address byte with the read flag, auto-incrementing burst) and
+ * keeps writes in a register file. The 512 byte FIFO is modelled in overwrite mode: frames
+ * pushed by the test while USER_CTRL enables it, FIFO_COUNT, popping through FIFO_R_W and
+ * FIFO_RST. Register writes clocked faster than the 1MHz the part allows are counted.
+ */
+
+#include "FakeMpu6500.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define REG_FIFO_EN      0x23
+#define REG_DATA_BASE    0x3B
+#define REG_GYRO_BASE    0x43
+#define REG_USER_CTRL    0x6A
+#define REG_FIFO_COUNT_H 0x72
+#define REG_FIFO_COUNT_L 0x73
+#define REG_FIFO_R_W     0x74
+#define REG_WHO_AM_I     0x75
+#define WHO_AM_I_VALUE   0x70
+#define SPI_READ_FLAG    0x80
+
+#define USER_CTRL_FIFO_EN  0x40
+#define USER_CTRL_FIFO_RST 0x04
+#define FIFO_EN_ACCEL_GYRO 0x78
+#define FIFO_SIZE          512U
+
+static SPI_HandleTypeDef* bus;
+static uint8_t regs[128];
+static bool firstByte;
+static bool reading;
+static uint8_t addr;
+static uint32_t fastWrites;
+
+// FIFO contents, oldest byte at fifoHead
+static uint8_t fifo[FIFO_SIZE];
+static uint16_t fifoHead;
+static uint16_t fifoCount;
+
+static void FakeMpu6500_FifoPush(uint8_t value) {
+    fifo[(fifoHead + fifoCount) % FIFO_SIZE] = value;
+    if (fifoCount < FIFO_SIZE)
+        fifoCount++;
+    else
+        fifoHead = (fifoHead + 1U) % FIFO_SIZE; // overwrite mode drops the oldest byte
+}
+
+static uint8_t FakeMpu6500_FifoPop(void) {
+    if (fifoCount == 0U)
+        return 0;
+    uint8_t value = fifo[fifoHead];
+    fifoHead = (fifoHead + 1U) % FIFO_SIZE;
+    fifoCount--;
+    return value;
+}
+
+static uint8_t FakeMpu6500_ReadReg(uint8_t reg) {
+    switch (reg) {
+    case REG_FIFO_COUNT_H:
+        return (uint8_t)(fifoCount >> 8);
+    case REG_FIFO_COUNT_L:
+        return (uint8_t)fifoCount;
+    case REG_FIFO_R_W:
+        return FakeMpu6500_FifoPop();
+    default:
+        return regs[reg];
+    }
+}
+
+static void FakeMpu6500_WriteReg(uint8_t reg, uint8_t value) {
+    if (bus != NULL && bus->Init.BaudRatePrescaler < SPI_BAUDRATEPRESCALER_64)
+        fastWrites++;
+
+    // FIFO_RST clears the FIFO and then itself
+    if (reg == REG_USER_CTRL && (value & USER_CTRL_FIFO_RST)) {
+        fifoHead = 0;
+        fifoCount = 0;
+        value &= (uint8_t)~USER_CTRL_FIFO_RST;
+    }
+    regs[reg] = value;
+}
+
+static void FakeMpu6500_ChipSelect(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+    if (port == GPIOB && (pin & GPIO_PIN_12) && state == GPIO_PIN_RESET)
+        firstByte = true;
+}
+
+static HAL_StatusTypeDef FakeMpu6500_Transfer(void* ctx, const uint8_t* tx, uint8_t* rx, uint16_t len) {
+    (void)ctx;
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t out = (tx != NULL) ? tx[i] : 0U;
+        uint8_t in = 0;
+        if (firstByte) {
+            addr = out & 0x7FU;
+            reading = (out & SPI_READ_FLAG) != 0U;
+            firstByte = false;
+        } else if (reading) {
+            in = FakeMpu6500_ReadReg(addr);
+            if (addr != REG_FIFO_R_W)
+                addr = (addr + 1U) & 0x7FU;
+        } else {
+            FakeMpu6500_WriteReg(addr, out);
+            addr = (addr + 1U) & 0x7FU;
+        }
+
+        if (rx != NULL)
+            rx[i] = in;
+    }
+    return HAL_OK;
+}
+
+static const hal_fake_spi_device_t device = {
+    .transfer = FakeMpu6500_Transfer,
+    .ctx = NULL
+};
+
+void FakeMpu6500_Attach(SPI_HandleTypeDef* hspi) {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_WHO_AM_I] = WHO_AM_I_VALUE;
+    firstByte = true;
+    fastWrites = 0;
+    fifoHead = 0;
+    fifoCount = 0;
+    bus = hspi;
+    hspi->device = &device;
+    HalFake_AddGpioHook(FakeMpu6500_ChipSelect);
+}
+
+void FakeMpu6500_SetRaw(const int16_t accel[3], const int16_t gyro[3]) {
+    for (int i = 0; i < 3; i++) {
+        regs[REG_DATA_BASE + 2 * i] = (uint8_t)((uint16_t)accel[i] >> 8);
+        regs[REG_DATA_BASE + 2 * i + 1] = (uint8_t)accel[i];
+        regs[REG_GYRO_BASE + 2 * i] = (uint8_t)((uint16_t)gyro[i] >> 8);
+        regs[REG_GYRO_BASE + 2 * i + 1] = (uint8_t)gyro[i];
+    }
+}
+
+uint8_t FakeMpu6500_GetReg(uint8_t reg) {
+    return regs[reg & 0x7FU];
+}
+
+void FakeMpu6500_SetReg(uint8_t reg, uint8_t value) {
+    regs[reg & 0x7FU] = value;
+}
+
+bool FakeMpu6500_PushFifo(const int16_t accel[3], const int16_t gyro[3]) {
+    if (!(regs[REG_USER_CTRL] & USER_CTRL_FIFO_EN) || regs[REG_FIFO_EN] != FIFO_EN_ACCEL_GYRO)
+        return false;
+
+    for (int i = 0; i < 3; i++) {
+        FakeMpu6500_FifoPush((uint8_t)((uint16_t)accel[i] >> 8));
+        FakeMpu6500_FifoPush((uint8_t)accel[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        FakeMpu6500_FifoPush((uint8_t)((uint16_t)gyro[i] >> 8));
+        FakeMpu6500_FifoPush((uint8_t)gyro[i]);
+    }
+    return true;
+}
+
+void FakeMpu6500_PushFifoBytes(const uint8_t* data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++)
+        FakeMpu6500_FifoPush(data[i]);
+}
+
+uint16_t FakeMpu6500_GetFifoCount(void) {
+    return fifoCount;
+}
+
+uint32_t FakeMpu6500_GetFastWrites(void) {
+    return fastWrites;
+}
\ No newline at end of file
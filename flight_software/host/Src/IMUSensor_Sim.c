@@ -0,0 +1,117 @@
+/**
+ * Implements the IMUInterface for host builds
+ *
+ * Reads complete immediately with a configurable synthetic sample, stamped with the
+ * synthetic clock that ImuSim_Step advances. Data-ready edges go through
+ * AcqScheduler_OnDataReady, so the scheduler and everything it wakes runs unchanged.
+ * FIFO batch mode is not simulated.
+ */
+
+#include "ImuSim.h"
+#include "ImuRing.h"
+#include "AcqScheduler.h"
+
+#include <stddef.h>
+
+static uint32_t samplePeriodUs;
+static uint64_t simTimeUs;
+static bool dataReadyEnabled;
+static bool published;
+static uint32_t seqCounter;
+static imu_sample_t simSample;
+static imu_repo_t latestRepo;
+static imu_sample_callback_t sampleCallback;
+
+bool Imu_Init(SystemHardwareHandles_t hardwareHandles, uint16_t rate) {
+    (void)hardwareHandles;
+    if (rate == 0)
+        return false;
+
+    samplePeriodUs = 1000000U / rate;
+    simTimeUs = 0;
+    dataReadyEnabled = false;
+    published = false;
+    seqCounter = 0;
+    sampleCallback = NULL;
+    ImuRing_Init();
+
+    // Level and at rest
+    simSample = (imu_sample_t){ .az = 9.80665f };
+    return true;
+}
+
+uint32_t Imu_GetSamplePeriodUs(void) {
+    return samplePeriodUs;
+}
+
+// Synthetic samples are already in calibrated body axes
+bool Imu_SetCalibration(const imu_cal_t* cal, const float rotation[9]) {
+    (void)cal;
+    (void)rotation;
+    return true;
+}
+
+bool Imu_StartRead(void) {
+    latestRepo.data = simSample;
+    latestRepo.seq_n = ++seqCounter;
+    latestRepo.timestamp_us = simTimeUs;
+    published = true;
+
+    ImuRing_Publish(&latestRepo);
+    if (sampleCallback != NULL)
+        sampleCallback(&latestRepo);
+    return true;
+}
+
+void Imu_GetSample(imu_sample_t* imuBuff) {
+    *imuBuff = latestRepo.data;
+}
+
+bool Imu_GetRepo(imu_repo_t* repoBuff) {
+    *repoBuff = latestRepo;
+    return published;
+}
+
+bool Imu_SetFifoMode(bool enable) {
+    return !enable;
+}
+
+void Imu_SetBatchCallback(imu_batch_callback_t callback) {
+    (void)callback;
+}
+
+bool Imu_StartFifoDrain(void) {
+    return false;
+}
+
+bool Imu_SetDataReadyInterrupt(bool enable) {
+    dataReadyEnabled = enable;
+    return true;
+}
+
+void Imu_SetSampleCallback(imu_sample_callback_t callback) {
+    sampleCallback = callback;
+}
+
+// Reads complete inside Imu_StartRead, no bus completions to handle
+void Imu_OnTransferComplete(void) {
+}
+
+void Imu_OnTransferError(void) {
+}
+
+void ImuSim_SetSample(const imu_sample_t* sample) {
+    simSample = *sample;
+}
+
+void ImuSim_Step(uint32_t nSamples) {
+    for (uint32_t i = 0; i < nSamples; i++) {
+        simTimeUs += samplePeriodUs;
+        if (dataReadyEnabled)
+            AcqScheduler_OnDataReady(simTimeUs);
+    }
+}
+
+uint64_t ImuSim_GetTimeUs(void) {
+    return simTimeUs;
+}
\ No newline at end of file
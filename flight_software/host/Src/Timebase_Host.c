@@ -0,0 +1,38 @@
+/**
+ * Host implementation of the microsecond timebase, backed by CLOCK_MONOTONIC
+ *
+ * Cycles are nanoseconds on the host so interval code written against
+ * Timebase_GetCycles keeps working unchanged.
+ */
+
+#include "Timebase.h"
+
+#include <time.h>
+
+static uint64_t startNs;
+
+static uint64_t Timebase_NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+void Timebase_Init(void) {
+    startNs = Timebase_NowNs();
+}
+
+uint64_t Timebase_GetUs(void) {
+    return (Timebase_NowNs() - startNs) / 1000U;
+}
+
+void Timebase_Tick(void) {
+    // nothing to extend, the host clock is already 64 bits
+}
+
+uint32_t Timebase_GetCycles(void) {
+    return (uint32_t)(Timebase_NowNs() - startNs);
+}
+
+uint32_t Timebase_GetCyclesPerUs(void) {
+    return 1000U;
+}
\ No newline at end of file
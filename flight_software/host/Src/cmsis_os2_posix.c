@@ -0,0 +1,290 @@
+/**
+ * Host implementation of the CMSIS-RTOS2 subset used by the flight modules, on pthreads
+ *
+ * Threads created before osKernelStart block until it runs, as on target. Unlike on
+ * target, osKernelStart returns so the host main can go on to drive simulated inputs.
+ * Priorities are not enforced, every thread competes under the host scheduler.
+ * Calls from threads the kernel did not create behave like calls from an ISR:
+ * osThreadGetId returns NULL and they must not wait.
+ */
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HOST_TICK_FREQ 1000U
+#define HOST_MAX_THREADS 16U
+
+typedef struct {
+    pthread_t handle;
+    const char* name;
+    osThreadFunc_t func;
+    void* argument;
+    osPriority_t priority;
+    uint32_t stackSize;
+    UBaseType_t number;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t flags;
+} host_thread_t;
+
+static pthread_mutex_t kernelLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t kernelCond = PTHREAD_COND_INITIALIZER;
+static osKernelState_t kernelState = osKernelInactive;
+static struct timespec kernelEpoch;
+static __thread host_thread_t* currentThread;
+
+// Every thread ever created, for uxTaskGetSystemState
+static host_thread_t* threads[HOST_MAX_THREADS];
+static UBaseType_t nThreads;
+
+// Absolute CLOCK_MONOTONIC deadline a number of ticks from now
+static struct timespec HostOs_Deadline(uint32_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * (1000000000U / HOST_TICK_FREQ);
+    ts.tv_sec += (time_t)(ns / 1000000000U);
+    ts.tv_nsec = (long)(ns % 1000000000U);
+    return ts;
+}
+
+static void* HostOs_ThreadEntry(void* arg) {
+    host_thread_t* thread = arg;
+    currentThread = thread;
+
+    // Hold until the kernel starts
+    pthread_mutex_lock(&kernelLock);
+    while (kernelState != osKernelRunning)
+        pthread_cond_wait(&kernelCond, &kernelLock);
+    pthread_mutex_unlock(&kernelLock);
+
+    thread->func(thread->argument);
+    return NULL;
+}
+
+/* Kernel ---------------------------------------------------------------------*/
+osStatus_t osKernelInitialize(void) {
+    pthread_mutex_lock(&kernelLock);
+    clock_gettime(CLOCK_MONOTONIC, &kernelEpoch);
+    kernelState = osKernelReady;
+    pthread_mutex_unlock(&kernelLock);
+    return osOK;
+}
+
+osKernelState_t osKernelGetState(void) {
+    return __atomic_load_n(&kernelState, __ATOMIC_ACQUIRE);
+}
+
+osStatus_t osKernelStart(void) {
+    pthread_mutex_lock(&kernelLock);
+    if (kernelState != osKernelReady) {
+        pthread_mutex_unlock(&kernelLock);
+        return osError;
+    }
+    __atomic_store_n(&kernelState, osKernelRunning, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&kernelCond);
+    pthread_mutex_unlock(&kernelLock);
+    return osOK;
+}
+
+uint32_t osKernelGetTickCount(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ms = (int64_t)(now.tv_sec - kernelEpoch.tv_sec) * 1000 + (now.tv_nsec - kernelEpoch.tv_nsec) / 1000000;
+    return (uint32_t)ms;
+}
+
+uint32_t osKernelGetTickFreq(void) {
+    return HOST_TICK_FREQ;
+}
+
+/* Threads --------------------------------------------------------------------*/
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr) {
+    if (func == NULL)
+        return NULL;
+
+    host_thread_t* thread = calloc(1, sizeof(host_thread_t));
+    if (thread == NULL)
+        return NULL;
+    thread->name = (attr != NULL) ? attr->name : NULL;
+    thread->func = func;
+    thread->argument = argument;
+    thread->priority = (attr != NULL && attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal;
+    thread->stackSize = (attr != NULL) ? attr->stack_size : 0U;
+    pthread_mutex_init(&thread->lock, NULL);
+
+    // Timed flag waits use CLOCK_MONOTONIC deadlines
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&thread->cond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    if (pthread_create(&thread->handle, NULL, HostOs_ThreadEntry, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    pthread_detach(thread->handle);
+
+    pthread_mutex_lock(&kernelLock);
+    thread->number = nThreads + 1U;
+    if (nThreads < HOST_MAX_THREADS)
+        threads[nThreads++] = thread;
+    pthread_mutex_unlock(&kernelLock);
+    return thread;
+}
+
+osThreadId_t osThreadGetId(void) {
+    return currentThread;
+}
+
+const char* osThreadGetName(osThreadId_t thread_id) {
+    return (thread_id != NULL) ? ((host_thread_t*)thread_id)->name : NULL;
+}
+
+osStatus_t osThreadYield(void) {
+    sched_yield();
+    return osOK;
+}
+
+/* Thread flags ---------------------------------------------------------------*/
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags) {
+    host_thread_t* thread = thread_id;
+    if (thread == NULL || (flags & 0x80000000U))
+        return osFlagsErrorParameter;
+
+    pthread_mutex_lock(&thread->lock);
+    thread->flags |= flags;
+    uint32_t result = thread->flags;
+    pthread_cond_broadcast(&thread->cond);
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t osThreadFlagsClear(uint32_t flags) {
+    host_thread_t* thread = currentThread;
+    if (thread == NULL)
+        return osFlagsErrorUnknown;
+
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result = thread->flags;
+    thread->flags &= ~flags;
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t osThreadFlagsGet(void) {
+    host_thread_t* thread = currentThread;
+    if (thread == NULL)
+        return 0;
+
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result = thread->flags;
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    host_thread_t* thread = currentThread;
+    if (thread == NULL)
+        return osFlagsErrorUnknown;
+
+    struct timespec deadline = HostOs_Deadline(timeout);
+    uint32_t result;
+    pthread_mutex_lock(&thread->lock);
+    for (;;) {
+        uint32_t match = thread->flags & flags;
+        bool done = (options & osFlagsWaitAll) ? (match == flags) : (match != 0U);
+        if (done) {
+            result = thread->flags;
+            if (!(options & osFlagsNoClear))
+                thread->flags &= ~flags;
+            break;
+        }
+
+        if (timeout == 0U) {
+            result = osFlagsErrorResource;
+            break;
+        }
+
+        int err = (timeout == osWaitForever)
+            ? pthread_cond_wait(&thread->cond, &thread->lock)
+            : pthread_cond_timedwait(&thread->cond, &thread->lock, &deadline);
+        if (err == ETIMEDOUT) {
+            result = osFlagsErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+/* Delays ---------------------------------------------------------------------*/
+osStatus_t osDelay(uint32_t ticks) {
+    struct timespec deadline = HostOs_Deadline(ticks);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+    return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks) {
+    uint32_t now = osKernelGetTickCount();
+    if ((int32_t)(ticks - now) <= 0)
+        return osErrorParameter;
+    return osDelay(ticks - now);
+}
+
+/* FreeRTOS introspection -----------------------------------------------------*/
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t* const pulTotalRunTime) {
+    pthread_mutex_lock(&kernelLock);
+    UBaseType_t n = nThreads;
+    if (n > uxArraySize) {
+        pthread_mutex_unlock(&kernelLock);
+        return 0;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        host_thread_t* thread = threads[i];
+        TaskStatus_t* status = &pxTaskStatusArray[i];
+
+        // CPU time of the thread stands in for the run time counter
+        clockid_t clock;
+        struct timespec cpu = { 0, 0 };
+        if (pthread_getcpuclockid(thread->handle, &clock) == 0)
+            clock_gettime(clock, &cpu);
+
+        status->xHandle = thread;
+        status->pcTaskName = (thread->name != NULL) ? thread->name : "";
+        status->xTaskNumber = thread->number;
+        status->eCurrentState = (thread == currentThread) ? eRunning : eReady;
+        status->uxCurrentPriority = (UBaseType_t)thread->priority;
+        status->uxBasePriority = (UBaseType_t)thread->priority;
+        status->ulRunTimeCounter = (uint32_t)((uint64_t)cpu.tv_sec * 1000000U + (uint64_t)cpu.tv_nsec / 1000U);
+        status->pxStackBase = NULL;
+        status->usStackHighWaterMark = (uint16_t)(thread->stackSize / sizeof(StackType_t));
+    }
+    pthread_mutex_unlock(&kernelLock);
+
+    if (pulTotalRunTime != NULL) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t us = (int64_t)(now.tv_sec - kernelEpoch.tv_sec) * 1000000 + (now.tv_nsec - kernelEpoch.tv_nsec) / 1000;
+        *pulTotalRunTime = (uint32_t)us;
+    }
+    return n;
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,252 @@
+/**
+ * Host fake of the STM32F4 HAL, only the parts the flight modules use
+ */
+
+#include "stm32f4xx_hal.h"
+#include "usb_device.h"
+#include "usbd_cdc_if.h"
+#include "Timebase.h"
+
+#include <time.h>
+#include <unistd.h>
+
+GPIO_TypeDef halFakeGpioA;
+GPIO_TypeDef halFakeGpioB;
+GPIO_TypeDef halFakeGpioC;
+
+static hal_fake_gpio_hook_t gpioHooks[HAL_FAKE_GPIO_HOOKS];
+
+// Default callbacks, modules override them exactly like on target
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) { (void)GPIO_Pin; }
+__attribute__((weak)) void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi) { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi) { (void)hspi; }
+__attribute__((weak)) void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) { (void)hspi; }
+__attribute__((weak)) void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c) { (void)hi2c; }
+__attribute__((weak)) void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c) { (void)hi2c; }
+__attribute__((weak)) void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) { (void)hi2c; }
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) { (void)huart; }
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) { (void)huart; }
+__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) { (void)huart; (void)Size; }
+__attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) { (void)htim; }
+
+/* GPIO -----------------------------------------------------------------------*/
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    HalFake_GpioDrive(GPIOx, GPIO_Pin, PinState);
+
+    for (uint32_t i = 0; i < HAL_FAKE_GPIO_HOOKS && gpioHooks[i] != NULL; i++)
+        gpioHooks[i](GPIOx, GPIO_Pin, PinState);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+// Outputs read back through IDR like on target, inputs are driven by the device models
+void HalFake_GpioDrive(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->IDR |= GPIO_Pin;
+    else
+        GPIOx->IDR &= ~(uint32_t)GPIO_Pin;
+}
+
+bool HalFake_AddGpioHook(hal_fake_gpio_hook_t hook) {
+    for (uint32_t i = 0; i < HAL_FAKE_GPIO_HOOKS; i++) {
+        if (gpioHooks[i] == hook)
+            return true;
+        if (gpioHooks[i] == NULL) {
+            gpioHooks[i] = hook;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* SPI ------------------------------------------------------------------------*/
+static HAL_StatusTypeDef HalFake_SpiExchange(SPI_HandleTypeDef* hspi, const uint8_t* tx, uint8_t* rx, uint16_t len) {
+    if (hspi == NULL || hspi->device == NULL)
+        return HAL_ERROR;
+    hspi->TxXferSize = len;
+    hspi->RxXferSize = len;
+    return hspi->device->transfer(hspi->device->ctx, tx, rx, len);
+}
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi) {
+    return (hspi != NULL) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, const uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return HalFake_SpiExchange(hspi, pData, NULL, Size);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return HalFake_SpiExchange(hspi, NULL, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, const uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return HalFake_SpiExchange(hspi, pTxData, pRxData, Size);
+}
+
+bool HalFake_SpiComplete(SPI_HandleTypeDef* hspi) {
+    hal_fake_spi_pending_t pending = hspi->pending;
+    hspi->pending = HAL_FAKE_SPI_NONE;
+    if (pending == HAL_FAKE_SPI_TXRX)
+        HAL_SPI_TxRxCpltCallback(hspi);
+    else if (pending == HAL_FAKE_SPI_TX)
+        HAL_SPI_TxCpltCallback(hspi);
+    else if (pending == HAL_FAKE_SPI_RX)
+        HAL_SPI_RxCpltCallback(hspi);
+    return pending != HAL_FAKE_SPI_NONE;
+}
+
+void HalFake_SpiDefer(SPI_HandleTypeDef* hspi, bool defer) {
+    hspi->deferred = defer;
+}
+
+// Starts a DMA or interrupt transfer, completing it now unless the handle is deferred
+static HAL_StatusTypeDef HalFake_SpiStart(SPI_HandleTypeDef* hspi, const uint8_t* tx, uint8_t* rx, uint16_t len, hal_fake_spi_pending_t kind) {
+    if (hspi != NULL && hspi->pending != HAL_FAKE_SPI_NONE)
+        return HAL_BUSY;
+
+    HAL_StatusTypeDef status = HalFake_SpiExchange(hspi, tx, rx, len);
+    if (status != HAL_OK)
+        return status;
+
+    hspi->pending = kind;
+    if (!hspi->deferred)
+        HalFake_SpiComplete(hspi);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, const uint8_t* pTxData, uint8_t* pRxData, uint16_t Size) {
+    return HalFake_SpiStart(hspi, pTxData, pRxData, Size, HAL_FAKE_SPI_TXRX);
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_IT(SPI_HandleTypeDef* hspi, const uint8_t* pData, uint16_t Size) {
+    return HalFake_SpiStart(hspi, pData, NULL, Size, HAL_FAKE_SPI_TX);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size) {
+    return HalFake_SpiStart(hspi, NULL, pData, Size, HAL_FAKE_SPI_RX);
+}
+
+/* I2C ------------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    (void)MemAddSize;
+    (void)Timeout;
+    if (hi2c == NULL || hi2c->device == NULL)
+        return HAL_ERROR;
+    return hi2c->device->memRead(hi2c->device->ctx, DevAddress, MemAddress, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, const uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    (void)MemAddSize;
+    (void)Timeout;
+    if (hi2c == NULL || hi2c->device == NULL)
+        return HAL_ERROR;
+    return hi2c->device->memWrite(hi2c->device->ctx, DevAddress, MemAddress, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size) {
+    HAL_StatusTypeDef status = HAL_I2C_Mem_Read(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, 0);
+    if (status != HAL_OK)
+        return status;
+
+    HAL_I2C_MemRxCpltCallback(hi2c);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, const uint8_t* pData, uint16_t Size) {
+    HAL_StatusTypeDef status = HAL_I2C_Mem_Write(hi2c, DevAddress, MemAddress, MemAddSize, pData, Size, 0);
+    if (status != HAL_OK)
+        return status;
+
+    HAL_I2C_MemTxCpltCallback(hi2c);
+    return HAL_OK;
+}
+
+/* UART -----------------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    int fd = (huart != NULL && huart->fd > 0) ? huart->fd : STDOUT_FILENO;
+    return (write(fd, pData, Size) == (ssize_t)Size) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size) {
+    HAL_StatusTypeDef status = HAL_UART_Transmit(huart, pData, Size, HAL_MAX_DELAY);
+    if (status != HAL_OK)
+        return status;
+
+    HAL_UART_TxCpltCallback(huart);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+    if (huart->RxState == HAL_UART_STATE_BUSY_RX)
+        return HAL_BUSY;
+    if (pData == NULL || Size == 0U || huart->hdmarx == NULL)
+        return HAL_ERROR;
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->hdmarx->NDTR = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef* huart) {
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+void HalFake_UartReceive(UART_HandleTypeDef* huart, const uint8_t* data, uint32_t len, bool idle) {
+    DMA_HandleTypeDef* hdma = huart->hdmarx;
+    for (uint32_t i = 0; i < len && huart->RxState == HAL_UART_STATE_BUSY_RX; i++) {
+        huart->pRxBuffPtr[huart->RxXferSize - hdma->NDTR] = data[i];
+        if (--hdma->NDTR == 0U) {
+            // Circular mode reloads the counter before the transfer complete interrupt
+            hdma->NDTR = huart->RxXferSize;
+            HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize);
+        } else if (hdma->NDTR == huart->RxXferSize / 2U) {
+            HAL_UARTEx_RxEventCallback(huart, huart->RxXferSize / 2U);
+        }
+    }
+
+    // The HAL reports idle only with the counter inside the buffer, not right at a wrap
+    if (idle && huart->RxState == HAL_UART_STATE_BUSY_RX && hdma->NDTR != huart->RxXferSize)
+        HAL_UARTEx_RxEventCallback(huart, (uint16_t)(huart->RxXferSize - hdma->NDTR));
+}
+
+/* USB ------------------------------------------------------------------------*/
+void MX_USB_DEVICE_Init(void) {
+    // nothing to enumerate on the host
+}
+
+__attribute__((weak)) void Logger_TxCpltCallback(void) {
+}
+
+uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len) {
+    if (write(STDOUT_FILENO, Buf, Len) != (ssize_t)Len)
+        return USBD_FAIL;
+
+    // Same completion path as the CDC IN endpoint on target
+    Logger_TxCpltCallback();
+    return USBD_OK;
+}
+
+/* Core -----------------------------------------------------------------------*/
+uint32_t HAL_GetTick(void) {
+    return (uint32_t)(Timebase_GetUs() / 1000U);
+}
+
+void HAL_Delay(uint32_t Delay) {
+    struct timespec ts = { .tv_sec = Delay / 1000U, .tv_nsec = (long)(Delay % 1000U) * 1000000L };
+    nanosleep(&ts, NULL);
+}
\ No newline at end of file
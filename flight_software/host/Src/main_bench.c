@@ -0,0 +1,501 @@
+/**
+ * Host entry point for the microbenchmark suite, runs every kernel once and prints the results.
+ * Cycle counts are Timebase cycles, which are nanoseconds on the host. Approximations are
+ * checked against a double precision reference after the timings: each check prints a METRIC
+ * line with what it measured, a FAIL line for every bound it missed, and any failure makes the
+ * exit status non-zero so ctest catches a regression.
+ *
+ * Usage: fsw_host_bench [iterations] [kernel]
+ */
+
+#include "Bench.h"
+#include "Logger.h"
+#include "Timebase.h"
+#include "BaroAltitude.h"
+#include "MagCalFit.h"
+#include "GyroBias.h"
+#include "DmaRxRing.h"
+#include "Nmea.h"
+
+#include <math.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef FSW_BUILD_REV
+#define FSW_BUILD_REV "unknown"
+#endif
+
+static UART_HandleTypeDef huart1;
+static uint32_t checkFailures;
+
+// Counts a missed bound, named after the check and the condition that failed
+static void Bench_Expect(bool ok, const char* name, const char* cond) {
+    if (ok)
+        return;
+    checkFailures++;
+    printf("FAIL name=%s %s\n", name, cond);
+}
+
+#define BENCH_EXPECT(name, cond) Bench_Expect((cond), (name), #cond)
+
+// Step of the altitude table error sweep, and the worst error allowed, well below baro noise
+#define ALT_SWEEP_STEP_PA 0.5
+#define ALT_MAX_ERR_M     0.01
+
+// Worst error of the altitude table against the hypsometric formula in double over its range
+static void Bench_AltitudeError(void) {
+    double maxErr = 0.0;
+    double maxErrPa = 0.0;
+    BaroAltitude_Init();
+    for (double p = BARO_ALT_P_MIN_PA; p <= BARO_ALT_P_MAX_PA; p += ALT_SWEEP_STEP_PA) {
+        double exact = 288.15 / 0.0065 * (1.0 - pow(p / 101325.0, 8.31447 * 0.0065 / (9.80665 * 0.0289644)));
+        double err = fabs((double)BaroAltitude_FromPressure((float)p) - exact);
+        if (err > maxErr) {
+            maxErr = err;
+            maxErrPa = p;
+        }
+    }
+    printf("METRIC name=altitude_table range_pa=%.0f-%.0f max_err_m=%.6f at_pa=%.1f\n",
+           (double)BARO_ALT_P_MIN_PA, (double)BARO_ALT_P_MAX_PA, maxErr, maxErrPa);
+    BENCH_EXPECT("altitude_table", maxErr <= ALT_MAX_ERR_M);
+}
+
+// Synthetic magnetometer: field, mounting distortion and noise the fit has to undo
+#define MAGCAL_FIELD_UT   48.0
+#define MAGCAL_NOISE_UT   0.3
+#define MAGCAL_FIT_N      2000U
+#define MAGCAL_CHECK_N    10000U
+// Bounds on the fit, the offset well inside the noise and the heading well inside a degree
+#define MAGCAL_MAX_OFFSET_ERR_UT 0.1
+#define MAGCAL_MAX_DIR_ERR_DEG   0.25
+
+static const double magSoftIron[3][3] = {
+    { 1.10,  0.05, -0.03},
+    { 0.05,  0.93,  0.02},
+    {-0.03,  0.02,  1.04}
+};
+static const double magHardIron[3] = {12.0, -7.0, 20.0};
+
+static double Bench_Uniform(void) {
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+// Random unit vector and the reading the distorted sensor gives for the field along it
+static void Bench_MagReading(double u[3], mag_sample_t* raw, double noiseUt) {
+    double z = 2.0 * Bench_Uniform() - 1.0;
+    double phi = 2.0 * M_PI * Bench_Uniform();
+    double r = sqrt(1.0 - z * z);
+    u[0] = r * cos(phi);
+    u[1] = r * sin(phi);
+    u[2] = z;
+
+    double m[3];
+    for (int i = 0; i < 3; i++) {
+        // Sum of uniforms, close enough to Gaussian at this sigma
+        double noise = (Bench_Uniform() + Bench_Uniform() + Bench_Uniform() - 1.5) * 2.0 * noiseUt;
+        m[i] = magHardIron[i] + noise;
+        for (int j = 0; j < 3; j++)
+            m[i] += magSoftIron[i][j] * MAGCAL_FIELD_UT * u[j];
+    }
+    raw->mx = (float)m[0];
+    raw->my = (float)m[1];
+    raw->mz = (float)m[2];
+}
+
+// Fits a known distortion from noisy samples, then checks the offset and the worst direction
+// error of noise-free readings corrected with the result
+static void Bench_MagCalError(void) {
+    mag_cal_fit_t fit;
+    mag_cal_t cal;
+    double u[3];
+    mag_sample_t raw;
+
+    srand(1);
+    MagCalFit_Reset(&fit);
+    for (uint32_t i = 0; i < MAGCAL_FIT_N; i++) {
+        Bench_MagReading(u, &raw, MAGCAL_NOISE_UT);
+        MagCalFit_Add(&fit, &raw);
+    }
+    bool solved = MagCalFit_Solve(&fit, &cal);
+    BENCH_EXPECT("magcal", solved);
+    if (!solved) {
+        printf("METRIC name=magcal solve=failed\n");
+        return;
+    }
+
+    double offsetErr = 0.0;
+    for (int i = 0; i < 3; i++)
+        offsetErr += (cal.offset[i] - magHardIron[i]) * (cal.offset[i] - magHardIron[i]);
+
+    double maxAngle = 0.0;
+    for (uint32_t i = 0; i < MAGCAL_CHECK_N; i++) {
+        mag_sample_t out;
+        Bench_MagReading(u, &raw, 0.0);
+        MagCalFit_Apply(&cal, &raw, &out);
+        double norm = sqrt((double)out.mx * out.mx + (double)out.my * out.my + (double)out.mz * out.mz);
+        double cosAngle = (out.mx * u[0] + out.my * u[1] + out.mz * u[2]) / norm;
+        double angle = acos(fmin(cosAngle, 1.0)) * 180.0 / M_PI;
+        if (angle > maxAngle)
+            maxAngle = angle;
+    }
+    printf("METRIC name=magcal samples=%u noise_ut=%.1f offset_err_ut=%.3f max_dir_err_deg=%.3f field_ut=%.2f residual=%.4f\n",
+           MAGCAL_FIT_N, MAGCAL_NOISE_UT, sqrt(offsetErr), maxAngle, cal.fieldUt, cal.residual);
+    BENCH_EXPECT("magcal", sqrt(offsetErr) <= MAGCAL_MAX_OFFSET_ERR_UT);
+    BENCH_EXPECT("magcal", maxAngle <= MAGCAL_MAX_DIR_ERR_DEG);
+}
+
+// Synthetic drift trace: still at boot, then flights with hover and manoeuvres between stops
+#define GYRO_TRACE_RATE_HZ   1000U
+#define GYRO_TRACE_NOISE     0.0024  // rad/s, MPU6500 at 184 Hz bandwidth
+#define GYRO_TRACE_DRIFT     2e-5    // rad/s per second, warming up
+#define GYRO_TRACE_WALK      1e-4    // rad/s per sqrt(s)
+// Bounds: the bias of every stop well under the noise, every stop found within half a second
+// and, since the ground gate for flash writes rests on it, not one moving sample taken for rest
+#define GYRO_MAX_BIAS_ERR    0.001   // rad/s
+#define GYRO_MAX_DETECT_MS   500.0
+
+typedef enum {
+    TRACE_STILL,
+    TRACE_HOVER,       // small corrections, motor vibration on the accelerometer
+    TRACE_MANOEUVRE
+} gyro_trace_phase_t;
+
+static const struct {
+    gyro_trace_phase_t phase;
+    double seconds;
+} gyroTrace[] = {
+    { TRACE_STILL, 1.0 }, { TRACE_MANOEUVRE, 60.0 }, { TRACE_HOVER, 30.0 }, { TRACE_STILL, 5.0 },
+    { TRACE_MANOEUVRE, 120.0 }, { TRACE_STILL, 3.0 }, { TRACE_HOVER, 240.0 }, { TRACE_STILL, 10.0 },
+};
+
+static double Bench_Gauss(double sigma) {
+    return (Bench_Uniform() + Bench_Uniform() + Bench_Uniform() - 1.5) * 2.0 * sigma;
+}
+
+// Runs the estimator over the trace and checks the bias at the end of every stop, how long each
+// stop took to detect, and that nothing in motion was taken for rest
+static void Bench_GyroBiasError(void) {
+    gyro_bias_t est;
+    GyroBias_Init(&est, NULL, GYRO_BIAS_INIT_VAR);
+    srand(2);
+
+    double bias[3] = { 0.03, -0.02, 0.05 };
+    double t = 0.0;
+    double dt = 1.0 / GYRO_TRACE_RATE_HZ;
+    double bootErr = 0.0;
+    double maxRestErr = 0.0;
+    double maxDetectMs = 0.0;
+    uint32_t falseRest = 0;
+    uint32_t moving = 0;
+    uint64_t timestampUs = 0;
+    for (uint32_t s = 0; s < sizeof(gyroTrace) / sizeof(gyroTrace[0]); s++) {
+        uint32_t n = (uint32_t)(gyroTrace[s].seconds * GYRO_TRACE_RATE_HZ);
+        double detectMs = -1.0;
+        for (uint32_t k = 0; k < n; k++, t += dt) {
+            for (int i = 0; i < 3; i++)
+                bias[i] += GYRO_TRACE_DRIFT * dt + Bench_Gauss(GYRO_TRACE_WALK * sqrt(dt));
+
+            double rate[3] = { 0.0, 0.0, 0.0 };
+            double vibration = 0.0;
+            if (gyroTrace[s].phase == TRACE_HOVER) {
+                rate[0] = 0.05 * sin(2.0 * M_PI * 0.5 * t);
+                rate[1] = 0.05 * sin(2.0 * M_PI * 0.3 * t + 1.0);
+                vibration = 0.5;
+            } else if (gyroTrace[s].phase == TRACE_MANOEUVRE) {
+                rate[0] = 1.5 * sin(2.0 * M_PI * 0.3 * t);
+                rate[1] = 1.0 * sin(2.0 * M_PI * 0.7 * t + 0.5);
+                rate[2] = 0.8 * sin(2.0 * M_PI * 1.1 * t + 2.0);
+                vibration = 2.0;
+            }
+
+            // Tilted, the detector must not rely on the vehicle sitting level
+            imu_sample_t sample = {
+                .ax = (float)(1.2 + Bench_Gauss(0.04 + vibration)),
+                .ay = (float)(-0.8 + Bench_Gauss(0.04 + vibration)),
+                .az = (float)(9.70 + Bench_Gauss(0.04 + vibration)),
+                .gx = (float)(rate[0] + bias[0] + Bench_Gauss(GYRO_TRACE_NOISE)),
+                .gy = (float)(rate[1] + bias[1] + Bench_Gauss(GYRO_TRACE_NOISE)),
+                .gz = (float)(rate[2] + bias[2] + Bench_Gauss(GYRO_TRACE_NOISE)),
+            };
+            timestampUs += 1000000U / GYRO_TRACE_RATE_HZ;
+            bool atRest = GyroBias_Update(&est, &sample, timestampUs);
+
+            if (gyroTrace[s].phase != TRACE_STILL) {
+                moving++;
+                falseRest += atRest;
+            } else if (atRest && detectMs < 0.0) {
+                detectMs = k * 1000.0 / GYRO_TRACE_RATE_HZ;
+            }
+        }
+        if (gyroTrace[s].phase != TRACE_STILL)
+            continue;
+
+        double err = 0.0;
+        for (int i = 0; i < 3; i++)
+            err = fmax(err, fabs(est.bias[i] - bias[i]));
+        if (s == 0)
+            bootErr = err;
+        maxRestErr = fmax(maxRestErr, err);
+        maxDetectMs = fmax(maxDetectMs, (detectMs < 0.0) ? gyroTrace[s].seconds * 1000.0 : detectMs);
+    }
+    printf("METRIC name=gyro_bias duration_s=%.0f noise_rad_s=%.4f boot_err_rad_s=%.5f max_rest_err_rad_s=%.5f max_detect_ms=%.0f false_rest=%u/%u\n",
+           t, GYRO_TRACE_NOISE, bootErr, maxRestErr, maxDetectMs, falseRest, moving);
+    BENCH_EXPECT("gyro_bias", bootErr <= GYRO_MAX_BIAS_ERR);
+    BENCH_EXPECT("gyro_bias", maxRestErr <= GYRO_MAX_BIAS_ERR);
+    BENCH_EXPECT("gyro_bias", maxDetectMs <= GYRO_MAX_DETECT_MS);
+    BENCH_EXPECT("gyro_bias", falseRest == 0U);
+}
+
+// Synthetic NMEA stream through the fake circular receive DMA
+#define GPS_RX_BUFF_SIZE  512U   // smaller than flight so the stream wraps often
+#define GPS_RX_SENTENCES  20000U
+#define GPS_RX_MAX_CHUNK  300U   // bytes per burst
+#define GPS_RX_RECOVERY   10U    // fixes sent after the overrun
+
+static DMA_HandleTypeDef gpsDma;
+static UART_HandleTypeDef gpsUart = { .hdmarx = &gpsDma };
+static uint8_t gpsDmaBuff[GPS_RX_BUFF_SIZE];
+static dma_rx_ring_t gpsRing;
+static nmea_parser_t gpsParser;
+
+// The fixes the stream carries, in order, with the position the text stands for
+typedef struct {
+    gps_fix_t fix;
+    double lat_e7;
+    double lon_e7;
+} gps_expected_t;
+
+static gps_expected_t* gpsExpected;
+static uint32_t gpsExpectedCount;
+static uint32_t gpsNext;
+static uint32_t gpsMismatches;
+static double gpsMaxPosErr;
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {
+    if (huart == &gpsUart)
+        DmaRxRing_OnEvent(&gpsRing, Size);
+}
+
+static uint32_t Bench_GpsDmaPosition(void) {
+    return GPS_RX_BUFF_SIZE - __HAL_DMA_GET_COUNTER(&gpsDma);
+}
+
+static uint32_t Bench_RandRange(uint32_t n) {
+    return (uint32_t)(Bench_Uniform() * n);
+}
+
+static uint32_t Bench_NmeaSentence(char* out, const char* body) {
+    uint8_t checksum = 0;
+    for (const char* c = body; *c != '\0'; c++)
+        checksum ^= (uint8_t)*c;
+    return (uint32_t)sprintf(out, "$%s*%02X\r\n", body, checksum);
+}
+
+// Random GGA, empty position fields without a fix like the receiver sends them
+static uint32_t Bench_GgaSentence(char* out, gps_expected_t* exp) {
+    uint32_t hh = Bench_RandRange(24), mm = Bench_RandRange(60), ss = Bench_RandRange(60), cs = Bench_RandRange(100);
+    uint32_t latDeg = Bench_RandRange(90), latMin = Bench_RandRange(6000000);
+    uint32_t lonDeg = Bench_RandRange(180), lonMin = Bench_RandRange(6000000);
+    bool south = Bench_RandRange(2), west = Bench_RandRange(2);
+    uint32_t quality = Bench_RandRange(3), sats = Bench_RandRange(25), hdop = 50 + Bench_RandRange(950);
+    int32_t altDm = (int32_t)Bench_RandRange(31000) - 1000;
+
+    char pos[48] = ",,,";
+    exp->lat_e7 = 0.0;
+    exp->lon_e7 = 0.0;
+    if (quality != 0) {
+        snprintf(pos, sizeof(pos), "%02u%02u.%05u,%c,%03u%02u.%05u,%c", latDeg, latMin / 100000U, latMin % 100000U, south ? 'S' : 'N',
+                 lonDeg, lonMin / 100000U, lonMin % 100000U, west ? 'W' : 'E');
+        exp->lat_e7 = (latDeg + latMin / 6e6) * 1e7 * (south ? -1.0 : 1.0);
+        exp->lon_e7 = (lonDeg + lonMin / 6e6) * 1e7 * (west ? -1.0 : 1.0);
+    }
+
+    // Sized for the widest values the format allows, not just the ranges drawn above
+    char body[192];
+    snprintf(body, sizeof(body), "%sGGA,%02u%02u%02u.%02u,%s,%u,%02u,%u.%02u,%s%d.%d,M,-30.1,M,,", Bench_RandRange(2) ? "GN" : "GP",
+             hh, mm, ss, cs, pos, quality, sats, hdop / 100U, hdop % 100U, (altDm < 0) ? "-" : "", abs(altDm) / 10, abs(altDm) % 10);
+    exp->fix = (gps_fix_t){
+        .timeOfDayMs = ((hh * 60U + mm) * 60U + ss) * 1000U + cs * 10U,
+        .fixQuality = (uint8_t)quality,
+        .numSats = (uint8_t)sats,
+        .hdop = hdop * 0.01f,
+        .altMsl = altDm * 0.1f,
+    };
+    return Bench_NmeaSentence(out, body);
+}
+
+// Everything else a NEO-8M puts on the line: other sentences, a UBX frame, a sentence hit by a line error
+static uint32_t Bench_OtherTraffic(char* out, uint32_t* corrupted) {
+    switch (Bench_RandRange(3)) {
+    case 0:
+        return Bench_NmeaSentence(out, "GPGSV,3,1,11,05,62,283,44,13,29,048,38,15,45,178,41,18,12,320,30");
+    case 1: {
+        uint32_t len = 8 + Bench_RandRange(60);
+        out[0] = (char)0xB5;
+        out[1] = 0x62;
+        for (uint32_t i = 2; i < len; i++)
+            out[i] = (char)Bench_RandRange(256);
+        return len;
+    }
+    default: {
+        gps_expected_t unused;
+        uint32_t len = Bench_GgaSentence(out, &unused);
+        for (uint32_t i = 8;; i++) {
+            if (out[i] >= '0' && out[i] <= '8') {
+                out[i]++;
+                break;
+            }
+        }
+        (*corrupted)++;
+        return len;
+    }
+    }
+}
+
+// Reads everything waiting, as GpsTask does, and checks each fix against the next expected one
+static void Bench_GpsDrain(void) {
+    uint8_t chunk[128];
+    uint32_t dropped = gpsRing.dropped;
+    for (;;) {
+        uint32_t len = DmaRxRing_Read(&gpsRing, chunk, sizeof(chunk));
+        if (gpsRing.dropped != dropped) {
+            dropped = gpsRing.dropped;
+            Nmea_Reset(&gpsParser);
+        }
+        if (len == 0)
+            return;
+
+        for (uint32_t i = 0; i < len; i++) {
+            gps_fix_t fix;
+            if (!Nmea_Push(&gpsParser, chunk[i]) || !Nmea_ParseGga(gpsParser.line, &fix))
+                continue;
+            if (gpsNext >= gpsExpectedCount) {
+                gpsMismatches++;
+                continue;
+            }
+
+            const gps_expected_t* exp = &gpsExpected[gpsNext++];
+            double posErr = fmax(fabs(fix.lat_e7 - exp->lat_e7), fabs(fix.lon_e7 - exp->lon_e7));
+            gpsMaxPosErr = fmax(gpsMaxPosErr, posErr);
+            if (posErr > 0.5 || fix.timeOfDayMs != exp->fix.timeOfDayMs || fix.fixQuality != exp->fix.fixQuality ||
+                fix.numSats != exp->fix.numSats || fabsf(fix.hdop - exp->fix.hdop) > 1e-4f ||
+                fabsf(fix.altMsl - exp->fix.altMsl) > 1e-3f)
+                gpsMismatches++;
+        }
+    }
+}
+
+// Feeds the stream in bursts of random length, so sentences straddle the wrap at every offset,
+// with the reader running at random but never more than a buffer behind. Then the reader stalls
+// for several buffers, which has to cost only what was overwritten and leave the parser in sync.
+static void Bench_GpsRxError(void) {
+    srand(3);
+    gpsExpected = malloc((GPS_RX_SENTENCES + GPS_RX_RECOVERY) * sizeof(gps_expected_t));
+    char* stream = malloc(GPS_RX_SENTENCES * 128U);
+    bool allocated = (gpsExpected != NULL && stream != NULL);
+    BENCH_EXPECT("gps_rx", allocated);
+    if (!allocated) {
+        printf("METRIC name=gps_rx alloc=failed\n");
+        free(stream);
+        free(gpsExpected);
+        return;
+    }
+
+    uint32_t len = 0;
+    uint32_t corrupted = 0;
+    gpsExpectedCount = 0;
+    for (uint32_t i = 0; i < GPS_RX_SENTENCES; i++) {
+        if (Bench_RandRange(3) == 0)
+            len += Bench_OtherTraffic(&stream[len], &corrupted);
+        else
+            len += Bench_GgaSentence(&stream[len], &gpsExpected[gpsExpectedCount++]);
+    }
+
+    Nmea_Init(&gpsParser);
+    DmaRxRing_Init(&gpsRing, gpsDmaBuff, GPS_RX_BUFF_SIZE, Bench_GpsDmaPosition);
+    HAL_UARTEx_ReceiveToIdle_DMA(&gpsUart, gpsDmaBuff, GPS_RX_BUFF_SIZE);
+    gpsNext = 0;
+    gpsMismatches = 0;
+    gpsMaxPosErr = 0.0;
+
+    uint32_t chunks = 0;
+    for (uint32_t pos = 0; pos < len; chunks++) {
+        uint32_t n = 1 + Bench_RandRange(GPS_RX_MAX_CHUNK);
+        if (n > len - pos)
+            n = len - pos;
+        if (pos - gpsRing.read + n > GPS_RX_BUFF_SIZE || Bench_RandRange(4) == 0)
+            Bench_GpsDrain();
+        HalFake_UartReceive(&gpsUart, (const uint8_t*)&stream[pos], n, Bench_RandRange(2));
+        pos += n;
+    }
+    HalFake_UartReceive(&gpsUart, NULL, 0, true);
+    Bench_GpsDrain();
+    uint32_t fixes = gpsNext;
+    uint32_t expected = gpsExpectedCount;
+    uint32_t events = gpsRing.events;
+    uint32_t dropped = gpsRing.dropped;
+
+    // Stalled reader: three buffers of traffic nobody reads, then fresh fixes
+    HalFake_UartReceive(&gpsUart, (const uint8_t*)stream, 3U * GPS_RX_BUFF_SIZE, false);
+    Bench_GpsDrain();
+    uint32_t overrunDropped = gpsRing.dropped - dropped;
+    gpsNext = gpsExpectedCount;
+    for (uint32_t i = 0; i < GPS_RX_RECOVERY; i++) {
+        char sentence[128];
+        uint32_t n = Bench_GgaSentence(sentence, &gpsExpected[gpsExpectedCount++]);
+        HalFake_UartReceive(&gpsUart, (const uint8_t*)sentence, n, true);
+        Bench_GpsDrain();
+    }
+
+    printf("METRIC name=gps_rx bytes=%u buffer=%u wraps=%u bursts=%u events=%u fixes=%u/%u mismatches=%u max_pos_err_e7=%.2f checksum_errors=%u/%u dropped=%u overrun_dropped=%u recovered=%u/%u\n",
+           len, GPS_RX_BUFF_SIZE, len / GPS_RX_BUFF_SIZE, chunks, events, fixes, expected, gpsMismatches, gpsMaxPosErr,
+           gpsParser.checksumErrors, corrupted, dropped, overrunDropped, gpsNext - expected, GPS_RX_RECOVERY);
+    // Every fix parsed exactly, only the corrupted sentences rejected, nothing lost while the
+    // reader kept up, and the stall dropping bytes without costing any fix after it
+    BENCH_EXPECT("gps_rx", fixes == expected);
+    BENCH_EXPECT("gps_rx", gpsMismatches == 0U);
+    BENCH_EXPECT("gps_rx", gpsParser.checksumErrors == corrupted);
+    BENCH_EXPECT("gps_rx", dropped == 0U);
+    BENCH_EXPECT("gps_rx", overrunDropped > 0U);
+    BENCH_EXPECT("gps_rx", gpsNext - expected == GPS_RX_RECOVERY);
+    free(stream);
+    free(gpsExpected);
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_ITERATIONS;
+    const char* only = (argc > 2) ? argv[2] : NULL;
+
+    Timebase_Init();
+    if (!Logger_Init(LOGGER_TYPE_UART, &huart1))
+        return EXIT_FAILURE;
+
+    uint32_t count;
+    const bench_kernel_t* kernels = Bench_GetKernels(&count);
+    Bench_Calibrate();
+    printf("BENCH rev=%s cycles_per_us=%u kernels=%u\n", FSW_BUILD_REV, Timebase_GetCyclesPerUs(), count);
+
+    for (uint32_t k = 0; k < count; k++) {
+        if (only != NULL && strcmp(only, kernels[k].name) != 0)
+            continue;
+
+        bench_result_t result;
+        char line[BENCH_LINE_LEN];
+        if (!Bench_Run(&kernels[k], iterations, &result))
+            return EXIT_FAILURE;
+        Bench_FormatResult(line, sizeof(line), &result);
+        fputs(line, stdout);
+    }
+
+    if (only == NULL || strcmp(only, "altitude_table") == 0)
+        Bench_AltitudeError();
+    if (only == NULL || strcmp(only, "magcal_solve") == 0)
+        Bench_MagCalError();
+    if (only == NULL || strcmp(only, "gyro_bias") == 0)
+        Bench_GyroBiasError();
+    if (only == NULL || strcmp(only, "gps_rx") == 0)
+        Bench_GpsRxError();
+    return (checkFailures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,279 @@
+/**
+ * Host entry point: boots the flight software against the fake HAL and drives it from the
+ * simulated IMU clock. The barometer and magnetometer are the real drivers on BMP388 and
+ * LIS2MDL register models. The magnetometer model sees a tumbling field behind a hard and soft
+ * iron distortion, so the background calibration has something to fit within a few seconds.
+ * The IMU sits still with a gyro bias that drifts as it warms up, for the online bias estimate.
+ * Once a simulated second the GPS sends a burst of NMEA into the fake UART receive DMA.
+ *
+ * After the run it prints the state of every subsystem and checks it against what the sim fed
+ * in. A FAIL line names each missed check and any failure makes the exit status non-zero.
+ *
+ * Usage: fsw_host_sim [seconds] [--fast] [--cal <image>]
+ * --fast steps the synthetic clock as quickly as the host allows instead of in real time. The
+ *        tasks fall behind the clock then, so the checks only hold in real time.
+ * --cal keeps the emulated calibration sectors in a file, so the next run boots with what this
+ *       one stored. Without it every run starts from erased sectors.
+ */
+
+#include "SystemInitializer.h"
+#include "AcqScheduler.h"
+#include "Attitude.h"
+#include "BaroInterface.h"
+#include "CalStore.h"
+#include "FakeFlash.h"
+#include "FakeBmp388.h"
+#include "FakeLis2mdl.h"
+#include "ImuSim.h"
+#include "Logger.h"
+#include "MagInterface.h"
+#include "GpsInterface.h"
+#include "MagCal.h"
+#include "Timebase.h"
+
+#include "cmsis_os2.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_STEP_US 1000U // wall time per step in real time mode, one IMU period at 1 kHz
+
+static UART_HandleTypeDef huart1;
+static DMA_HandleTypeDef hdma_usart2_rx;
+static UART_HandleTypeDef huart2 = { .Init = { .BaudRate = 115200U }, .hdmarx = &hdma_usart2_rx };
+static SPI_HandleTypeDef hspi1;
+static SPI_HandleTypeDef hspi2;
+static SPI_HandleTypeDef hspi3;
+static uint32_t checkFailures;
+
+// Counts a missed check, named after the subsystem and the condition that failed
+static void Sim_Expect(bool ok, const char* name, const char* cond) {
+    if (ok)
+        return;
+    checkFailures++;
+    printf("FAIL name=%s %s\n", name, cond);
+}
+
+#define SIM_EXPECT(name, cond) Sim_Expect((cond), (name), #cond)
+
+#define SIM_FIELD_UT    48.0f
+#define SIM_MAG_LSB_UT  0.15f
+#define SIM_YAW_RAD_S   6.0f // tumble rates, fast enough to move the field past the calibration spacing
+#define SIM_ROLL_RAD_S  1.7f
+
+// Field in the sensor frame as the vehicle tumbles, distorted the way a mounted sensor sees it
+static void Sim_MagField(uint64_t nowUs) {
+    float t = (float)nowUs * 1e-6f;
+    float yaw = SIM_YAW_RAD_S * t;
+    float roll = SIM_ROLL_RAD_S * t;
+    float x = SIM_FIELD_UT * cosf(yaw) * cosf(roll);
+    float y = SIM_FIELD_UT * sinf(yaw) * cosf(roll);
+    float z = SIM_FIELD_UT * sinf(roll);
+    FakeLis2mdl_SetRaw((int16_t)((1.08f * x + 12.0f) / SIM_MAG_LSB_UT),
+                       (int16_t)((0.95f * y - 7.0f) / SIM_MAG_LSB_UT),
+                       (int16_t)((1.02f * z + 20.0f) / SIM_MAG_LSB_UT));
+}
+
+#define SIM_GYRO_BIAS_X     0.03f
+#define SIM_GYRO_BIAS_Y     -0.02f
+#define SIM_GYRO_BIAS_Z     0.05f
+#define SIM_GYRO_DRIFT      2e-4f // rad/s per second on x
+#define SIM_GYRO_MAX_ERR    0.002f // rad/s, online estimate against the drifting truth
+
+// Level and still, the gyro only shows its bias
+static void Sim_Imu(uint64_t nowUs) {
+    imu_sample_t sample = {
+        .az = 9.80665f,
+        .gx = SIM_GYRO_BIAS_X + SIM_GYRO_DRIFT * (float)nowUs * 1e-6f,
+        .gy = SIM_GYRO_BIAS_Y,
+        .gz = SIM_GYRO_BIAS_Z
+    };
+    ImuSim_SetSample(&sample);
+}
+
+#define SIM_GPS_LAT_E7     374275000  // 37.4275 N
+#define SIM_GPS_LON_E7     -1221697000 // 122.1697 W
+#define SIM_GPS_ALT_M      35.2f
+
+// Appends one sentence with its checksum and CRLF
+static int Sim_NmeaAppend(char* buff, int len, int space, const char* body) {
+    uint8_t checksum = 0;
+    for (const char* c = body; *c != '\0'; c++)
+        checksum ^= (uint8_t)*c;
+    return len + snprintf(buff + len, (size_t)(space - len), "$%s*%02X\r\n", body, checksum);
+}
+
+// NMEA degrees and minutes with the five decimals the NEO-8M sends
+static void Sim_NmeaDegrees(char* buff, size_t space, int32_t e7, int degDigits) {
+    uint32_t mag = (uint32_t)(e7 < 0 ? -(int64_t)e7 : e7);
+    uint32_t minE5 = (uint32_t)(((uint64_t)(mag % 10000000U) * 60U + 50U) / 100U);
+    snprintf(buff, space, "%0*u%02u.%05u", degDigits, mag / 10000000U, minE5 / 100000U, minE5 % 100000U);
+}
+
+// The burst the module sends at the top of every second, GGA first
+static void Sim_Gps(uint64_t nowUs) {
+    uint32_t s = (uint32_t)(nowUs / 1000000U);
+    char lat[16], lon[16], body[96], burst[256];
+    Sim_NmeaDegrees(lat, sizeof(lat), SIM_GPS_LAT_E7, 2);
+    Sim_NmeaDegrees(lon, sizeof(lon), SIM_GPS_LON_E7, 3);
+
+    snprintf(body, sizeof(body), "GNGGA,%02u%02u%02u.00,%s,N,%s,W,1,09,0.92,%.1f,M,-30.1,M,,",
+             12U, s / 60U % 60U, s % 60U, lat, lon, SIM_GPS_ALT_M);
+    int len = Sim_NmeaAppend(burst, 0, sizeof(burst), body);
+    len = Sim_NmeaAppend(burst, len, sizeof(burst), "GNGSA,A,3,05,13,15,18,20,24,29,,,,,,1.61,0.92,1.32");
+    HalFake_UartReceive(&huart2, (const uint8_t*)burst, (uint32_t)len, true);
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = 2;
+    bool fast = false;
+    const char* calImage = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fast") == 0)
+            fast = true;
+        else if (strcmp(argv[i], "--cal") == 0 && i + 1 < argc)
+            calImage = argv[++i];
+        else
+            seconds = (uint32_t)strtoul(argv[i], NULL, 10);
+    }
+
+    if (calImage == NULL || !FakeFlash_LoadFile(calImage))
+        FakeFlash_Reset();
+
+    osKernelInitialize();
+    FakeBmp388_Attach(&hspi1);
+    FakeLis2mdl_Attach(&hspi3);
+
+    SystemHardwareHandles_t hardwareHandles = {
+        .p_huart1 = &huart1,
+        .p_huart2 = &huart2,
+        .p_hspi1 = &hspi1,
+        .p_hspi2 = &hspi2,
+        .p_hspi3 = &hspi3
+    };
+    if (!SystemInitializer_Init(hardwareHandles))
+        return EXIT_FAILURE;
+    uint64_t bootUs = Timebase_GetUs(); // the timebase starts at the top of SystemInitializer_Init
+    SystemInitializer_Start(); // returns on the host once the tasks are released
+
+    // One simulated IMU period per step
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (ImuSim_GetTimeUs() < (uint64_t)seconds * 1000000U) {
+        Sim_Imu(ImuSim_GetTimeUs());
+        if (ImuSim_GetTimeUs() % 1000000U == 0U)
+            Sim_Gps(ImuSim_GetTimeUs());
+        ImuSim_Step(1);
+        FakeBmp388_Advance(ImuSim_GetTimeUs());
+        Sim_MagField(ImuSim_GetTimeUs());
+        FakeLis2mdl_Advance(ImuSim_GetTimeUs());
+        if (fast)
+            continue;
+
+        next.tv_nsec += SIM_STEP_US * 1000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    // Let the tasks drain
+    osDelay(100);
+
+    acq_stats_t acqStats;
+    attitude_stats_t attStats;
+    log_stats_t logStats;
+    attitude_state_t state;
+    baro_repo_t baro;
+    mag_repo_t mag;
+    mag_cal_stats_t calStats;
+    mag_cal_t cal;
+    cal_store_stats_t storeStats;
+    fake_flash_stats_t flashStats;
+    gps_repo_t gps;
+    gps_stats_t gpsStats;
+    AcqScheduler_GetStats(&acqStats);
+    Attitude_GetStats(&attStats);
+    Logger_GetStats(&logStats);
+
+    printf("\nscheduler: %u edges, %u samples, %u overruns\n",
+           acqStats.edges, acqStats.samples, acqStats.overruns);
+    printf("attitude: %u updates, %u missed, max %u ns/update\n",
+           attStats.updates, attStats.missedSamples, attStats.maxCycles);
+    printf("logger: %u bytes, %u drops, %u ring drops, ring high water %u\n",
+           logStats.bytesSent, logStats.drops, logStats.ringDrops, logStats.ringHighWater);
+    SIM_EXPECT("scheduler", acqStats.samples == acqStats.edges && acqStats.overruns == 0U);
+    SIM_EXPECT("attitude", attStats.missedSamples == 0U);
+    SIM_EXPECT("logger", logStats.drops == 0U && logStats.ringDrops == 0U);
+    bool haveState = Attitude_GetLatest(&state);
+    SIM_EXPECT("attitude", haveState);
+    if (haveState) {
+        float trueBias[3] = { SIM_GYRO_BIAS_X + SIM_GYRO_DRIFT * (float)state.timestamp_us * 1e-6f,
+                              SIM_GYRO_BIAS_Y, SIM_GYRO_BIAS_Z };
+        printf("attitude q = [%.4f %.4f %.4f %.4f] at %llu us\n",
+               state.q.w, state.q.x, state.q.y, state.q.z, (unsigned long long)state.timestamp_us);
+        printf("gyro bias = [%.4f %.4f %.4f] rad/s (true [%.4f %.4f %.4f]), %s\n",
+               state.gyroBias[0], state.gyroBias[1], state.gyroBias[2],
+               trueBias[0], trueBias[1], trueBias[2], state.atRest ? "at rest" : "moving");
+        SIM_EXPECT("gyro_bias", state.atRest);
+        for (int i = 0; i < 3; i++)
+            SIM_EXPECT("gyro_bias", fabsf(state.gyroBias[i] - trueBias[i]) <= SIM_GYRO_MAX_ERR);
+    }
+    bool haveBaro = Baro_GetRepo(&baro);
+    SIM_EXPECT("baro", haveBaro);
+    if (haveBaro) {
+        printf("baro: %u samples, p = %.2f Pa, T = %.2f degC\n",
+               baro.seq_n, baro.data.pressure, baro.data.temperature);
+    }
+    MagCal_GetStats(&calStats);
+    printf("magcal: %u samples, %u accepted, %u fits, %u rejected, max %u ns/solve, %u restarts\n",
+           calStats.samples, calStats.accepted, calStats.fits, calStats.rejected, calStats.maxSolveCycles,
+           calStats.restarts);
+    SIM_EXPECT("mag", calStats.restarts == 0U);
+    if (MagCal_Get(&cal)) {
+        printf("magcal offset = [%.2f %.2f %.2f] uT, field %.2f uT, ratio %.3f\n",
+               cal.offset[0], cal.offset[1], cal.offset[2], cal.fieldUt, cal.axisRatio);
+    }
+    CalStore_GetStats(&storeStats);
+    FakeFlash_GetStats(&flashStats);
+    printf("calstore: boot init %llu us, record %u, %u saves, %u failures, %u records, %u bytes used, %u erases\n",
+           (unsigned long long)bootUs, storeStats.sequence, storeStats.saves, storeStats.failures,
+           storeStats.records, storeStats.bytesUsed, storeStats.eraseCount);
+    printf("flash: %u words programmed, %u erases, %u overwrites, %u lock violations\n",
+           flashStats.programs, flashStats.erases, flashStats.overwrites, flashStats.lockViolations);
+    SIM_EXPECT("calstore", storeStats.failures == 0U);
+    // Still from boot, so once the vehicle counts as on the ground the settled gyro bias is stored
+    cal_data_t stored;
+    bool groundedRun = (uint64_t)seconds * 1000000U >= ATTITUDE_GROUND_REST_US + 500000U;
+    SIM_EXPECT("calstore", !groundedRun || (CalStore_Load(&stored) && (stored.valid & CAL_VALID_GYRO)));
+    SIM_EXPECT("flash", flashStats.overwrites == 0U && flashStats.lockViolations == 0U);
+    if (calImage != NULL && !FakeFlash_SaveFile(calImage))
+        printf("error writing %s\n", calImage);
+    bool haveMag = Mag_GetRepo(&mag);
+    SIM_EXPECT("mag", haveMag);
+    if (haveMag) {
+        printf("mag: %u samples, m = [%.2f %.2f %.2f] uT at %llu us\n",
+               mag.seq_n, mag.data.mx, mag.data.my, mag.data.mz, (unsigned long long)mag.timestamp_us);
+    }
+    Gps_GetStats(&gpsStats);
+    printf("gps: %u bytes, %u events, %u sentences, %u checksum errors, %u dropped, %u restarts\n",
+           gpsStats.rxBytes, gpsStats.rxEvents, gpsStats.sentences, gpsStats.checksumErrors,
+           gpsStats.dropped, gpsStats.restarts);
+    SIM_EXPECT("gps", gpsStats.checksumErrors == 0U && gpsStats.dropped == 0U);
+    bool haveGps = Gps_GetRepo(&gps);
+    SIM_EXPECT("gps", haveGps);
+    if (haveGps) {
+        printf("gps: %u fixes, %.7f %.7f, %.1f m, %u sats, hdop %.2f, quality %u at %llu us\n",
+               gps.seq_n, gps.data.lat_e7 * 1e-7, gps.data.lon_e7 * 1e-7, gps.data.altMsl,
+               gps.data.numSats, gps.data.hdop, gps.data.fixQuality, (unsigned long long)gps.timestamp_us);
+        // One burst at the top of every simulated second, each parsed back to the position sent
+        SIM_EXPECT("gps", gps.seq_n == seconds);
+        SIM_EXPECT("gps", gps.data.lat_e7 == SIM_GPS_LAT_E7 && gps.data.lon_e7 == SIM_GPS_LON_E7);
+        SIM_EXPECT("gps", fabsf(gps.data.altMsl - SIM_GPS_ALT_M) < 0.05f && gps.data.fixQuality == 1U);
+    }
+    return (checkFailures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
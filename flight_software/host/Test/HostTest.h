@@ -0,0 +1,67 @@
+/**
+ * Minimal checks for the host unit tests
+ *
+ * A failed check prints where and why and the test carries on, so one run shows every
+ * failure. HostTest_Exit turns the tally into the exit status ctest looks at.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned hostTestChecks;
+static unsigned hostTestFailures;
+
+static inline bool HostTest_Check(bool ok, const char* expr, const char* file, int line, const char* format, ...) {
+    hostTestChecks++;
+    if (ok)
+        return true;
+
+    hostTestFailures++;
+    printf("FAIL %s:%d: %s", file, line, expr);
+    if (format[0] != '\0') {
+        va_list args;
+        va_start(args, format);
+        fputs(", ", stdout);
+        vprintf(format, args);
+        va_end(args);
+    }
+    putchar('\n');
+    return false;
+}
+
+/**
+ * @brief Checks a condition, an optional printf style message explains a failure
+ * @returns The condition, so a test can skip what depends on it
+ */
+#define TEST_CHECK(cond, ...) HostTest_Check((cond), #cond, __FILE__, __LINE__, "" __VA_ARGS__)
+
+/**
+ * @brief Checks that two floating point values agree within an absolute tolerance
+ */
+#define TEST_CHECK_NEAR(a, b, tol)                                                              \
+    HostTest_Check(fabs((double)(a) - (double)(b)) <= (double)(tol), #a " ~ " #b, __FILE__,     \
+                   __LINE__, "%.9g vs %.9g, tolerance %.3g", (double)(a), (double)(b), (double)(tol))
+
+/**
+ * @brief Runs one test function and names it in the output
+ */
+#define TEST_RUN(test)                                                                          \
+    do {                                                                                        \
+        unsigned failuresBefore = hostTestFailures;                                             \
+        test();                                                                                 \
+        printf("%s %s\n", (hostTestFailures == failuresBefore) ? "PASS" : "FAIL", #test);       \
+    } while (0)
+
+/**
+ * @brief Prints the tally
+ * @returns Exit status for main, EXIT_FAILURE if any check failed
+ */
+static inline int HostTest_Exit(void) {
+    printf("%u checks, %u failed\n", hostTestChecks, hostTestFailures);
+    return (hostTestFailures == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+/**
+ * Host tests of the Mahony attitude filter, replaying a fixed synthetic trace
+ *
+ * The trace is a smooth tumble at 1 kHz whose true attitude is integrated exactly in double
+ * precision. The gyro channel is the true body rate plus an optional bias, the accelerometer
+ * channel is gravity rotated into the body frame, so the filter output can be compared with
+ * the truth quaternion sample by sample.
+ */
+
+#include "HostTest.h"
+#include "AttitudeFilter.h"
+
+#include <math.h>
+
+#define GRAVITY       9.80665
+#define TRACE_RATE_HZ 1000U
+#define TRACE_STEP_US (1000000U / TRACE_RATE_HZ)
+#define DEG           (3.14159265358979 / 180.0)
+
+typedef struct {
+    double w, x, y, z;
+} quat_d_t;
+
+// True body rates of the trace in rad/s, smooth and exercising all three axes
+static void Trace_Rates(double t, double w[3]) {
+    w[0] = 0.8 * sin(0.5 * t);
+    w[1] = 0.6 * cos(0.3 * t);
+    w[2] = 0.4 * sin(0.2 * t + 1.0);
+}
+
+// q = q x exp(w dt / 2), exact for a constant rate over the step
+static void Trace_Propagate(quat_d_t* q, const double w[3], double dt) {
+    double rate = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+    double angle = 0.5 * rate * dt;
+    double c = cos(angle);
+    double s = (rate > 0.0) ? sin(angle) / rate : 0.0;
+    double dx = w[0] * s, dy = w[1] * s, dz = w[2] * s;
+
+    quat_d_t p = *q;
+    q->w = p.w * c - p.x * dx - p.y * dy - p.z * dz;
+    q->x = p.x * c + p.w * dx + p.y * dz - p.z * dy;
+    q->y = p.y * c + p.w * dy - p.x * dz + p.z * dx;
+    q->z = p.z * c + p.w * dz + p.x * dy - p.y * dx;
+}
+
+// Attitude from roll and pitch with zero yaw, where the filter levels itself
+static quat_d_t Trace_Tilted(double roll, double pitch) {
+    double cr = cos(roll * 0.5), sr = sin(roll * 0.5);
+    double cp = cos(pitch * 0.5), sp = sin(pitch * 0.5);
+    return (quat_d_t){ cr * cp, sr * cp, cr * sp, -sr * sp };
+}
+
+// Specific force at rest, earth up rotated into the body frame
+static void Trace_Accel(const quat_d_t* q, imu_sample_t* sample) {
+    sample->ax = (float)(GRAVITY * 2.0 * (q->x * q->z - q->w * q->y));
+    sample->ay = (float)(GRAVITY * 2.0 * (q->w * q->x + q->y * q->z));
+    sample->az = (float)(GRAVITY * (q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z));
+}
+
+// Rotation angle between two attitudes in rad, from the error quaternion conj(truth) x est.
+// atan2 keeps the resolution near zero that acos of the dot product loses to float rounding.
+static double Quat_Angle(const quat_t* est, const quat_d_t* truth) {
+    double w = truth->w * est->w + truth->x * est->x + truth->y * est->y + truth->z * est->z;
+    double x = truth->w * est->x - truth->x * est->w - truth->y * est->z + truth->z * est->y;
+    double y = truth->w * est->y + truth->x * est->z - truth->y * est->w - truth->z * est->x;
+    double z = truth->w * est->z - truth->x * est->y + truth->y * est->x - truth->z * est->w;
+    return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+// Tilt error in rad, the angle between the estimated and the true gravity directions
+static double Quat_TiltError(const quat_t* est, const quat_d_t* truth) {
+    double ex = 2.0 * (est->x * est->z - est->w * est->y);
+    double ey = 2.0 * (est->w * est->x + est->y * est->z);
+    double ez = est->w * est->w - est->x * est->x - est->y * est->y + est->z * est->z;
+    double tx = 2.0 * (truth->x * truth->z - truth->w * truth->y);
+    double ty = 2.0 * (truth->w * truth->x + truth->y * truth->z);
+    double tz = truth->w * truth->w - truth->x * truth->x - truth->y * truth->y + truth->z * truth->z;
+    double cx = ey * tz - ez * ty;
+    double cy = ez * tx - ex * tz;
+    double cz = ex * ty - ey * tx;
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), ex * tx + ey * ty + ez * tz);
+}
+
+/**
+ * Replays the trace through a filter
+ * @param seconds Trace length
+ * @param bias Gyro bias added to the true rates
+ * @param settleSeconds Time excluded from the error maxima while the filter converges
+ * @param maxAngle,maxTilt Filled with the largest errors after settling, rad
+ */
+static void Trace_Replay(attitude_filter_t* filter, double seconds, const double bias[3],
+                         double settleSeconds, double* maxAngle, double* maxTilt) {
+    const double dt = 1.0 / TRACE_RATE_HZ;
+    // Tilted start, the filter levels itself from the first sample
+    quat_d_t truth = Trace_Tilted(0.3, -0.25);
+    uint64_t timeUs = 1000000U;
+    imu_sample_t sample;
+
+    *maxAngle = 0.0;
+    *maxTilt = 0.0;
+    uint32_t steps = (uint32_t)(seconds * TRACE_RATE_HZ);
+    for (uint32_t i = 0; i <= steps; i++) {
+        double t = i * dt;
+        double w[3];
+        Trace_Rates(t, w);
+
+        // A sample carries the rate over the step that ends at its timestamp
+        if (i > 0)
+            Trace_Propagate(&truth, w, dt);
+        Trace_Accel(&truth, &sample);
+        sample.gx = (float)(w[0] + bias[0]);
+        sample.gy = (float)(w[1] + bias[1]);
+        sample.gz = (float)(w[2] + bias[2]);
+        AttitudeFilter_Update(filter, &sample, timeUs);
+
+        if (t >= settleSeconds) {
+            double angle = Quat_Angle(&filter->q, &truth);
+            double tilt = Quat_TiltError(&filter->q, &truth);
+            if (angle > *maxAngle)
+                *maxAngle = angle;
+            if (tilt > *maxTilt)
+                *maxTilt = tilt;
+        }
+        timeUs += TRACE_STEP_US;
+    }
+}
+
+static void Test_LevelsFromFirstSample(void) {
+    attitude_filter_t filter;
+    quat_d_t truth = Trace_Tilted(-0.7, 0.4);
+    imu_sample_t sample = { 0 };
+    Trace_Accel(&truth, &sample);
+
+    AttitudeFilter_Init(&filter, 1.0f, 0.05f);
+    AttitudeFilter_Update(&filter, &sample, 5000);
+    TEST_CHECK(filter.initialized);
+    TEST_CHECK(Quat_Angle(&filter.q, &truth) < 1e-5, "attitude error %.3g rad", Quat_Angle(&filter.q, &truth));
+
+    float roll, pitch, yaw;
+    AttitudeFilter_ToEuler(&filter.q, &roll, &pitch, &yaw);
+    TEST_CHECK_NEAR(yaw, 0.0f, 1e-6); // yaw is unobservable from gravity, it starts at zero
+}
+
+// Exact gyro, the filter must follow the tumble. What error there is comes from rounding the
+// single precision quaternion every step, the gravity correction holds it near 0.05 deg.
+static void Test_TraceTracksTruth(void) {
+    attitude_filter_t filter;
+    const double bias[3] = { 0.0, 0.0, 0.0 };
+    double maxAngle, maxTilt;
+
+    AttitudeFilter_Init(&filter, 1.0f, 0.05f);
+    Trace_Replay(&filter, 30.0, bias, 0.0, &maxAngle, &maxTilt);
+    TEST_CHECK(maxAngle < 0.1 * DEG, "max attitude error %.4f deg", maxAngle / DEG);
+    TEST_CHECK(maxTilt < 0.1 * DEG, "max tilt error %.4f deg", maxTilt / DEG);
+
+    float n = filter.q.w * filter.q.w + filter.q.x * filter.q.x + filter.q.y * filter.q.y + filter.q.z * filter.q.z;
+    TEST_CHECK_NEAR(n, 1.0f, 1e-5);
+}
+
+// A constant gyro bias, the integral term has to absorb it and hold the tilt
+static void Test_TraceRejectsBias(void) {
+    attitude_filter_t filter;
+    const double bias[3] = { 0.02, -0.015, 0.01 };
+    double maxAngle, maxTilt;
+
+    AttitudeFilter_Init(&filter, 1.0f, 0.05f);
+    Trace_Replay(&filter, 120.0, bias, 60.0, &maxAngle, &maxTilt);
+    TEST_CHECK(maxTilt < 0.4 * DEG, "max tilt error after settling %.4f deg", maxTilt / DEG);
+
+    // Gravity only sees the bias components off the vertical, the tumble rotates all of them through it
+    TEST_CHECK_NEAR(filter.integral[0], -bias[0], 1e-3);
+    TEST_CHECK_NEAR(filter.integral[1], -bias[1], 1e-3);
+    TEST_CHECK_NEAR(filter.integral[2], -bias[2], 1e-3);
+
+    // Without the integral term the same bias leaves a standing tilt error
+    AttitudeFilter_Init(&filter, 1.0f, 0.0f);
+    Trace_Replay(&filter, 120.0, bias, 60.0, &maxAngle, &maxTilt);
+    TEST_CHECK(maxTilt > 1.0 * DEG, "proportional only tilt error %.4f deg", maxTilt / DEG);
+}
+
+// Outside 0.8 g to 1.2 g the accelerometer is ignored and the gyro integrates alone
+static void Test_AccelGate(void) {
+    attitude_filter_t filter;
+    imu_sample_t sample = { .az = (float)GRAVITY };
+
+    AttitudeFilter_Init(&filter, 1.0f, 0.05f);
+    AttitudeFilter_Update(&filter, &sample, 1000);
+
+    // 1.5 g pointing along x would pull a corrected filter towards 90 degrees of pitch
+    sample = (imu_sample_t){ .ax = (float)(1.5 * GRAVITY) };
+    for (uint32_t i = 1; i <= 1000U; i++)
+        AttitudeFilter_Update(&filter, &sample, 1000U + i * TRACE_STEP_US);
+    TEST_CHECK_NEAR(filter.q.w, 1.0f, 1e-6);
+    TEST_CHECK_NEAR(filter.integral[1], 0.0f, 1e-9);
+
+    // Inside the gate the same direction does pull it
+    sample = (imu_sample_t){ .ax = (float)GRAVITY };
+    for (uint32_t i = 1001; i <= 1100U; i++)
+        AttitudeFilter_Update(&filter, &sample, 1000U + i * TRACE_STEP_US);
+    TEST_CHECK(filter.q.w < 0.9999f, "w %.7f", filter.q.w);
+}
+
+// Out of order samples and long gaps only move the time reference
+static void Test_TimeReanchor(void) {
+    attitude_filter_t filter;
+    imu_sample_t sample = { .az = (float)GRAVITY };
+
+    AttitudeFilter_Init(&filter, 1.0f, 0.05f);
+    AttitudeFilter_Update(&filter, &sample, 10000);
+
+    sample.gz = 1.0f;
+    quat_t before = filter.q;
+    AttitudeFilter_Update(&filter, &sample, 10000);
+    AttitudeFilter_Update(&filter, &sample, 9000);
+    TEST_CHECK(filter.q.z == before.z, "z moved on a non-increasing timestamp");
+
+    AttitudeFilter_Update(&filter, &sample, 9000U + 200000U);
+    TEST_CHECK(filter.q.z == before.z, "z moved across a 200 ms gap");
+    TEST_CHECK(filter.lastTimestampUs == 9000U + 200000U);
+
+    // The next regular step integrates 1 ms of 1 rad/s yaw from the new anchor
+    AttitudeFilter_Update(&filter, &sample, 9000U + 201000U);
+    TEST_CHECK_NEAR(2.0 * atan2(filter.q.z, filter.q.w), 0.001, 1e-6);
+}
+
+int main(void) {
+    TEST_RUN(Test_LevelsFromFirstSample);
+    TEST_RUN(Test_TraceTracksTruth);
+    TEST_RUN(Test_TraceRejectsBias);
+    TEST_RUN(Test_AccelGate);
+    TEST_RUN(Test_TimeReanchor);
+    return HostTest_Exit();
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/**
+ * Host tests of the BMP280 and BMP388 compensation
+ *
+ * The integer paths are held to the datasheet example and, over a grid of raw readings, to the
+ * datasheet double precision formulas within their output resolution. The float paths are held
+ * to the same double references and to the integer paths.
+ */
+
+#include "HostTest.h"
+#include "BaroCompensation.h"
+
+#include <string.h>
+
+// Datasheet 3.11.3 example trimming, little endian as read from BMP280_CALIB_REG
+static const uint8_t bmp280CalibRaw[BMP280_CALIB_LEN] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17
+};
+static const bmp280_calib_t bmp280Calib = { 27504U, 26435, -1000, 36477U, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+
+// Synthetic BMP388 calibration registers in the range of real parts, as in the bench suite
+static const uint8_t bmp388CalibRaw[BMP388_CALIB_LEN] = {
+    0x78, 0x69, 0x38, 0x4A, 0xF9, 0x90, 0x02, 0x50, 0xFB, 0x0C, 0x04,
+    0xA8, 0x61, 0x30, 0x75, 0xF8, 0xF6, 0x80, 0x3E, 0x0A, 0xC4
+};
+
+// Datasheet 8.1 double precision temperature, tFine truncated as the datasheet does
+static double Ref280_Temp(const bmp280_calib_t* c, int32_t adcT, double* tFine) {
+    double var1 = (adcT / 16384.0 - c->T1 / 1024.0) * c->T2;
+    double var2 = (adcT / 131072.0 - c->T1 / 8192.0) * (adcT / 131072.0 - c->T1 / 8192.0) * c->T3;
+    *tFine = (int32_t)(var1 + var2);
+    return (var1 + var2) / 5120.0;
+}
+
+// Datasheet 8.1 double precision pressure in Pa
+static double Ref280_Pressure(const bmp280_calib_t* c, int32_t adcP, double tFine) {
+    double var1 = tFine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * c->P6 / 32768.0;
+    var2 = var2 + var1 * c->P5 * 2.0;
+    var2 = var2 / 4.0 + c->P4 * 65536.0;
+    var1 = (c->P3 * var1 * var1 / 524288.0 + c->P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * c->P1;
+    if (var1 == 0.0)
+        return 0.0;
+    double p = 1048576.0 - adcP;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = c->P9 * p * p / 2147483648.0;
+    var2 = p * c->P8 / 32768.0;
+    return p + (var1 + var2 + c->P7) / 16.0;
+}
+
+// Datasheet 9.2 temperature with double coefficients
+static double Ref388_Temp(const bmp388_calib_t* c, uint32_t adcT) {
+    double pd1 = adcT - c->T1 * 256.0;
+    return pd1 * (c->T2 / 1073741824.0) + pd1 * pd1 * (c->T3 / 281474976710656.0);
+}
+
+// Datasheet 9.3 pressure in Pa with double coefficients
+static double Ref388_Pressure(const bmp388_calib_t* c, uint32_t adcP, double t) {
+    double p1 = (c->P1 - 16384.0) / 1048576.0;
+    double p2 = (c->P2 - 16384.0) / 536870912.0;
+    double p3 = c->P3 / 4294967296.0;
+    double p4 = c->P4 / 137438953472.0;
+    double p5 = c->P5 * 8.0;
+    double p6 = c->P6 / 64.0;
+    double p7 = c->P7 / 256.0;
+    double p8 = c->P8 / 32768.0;
+    double p9 = c->P9 / 281474976710656.0;
+    double p10 = c->P10 / 281474976710656.0;
+    double p11 = c->P11 / 36893488147419103232.0;
+    double up = adcP;
+
+    double out1 = p5 + p6 * t + p7 * t * t + p8 * t * t * t;
+    double out2 = up * (p1 + p2 * t + p3 * t * t + p4 * t * t * t);
+    double out3 = up * up * (p9 + p10 * t) + up * up * up * p11;
+    return out1 + out2 + out3;
+}
+
+static void Test_Bmp280ParseCalib(void) {
+    bmp280_calib_t calib;
+    Bmp280_ParseCalib(bmp280CalibRaw, &calib);
+    TEST_CHECK(memcmp(&calib, &bmp280Calib, sizeof(calib)) == 0, "decoded trimming differs from the datasheet");
+}
+
+// Datasheet 3.12 example: adc_T 519888 gives 25.08 degC and t_fine 128422. 25767233 is what the
+// published 64-bit pressure code returns for adc_P 415148, the datasheet table prints 25767236.
+static void Test_Bmp280DatasheetExample(void) {
+    int32_t tFine;
+    int32_t t = Bmp280_CompensateTemp(&bmp280Calib, 519888, &tFine);
+    uint32_t p = Bmp280_CompensatePressure(&bmp280Calib, 415148, tFine);
+    TEST_CHECK(t == 2508, "T %d", t);
+    TEST_CHECK(tFine == 128422, "t_fine %d", tFine);
+    TEST_CHECK(p == 25767233U, "P %u", p);
+
+    float tFineF;
+    float tF = Bmp280_CompensateTempF(&bmp280Calib, 519888, &tFineF);
+    float pF = Bmp280_CompensatePressureF(&bmp280Calib, 415148, tFineF);
+    TEST_CHECK_NEAR(tF, 25.08, 0.005);
+    TEST_CHECK_NEAR(pF, 100653.27, 0.1); // datasheet double result
+}
+
+static void Test_Bmp280AgainstReference(void) {
+    double maxT = 0.0, maxP = 0.0, maxTF = 0.0, maxPF = 0.0;
+    for (int32_t adcT = 400000; adcT <= 600000; adcT += 997) {
+        for (int32_t adcP = 250000; adcP <= 500000; adcP += 1009) {
+            double refFine;
+            double refT = Ref280_Temp(&bmp280Calib, adcT, &refFine);
+            double refP = Ref280_Pressure(&bmp280Calib, adcP, refFine);
+
+            int32_t tFine;
+            int32_t t = Bmp280_CompensateTemp(&bmp280Calib, adcT, &tFine);
+            uint32_t p = Bmp280_CompensatePressure(&bmp280Calib, adcP, tFine);
+            float tFineF;
+            float tF = Bmp280_CompensateTempF(&bmp280Calib, adcT, &tFineF);
+            float pF = Bmp280_CompensatePressureF(&bmp280Calib, adcP, tFineF);
+
+            maxT = fmax(maxT, fabs(t / 100.0 - refT));
+            maxP = fmax(maxP, fabs(p / 256.0 - refP));
+            maxTF = fmax(maxTF, fabs(tF - refT));
+            maxPF = fmax(maxPF, fabs(pF - refP));
+        }
+    }
+    // Integer outputs are 0.01 degC and 1/256 Pa, the pressure path truncates at every shift
+    TEST_CHECK(maxT <= 0.01, "integer temperature off by %.4f degC", maxT);
+    TEST_CHECK(maxP <= 1.0, "integer pressure off by %.3f Pa", maxP);
+    TEST_CHECK(maxTF <= 0.001, "float temperature off by %.5f degC", maxTF);
+    TEST_CHECK(maxPF <= 0.25, "float pressure off by %.3f Pa", maxPF);
+}
+
+static void Test_Bmp280InvalidTrimming(void) {
+    bmp280_calib_t calib = bmp280Calib;
+    calib.P1 = 0;
+    int32_t tFine;
+    float tFineF;
+    Bmp280_CompensateTemp(&calib, 519888, &tFine);
+    Bmp280_CompensateTempF(&calib, 519888, &tFineF);
+    TEST_CHECK(Bmp280_CompensatePressure(&calib, 415148, tFine) == 0U);
+    TEST_CHECK(Bmp280_CompensatePressureF(&calib, 415148, tFineF) == 0.0f);
+}
+
+static void Test_Bmp388ParseCalib(void) {
+    bmp388_calib_t calib;
+    Bmp388_ParseCalib(bmp388CalibRaw, &calib);
+    TEST_CHECK(calib.T1 == 0x6978U && calib.T2 == 0x4A38U && calib.T3 == -7);
+    TEST_CHECK(calib.P1 == 0x0290 && calib.P2 == -1200 && calib.P3 == 12 && calib.P4 == 4);
+    TEST_CHECK(calib.P5 == 0x61A8U && calib.P6 == 0x7530U && calib.P7 == -8 && calib.P8 == -10);
+    TEST_CHECK(calib.P9 == 0x3E80 && calib.P10 == 10 && calib.P11 == -60);
+    TEST_CHECK(calib.parT[0] == 0x6978U * 256.0f);
+    TEST_CHECK(calib.parP[4] == 0x61A8U * 8.0f);
+}
+
+static void Test_Bmp388FixedAgainstFloat(void) {
+    bmp388_calib_t calib;
+    Bmp388_ParseCalib(bmp388CalibRaw, &calib);
+
+    double maxT = 0.0, maxP = 0.0, maxTF = 0.0, maxPF = 0.0, maxTD = 0.0, maxPD = 0.0;
+    for (uint32_t adcT = 7500000U; adcT <= 8600000U; adcT += 9973U) {
+        for (uint32_t adcP = 5500000U; adcP <= 7500000U; adcP += 10007U) {
+            double refT = Ref388_Temp(&calib, adcT);
+            double refP = Ref388_Pressure(&calib, adcP, refT);
+
+            int64_t tLin;
+            int32_t t = Bmp388_CompensateTemp(&calib, adcT, &tLin);
+            uint32_t p = Bmp388_CompensatePressure(&calib, adcP, tLin);
+            float tF = Bmp388_CompensateTempF(&calib, adcT);
+            float pF = Bmp388_CompensatePressureF(&calib, adcP, tF);
+
+            maxT = fmax(maxT, fabs(t / 100.0 - refT));
+            maxP = fmax(maxP, fabs(p / 100.0 - refP));
+            maxTF = fmax(maxTF, fabs(tF - refT));
+            maxPF = fmax(maxPF, fabs(pF - refP));
+            maxTD = fmax(maxTD, fabs(t / 100.0 - tF));
+            maxPD = fmax(maxPD, fabs(p / 100.0 - pF));
+        }
+    }
+    // Both integer outputs are in hundredths, the float path rounds to about 0.03 Pa at 1 bar
+    TEST_CHECK(maxT <= 0.01, "integer temperature off by %.4f degC", maxT);
+    TEST_CHECK(maxP <= 0.05, "integer pressure off by %.3f Pa", maxP);
+    TEST_CHECK(maxTF <= 0.001, "float temperature off by %.5f degC", maxTF);
+    TEST_CHECK(maxPF <= 0.1, "float pressure off by %.3f Pa", maxPF);
+    TEST_CHECK(maxTD <= 0.011, "integer and float temperature differ by %.4f degC", maxTD);
+    TEST_CHECK(maxPD <= 0.1, "integer and float pressure differ by %.3f Pa", maxPD);
+}
+
+int main(void) {
+    TEST_RUN(Test_Bmp280ParseCalib);
+    TEST_RUN(Test_Bmp280DatasheetExample);
+    TEST_RUN(Test_Bmp280AgainstReference);
+    TEST_RUN(Test_Bmp280InvalidTrimming);
+    TEST_RUN(Test_Bmp388ParseCalib);
+    TEST_RUN(Test_Bmp388FixedAgainstFloat);
+    return HostTest_Exit();
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+/**
+ * Host tests of the BMP388 SPI driver, the real driver against the register model on the fake bus
+ */
+
+#include "HostTest.h"
+#include "BaroCompensation.h"
+#include "BaroInterface.h"
+#include "FakeBmp388.h"
+#include "Logger.h"
+#include "Timebase.h"
+#include "main.h"
+
+#define REG_CHIP_ID    0x00
+#define REG_INT_STATUS 0x11
+#define REG_INT_CTRL   0x19
+#define REG_PWR_CTRL   0x1B
+#define REG_OSR        0x1C
+#define REG_ODR        0x1D
+#define REG_CONFIG     0x1F
+
+// Calibration registers the model serves
+static const uint8_t calibRaw[BMP388_CALIB_LEN] = {
+    0x78, 0x69, 0x38, 0x4A, 0xF9, 0x90, 0x02, 0x50, 0xFB, 0x0C, 0x04,
+    0xA8, 0x61, 0x30, 0x75, 0xF8, 0xF6, 0x80, 0x3E, 0x0A, 0xC4
+};
+
+static UART_HandleTypeDef huart1;
+static SPI_HandleTypeDef hspi1;
+static const SystemHardwareHandles_t handles = { .p_huart1 = &huart1, .p_hspi1 = &hspi1 };
+
+// Route the INT edge and the bus completions the way SystemInitializer does
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin == BARO_INT_Pin)
+        Baro_OnDataReady(Timebase_GetUs());
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi1)
+        Baro_OnTransferComplete();
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi1)
+        Baro_OnTransferError();
+}
+
+static void Test_InitConfiguresDevice(void) {
+    FakeBmp388_Attach(&hspi1);
+    TEST_CHECK(Baro_Init(handles, 50U));
+    TEST_CHECK(FakeBmp388_GetReg(REG_ODR) == 2U, "50 Hz is 200 Hz / 4");
+    TEST_CHECK(FakeBmp388_GetReg(REG_OSR) == 3U, "pressure x8 fits a 20 ms period");
+    TEST_CHECK(FakeBmp388_GetReg(REG_CONFIG) == 0x04, "IIR coefficient 3");
+    TEST_CHECK(FakeBmp388_GetReg(REG_PWR_CTRL) == 0x33, "both sensors, normal mode");
+    TEST_CHECK(FakeBmp388_GetReg(REG_INT_CTRL) == 0x02, "active high, data ready still off");
+
+    // Faster rates give up oversampling to fit the conversion in the period
+    TEST_CHECK(Baro_Init(handles, 200U));
+    TEST_CHECK(FakeBmp388_GetReg(REG_ODR) == 0U);
+    TEST_CHECK(FakeBmp388_GetReg(REG_OSR) == 0U);
+
+    // Slower than the slowest setting runs at the slowest
+    TEST_CHECK(Baro_Init(handles, 1U));
+    TEST_CHECK(FakeBmp388_GetReg(REG_ODR) == 7U, "%u", FakeBmp388_GetReg(REG_ODR));
+
+    baro_repo_t repo;
+    TEST_CHECK(!Baro_GetRepo(&repo), "nothing published before the first read");
+}
+
+static void Test_InitRejectsOtherDevice(void) {
+    FakeBmp388_Attach(&hspi1);
+    FakeBmp388_SetReg(REG_CHIP_ID, 0x60); // BMP390
+    TEST_CHECK(!Baro_Init(handles, 50U));
+
+    FakeBmp388_Attach(&hspi1);
+    TEST_CHECK(!Baro_Init(handles, 0U));
+
+    SPI_HandleTypeDef empty = { 0 };
+    SystemHardwareHandles_t noDevice = { .p_hspi1 = &empty };
+    TEST_CHECK(!Baro_Init(noDevice, 50U));
+}
+
+static baro_repo_t callbackRepo;
+static uint32_t callbackCount;
+
+static void Test_OnSample(const baro_repo_t* repo) {
+    callbackRepo = *repo;
+    callbackCount++;
+}
+
+// Every INT edge starts one burst, the completion compensates and publishes it
+static void Test_DataReadyRead(void) {
+    bmp388_calib_t calib;
+    Bmp388_ParseCalib(calibRaw, &calib);
+
+    FakeBmp388_Attach(&hspi1);
+    TEST_CHECK(Baro_Init(handles, 50U));
+    Baro_SetSampleCallback(Test_OnSample);
+    callbackCount = 0;
+    TEST_CHECK(Baro_SetDataReadyInterrupt(true));
+    TEST_CHECK(FakeBmp388_GetReg(REG_INT_CTRL) == 0x42);
+
+    const uint32_t adcP = 6800000U;
+    const uint32_t adcT = 8300000U;
+    FakeBmp388_SetRaw(adcP, adcT);
+    FakeBmp388_Advance(1000U);
+    TEST_CHECK(callbackCount == 0U, "sample before the first period elapsed");
+
+    uint64_t before = Timebase_GetUs();
+    FakeBmp388_Advance(1000U + 20000U);
+    uint64_t after = Timebase_GetUs();
+
+    baro_repo_t repo;
+    if (TEST_CHECK(Baro_GetRepo(&repo))) {
+        float t = Bmp388_CompensateTempF(&calib, adcT);
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before && repo.timestamp_us <= after, "stamped at the INT edge");
+        TEST_CHECK(repo.data.temperature == t, "%.4f vs %.4f degC", repo.data.temperature, t);
+        TEST_CHECK(repo.data.pressure == Bmp388_CompensatePressureF(&calib, adcP, t), "%.2f Pa", repo.data.pressure);
+    }
+    TEST_CHECK(callbackCount == 1U && callbackRepo.seq_n == 1U, "sample callback after publishing");
+    TEST_CHECK(FakeBmp388_GetReg(REG_INT_STATUS) == 0U, "burst cleared INT_STATUS");
+    TEST_CHECK(HAL_GPIO_ReadPin(BARO_CS_GPIO_Port, BARO_CS_Pin) == GPIO_PIN_SET, "chip select released");
+
+    // Three more periods, three more samples carrying the new readings
+    FakeBmp388_SetRaw(adcP + 1000U, adcT);
+    FakeBmp388_Advance(1000U + 4U * 20000U);
+    TEST_CHECK(Baro_GetRepo(&repo) && repo.seq_n == 4U, "seq %u", repo.seq_n);
+    TEST_CHECK(repo.data.pressure == Bmp388_CompensatePressureF(&calib, adcP + 1000U, repo.data.temperature));
+
+    // Without data ready the edges stop
+    TEST_CHECK(Baro_SetDataReadyInterrupt(false));
+    FakeBmp388_Advance(1000U + 8U * 20000U);
+    TEST_CHECK(Baro_GetRepo(&repo) && repo.seq_n == 4U);
+    Baro_SetSampleCallback(NULL);
+}
+
+// An edge while the burst is still on the bus is counted and dropped, not restarted
+static void Test_DataReadyInFlight(void) {
+    FakeBmp388_Attach(&hspi1);
+    TEST_CHECK(Baro_Init(handles, 50U));
+    TEST_CHECK(Baro_SetDataReadyInterrupt(true));
+    HalFake_SpiDefer(&hspi1, true);
+
+    FakeBmp388_Advance(1000U);
+    uint64_t before = Timebase_GetUs();
+    FakeBmp388_Advance(1000U + 20000U);
+    uint64_t after = Timebase_GetUs();
+    TEST_CHECK(hspi1.pending == HAL_FAKE_SPI_TXRX, "burst started on the edge");
+    TEST_CHECK(HAL_GPIO_ReadPin(BARO_CS_GPIO_Port, BARO_CS_Pin) == GPIO_PIN_RESET, "chip select held for the burst");
+
+    baro_repo_t repo;
+    TEST_CHECK(!Baro_GetRepo(&repo), "published before the transfer completed");
+    FakeBmp388_Advance(1000U + 2U * 20000U);
+    TEST_CHECK(!Baro_StartRead(), "second read started over the first");
+    TEST_CHECK(!Baro_SetDataReadyInterrupt(false), "configured over a transfer");
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi1));
+    TEST_CHECK(!HalFake_SpiComplete(&hspi1), "the overlapping edge started a transfer");
+    if (TEST_CHECK(Baro_GetRepo(&repo))) {
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before && repo.timestamp_us <= after, "stamped at the first edge");
+    }
+
+    HalFake_SpiDefer(&hspi1, false);
+    TEST_CHECK(Baro_SetDataReadyInterrupt(false));
+}
+
+// A refused or failed transfer publishes nothing and leaves the driver ready for the next edge
+static void Test_BusErrors(void) {
+    FakeBmp388_Attach(&hspi1);
+    TEST_CHECK(Baro_Init(handles, 50U));
+    TEST_CHECK(Baro_StartRead());
+
+    const hal_fake_spi_device_t* device = hspi1.device;
+    hspi1.device = NULL;
+    TEST_CHECK(!Baro_StartRead(), "bus refused the transfer");
+    TEST_CHECK(HAL_GPIO_ReadPin(BARO_CS_GPIO_Port, BARO_CS_Pin) == GPIO_PIN_SET, "chip select released");
+    hspi1.device = device;
+
+    baro_repo_t repo;
+    TEST_CHECK(Baro_GetRepo(&repo) && repo.seq_n == 1U, "nothing published");
+
+    HAL_SPI_ErrorCallback(&hspi1);
+    TEST_CHECK(Baro_StartRead(), "ready again after a bus error");
+    TEST_CHECK(Baro_GetRepo(&repo) && repo.seq_n == 2U);
+}
+
+int main(void) {
+    Timebase_Init();
+    if (!Logger_Init(LOGGER_TYPE_UART, &huart1))
+        return EXIT_FAILURE;
+
+    TEST_RUN(Test_InitConfiguresDevice);
+    TEST_RUN(Test_InitRejectsOtherDevice);
+    TEST_RUN(Test_DataReadyRead);
+    TEST_RUN(Test_DataReadyInFlight);
+    TEST_RUN(Test_BusErrors);
+    return HostTest_Exit();
+}
\ No newline at end of file
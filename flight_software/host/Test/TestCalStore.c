@@ -0,0 +1,152 @@
+/**
+ * Host tests of the calibration store on the emulated flash sectors
+ *
+ * Every boot is a fresh CalStore_Init over whatever the previous steps left in flash, and a
+ * power loss is a sector image edited to what an interrupted program or erase leaves behind.
+ */
+
+#include "HostTest.h"
+#include "CalStore.h"
+#include "FakeFlash.h"
+#include "stm32f4xx_hal.h"
+
+#include <string.h>
+
+#define SECTOR_WORDS (CAL_STORE_SIZE / sizeof(uint32_t))
+
+extern uint32_t _scalib[];
+
+// A record that tells which save it came from
+static cal_data_t Cal_Make(uint32_t n) {
+    cal_data_t cal = { .valid = CAL_VALID_MAG | CAL_VALID_BOARD };
+    cal.mag.offset[0] = (float)n;
+    cal.mag.fieldUt = 48.0f;
+    for (uint32_t i = 0; i < 9; i++)
+        cal.boardRotation[i] = (float)(n * 9U + i);
+    return cal;
+}
+
+static bool Cal_Equal(const cal_data_t* a, const cal_data_t* b) {
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+// Saves until the active sector refuses, returns the number stored
+static uint32_t Cal_Fill(uint32_t first) {
+    uint32_t n = first;
+    for (cal_data_t cal = Cal_Make(n); CalStore_Save(&cal); cal = Cal_Make(++n))
+        ;
+    return n - first;
+}
+
+static void Test_SaveAndBoot(void) {
+    cal_data_t cal;
+    FakeFlash_Reset();
+    TEST_CHECK(!CalStore_Init(), "record on a new board");
+    TEST_CHECK(!CalStore_Load(&cal) && cal.valid == 0U);
+
+    cal_data_t saved = Cal_Make(1);
+    TEST_CHECK(CalStore_Save(&saved));
+    saved = Cal_Make(2);
+    TEST_CHECK(CalStore_Save(&saved));
+    TEST_CHECK(CalStore_Load(&cal) && Cal_Equal(&cal, &saved));
+
+    TEST_CHECK(CalStore_Init());
+    TEST_CHECK(CalStore_Load(&cal) && Cal_Equal(&cal, &saved), "newest record after boot");
+
+    cal_store_stats_t stats;
+    CalStore_GetStats(&stats);
+    TEST_CHECK(stats.records == 2U && stats.sequence == 2U && stats.eraseCount == 0U);
+}
+
+// A corrupt newest record falls back to the one before it
+static void Test_SkipsCorruptRecord(void) {
+    cal_data_t cal;
+    FakeFlash_Reset();
+    CalStore_Init();
+    cal_data_t older = Cal_Make(1);
+    cal_data_t newer = Cal_Make(2);
+    TEST_CHECK(CalStore_Save(&older) && CalStore_Save(&newer));
+
+    cal_store_stats_t stats;
+    CalStore_GetStats(&stats);
+    _scalib[stats.bytesUsed / sizeof(uint32_t) - 1U] ^= 1U; // a bit of the last payload word, as a cut program leaves it
+    TEST_CHECK(CalStore_Init());
+    TEST_CHECK(CalStore_Load(&cal) && Cal_Equal(&cal, &older));
+
+    // The next record continues after the corrupt one, not over it
+    TEST_CHECK(CalStore_Save(&newer));
+    TEST_CHECK(CalStore_Init() && CalStore_Load(&cal) && Cal_Equal(&cal, &newer));
+    CalStore_GetStats(&stats);
+    TEST_CHECK(stats.records == 3U, "%u records", stats.records);
+}
+
+// Full sectors compact into the other one, which is only erased while it holds older records
+static void Test_CompactsIntoOtherSector(void) {
+    cal_data_t cal;
+    cal_store_stats_t stats;
+    fake_flash_stats_t flash;
+    FakeFlash_Reset();
+    CalStore_Init();
+
+    uint32_t n = Cal_Fill(0);
+    cal_data_t newest = Cal_Make(n - 1U);
+    TEST_CHECK(n > 800U, "%u records in a sector", n);
+    CalStore_GetStats(&stats);
+    TEST_CHECK(stats.failures == 1U, "%u failures", stats.failures);
+
+    // Sector 1 is blank, the copy goes in without an erase and sector 0 is left as it was
+    TEST_CHECK(CalStore_Init());
+    TEST_CHECK(CalStore_Load(&cal) && Cal_Equal(&cal, &newest));
+    FakeFlash_GetStats(&flash);
+    CalStore_GetStats(&stats);
+    TEST_CHECK(flash.erases == 0U && stats.eraseCount == 0U, "%u erases", flash.erases);
+    TEST_CHECK(stats.records == 1U && stats.failures == 0U);
+    TEST_CHECK(_scalib[SECTOR_WORDS] == CAL_STORE_MAGIC, "copy not in sector 1");
+    TEST_CHECK(_scalib[0] == CAL_STORE_MAGIC, "sector 0 erased before it had to be");
+
+    // Boots between compactions keep to sector 1, the higher sequence
+    TEST_CHECK(CalStore_Init() && CalStore_Load(&cal) && Cal_Equal(&cal, &newest));
+    CalStore_GetStats(&stats);
+    TEST_CHECK(stats.records == 1U && stats.bytesUsed < CAL_STORE_SIZE);
+
+    // Back into sector 0, which has to be erased first
+    n += Cal_Fill(n);
+    newest = Cal_Make(n - 1U);
+    TEST_CHECK(CalStore_Init() && CalStore_Load(&cal) && Cal_Equal(&cal, &newest));
+    FakeFlash_GetStats(&flash);
+    CalStore_GetStats(&stats);
+    TEST_CHECK(flash.erases == 1U && stats.eraseCount == 1U, "%u erases", flash.erases);
+    TEST_CHECK(flash.overwrites == 0U && flash.lockViolations == 0U);
+    TEST_CHECK(stats.records == 1U && _scalib[0] == CAL_STORE_MAGIC);
+}
+
+// A reset after the spare sector was erased, before the copy was complete, loses nothing
+static void Test_InterruptedCompaction(void) {
+    cal_data_t cal;
+    cal_store_stats_t stats;
+    FakeFlash_Reset();
+    CalStore_Init();
+    uint32_t n = Cal_Fill(0);
+    cal_data_t newest = Cal_Make(n - 1U);
+
+    // What the cut copy leaves: an erased sector 1 with the first few words of the record
+    memcpy(&_scalib[SECTOR_WORDS], &_scalib[0], 8U * sizeof(uint32_t));
+    TEST_CHECK(CalStore_Init(), "calibration lost to an interrupted compaction");
+    TEST_CHECK(CalStore_Load(&cal) && Cal_Equal(&cal, &newest));
+
+    // The compaction ran again, erasing the partial copy rather than programming over it
+    fake_flash_stats_t flash;
+    FakeFlash_GetStats(&flash);
+    CalStore_GetStats(&stats);
+    TEST_CHECK(flash.erases == 1U && flash.overwrites == 0U, "%u erases, %u overwrites", flash.erases, flash.overwrites);
+    TEST_CHECK(stats.failures == 0U && stats.records == 1U);
+    TEST_CHECK(CalStore_Init() && CalStore_Load(&cal) && Cal_Equal(&cal, &newest));
+}
+
+int main(void) {
+    TEST_RUN(Test_SaveAndBoot);
+    TEST_RUN(Test_SkipsCorruptRecord);
+    TEST_RUN(Test_CompactsIntoOtherSector);
+    TEST_RUN(Test_InterruptedCompaction);
+    return HostTest_Exit();
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+/**
+ * Host tests of the IMU sample ring, one producer thread against several consumer threads
+ *
+ * Every field of a published sample is derived from its sequence number, so a copy that mixes
+ * two writes shows up as a sample that disagrees with itself. The threads only count what they
+ * see, the checks run on the main thread once they are joined.
+ */
+
+#include "HostTest.h"
+#include "ImuRing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#define STRESS_SAMPLES   2000000U
+#define STRESS_CONSUMERS 4U
+#define PRODUCER_BURST   16U
+#define SLOW_EVERY       8U     // reads between pauses of the slow consumer
+#define SLOW_PAUSE_NS    20000L
+
+typedef struct {
+    bool slow;
+    imu_ring_reader_t reader;
+    uint32_t reads;
+    uint32_t torn;
+    uint32_t reordered;
+    uint32_t gaps; // samples skipped between consecutive reads, counted by the test
+    uint32_t lastSeq;
+} consumer_t;
+
+static atomic_bool producerDone;
+
+static void Sample_Make(uint32_t seq, imu_repo_t* repo) {
+    repo->data.ax = (float)seq;
+    repo->data.ay = -(float)seq;
+    repo->data.az = (float)seq + 0.5f;
+    repo->data.gx = (float)(seq ^ 0x5555U);
+    repo->data.gy = (float)(seq ^ 0xAAAAU);
+    repo->data.gz = (float)(seq >> 3);
+    repo->seq_n = seq;
+    repo->timestamp_us = (uint64_t)seq * 125U + 7U;
+}
+
+static bool Sample_Intact(const imu_repo_t* repo) {
+    imu_repo_t expected;
+    Sample_Make(repo->seq_n, &expected);
+    return memcmp(&expected.data, &repo->data, sizeof(expected.data)) == 0
+        && expected.timestamp_us == repo->timestamp_us;
+}
+
+static void Consumer_Take(consumer_t* c, const imu_repo_t* repo) {
+    c->reads++;
+    if (!Sample_Intact(repo))
+        c->torn++;
+    if (repo->seq_n <= c->lastSeq)
+        c->reordered++;
+    else
+        c->gaps += repo->seq_n - c->lastSeq - 1U;
+    c->lastSeq = repo->seq_n;
+}
+
+static void* Producer_Run(void* arg) {
+    (void)arg;
+    imu_repo_t repo;
+    for (uint32_t seq = 1; seq <= STRESS_SAMPLES; seq++) {
+        Sample_Make(seq, &repo);
+        ImuRing_Publish(&repo);
+        if (seq % PRODUCER_BURST == 0U)
+            sched_yield(); // let the fast consumers keep up, the slow one still gets lapped
+    }
+    atomic_store(&producerDone, true);
+    return NULL;
+}
+
+static void* Consumer_Run(void* arg) {
+    consumer_t* c = arg;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = SLOW_PAUSE_NS };
+    imu_repo_t repo;
+
+    for (;;) {
+        bool done = atomic_load(&producerDone);
+        if (ImuRing_Read(&c->reader, &repo)) {
+            Consumer_Take(c, &repo);
+            if (c->slow && c->reads % SLOW_EVERY == 0U)
+                nanosleep(&pause, NULL);
+        } else if (done) {
+            return NULL; // caught up after the last publish
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static void Test_Stress(void) {
+    consumer_t consumers[STRESS_CONSUMERS];
+    pthread_t threads[STRESS_CONSUMERS];
+    pthread_t producer;
+
+    ImuRing_Init();
+    atomic_store(&producerDone, false);
+    for (uint32_t i = 0; i < STRESS_CONSUMERS; i++) {
+        memset(&consumers[i], 0, sizeof(consumers[i]));
+        consumers[i].slow = (i == STRESS_CONSUMERS - 1U);
+        ImuRing_ReaderInit(&consumers[i].reader);
+        pthread_create(&threads[i], NULL, Consumer_Run, &consumers[i]);
+    }
+    pthread_create(&producer, NULL, Producer_Run, NULL);
+
+    pthread_join(producer, NULL);
+    for (uint32_t i = 0; i < STRESS_CONSUMERS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (uint32_t i = 0; i < STRESS_CONSUMERS; i++) {
+        const consumer_t* c = &consumers[i];
+        TEST_CHECK(c->torn == 0U, "consumer %u, %u of %u reads torn", i, c->torn, c->reads);
+        TEST_CHECK(c->reordered == 0U, "consumer %u, %u reads out of order", i, c->reordered);
+        TEST_CHECK(c->lastSeq == STRESS_SAMPLES, "consumer %u ended on %u", i, c->lastSeq);
+        TEST_CHECK(c->reads + c->gaps == STRESS_SAMPLES, "consumer %u, %u reads + %u skipped",
+                   i, c->reads, c->gaps);
+        TEST_CHECK(c->reader.missed == c->gaps, "consumer %u, missed %u, skipped %u",
+                   i, c->reader.missed, c->gaps);
+    }
+    TEST_CHECK(consumers[STRESS_CONSUMERS - 1U].gaps > 0U, "the slow consumer was never lapped");
+}
+
+// Deterministic lap, the reader falls a ring and a half behind before its first read
+static void Test_LapBeforeFirstRead(void) {
+    imu_ring_reader_t reader;
+    imu_repo_t repo;
+    const uint32_t published = IMU_RING_SIZE + IMU_RING_SIZE / 2U;
+
+    ImuRing_Init();
+    ImuRing_ReaderInit(&reader);
+    for (uint32_t seq = 1; seq <= published; seq++) {
+        Sample_Make(seq, &repo);
+        ImuRing_Publish(&repo);
+    }
+
+    // The oldest slot may be mid-write on the target, the reader starts one past it
+    uint32_t expected = published - IMU_RING_SIZE + 2U;
+    TEST_CHECK(ImuRing_Read(&reader, &repo));
+    TEST_CHECK(repo.seq_n == expected, "first read %u, expected %u", repo.seq_n, expected);
+    TEST_CHECK(Sample_Intact(&repo));
+    TEST_CHECK(reader.missed == expected - 1U, "missed %u", reader.missed);
+
+    uint32_t reads = 1;
+    while (ImuRing_Read(&reader, &repo))
+        reads++;
+    TEST_CHECK(reads == IMU_RING_SIZE - 1U, "%u reads", reads);
+    TEST_CHECK(repo.seq_n == published);
+    TEST_CHECK(reader.missed == expected - 1U, "missed %u", reader.missed);
+}
+
+// A reader attached mid-stream counts nothing for the samples published before it
+static void Test_AttachMidStream(void) {
+    imu_ring_reader_t reader;
+    imu_repo_t repo;
+
+    ImuRing_Init();
+    for (uint32_t seq = 1; seq <= 10U; seq++) {
+        Sample_Make(seq, &repo);
+        ImuRing_Publish(&repo);
+    }
+    ImuRing_ReaderInit(&reader);
+    TEST_CHECK(!ImuRing_Read(&reader, &repo));
+
+    for (uint32_t seq = 11; seq <= 13U; seq++) {
+        Sample_Make(seq, &repo);
+        ImuRing_Publish(&repo);
+    }
+    TEST_CHECK(ImuRing_Read(&reader, &repo) && repo.seq_n == 11U);
+    TEST_CHECK(reader.missed == 0U, "missed %u", reader.missed);
+
+    // Upstream gap, the driver lost a sample before it reached the ring
+    Sample_Make(15, &repo);
+    ImuRing_Publish(&repo);
+    while (ImuRing_Read(&reader, &repo))
+        ;
+    TEST_CHECK(repo.seq_n == 15U);
+    TEST_CHECK(reader.missed == 1U, "missed %u", reader.missed);
+}
+
+int main(void) {
+    TEST_RUN(Test_LapBeforeFirstRead);
+    TEST_RUN(Test_AttachMidStream);
+    TEST_RUN(Test_Stress);
+    return HostTest_Exit();
+}
\ No newline at end of file
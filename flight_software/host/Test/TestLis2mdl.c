@@ -0,0 +1,247 @@
+/**
+ * Host tests of the LIS2MDL SPI driver, the real driver against the register model on the fake bus
+ */
+
+#include "HostTest.h"
+#include "FakeLis2mdl.h"
+#include "Logger.h"
+#include "MagInterface.h"
+#include "Timebase.h"
+#include "main.h"
+
+#define REG_WHO_AM_I 0x4F
+#define REG_CFG_A    0x60
+#define REG_CFG_B    0x61
+#define REG_CFG_C    0x62
+#define REG_STATUS   0x67
+
+#define MAG_LSB_UT   0.15f
+#define PERIOD_50HZ  20000U
+
+static UART_HandleTypeDef huart1;
+static SPI_HandleTypeDef hspi3;
+static const SystemHardwareHandles_t handles = { .p_huart1 = &huart1, .p_hspi3 = &hspi3 };
+
+// Route DRDY and the two bus completions the way SystemInitializer does
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin == MAG_DRDY_Pin)
+        Mag_OnDataReady(Timebase_GetUs());
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi3)
+        Mag_OnTransferComplete();
+}
+
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi3)
+        Mag_OnTransferComplete();
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi3)
+        Mag_OnTransferError();
+}
+
+static void Test_InitConfiguresDevice(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(Mag_Init(handles, 50U));
+    TEST_CHECK(FakeLis2mdl_GetReg(REG_CFG_A) == 0x88, "temperature compensated, 50 Hz, continuous");
+    TEST_CHECK(FakeLis2mdl_GetReg(REG_CFG_B) == 0x02, "offset cancellation");
+    TEST_CHECK(FakeLis2mdl_GetReg(REG_CFG_C) == 0x30, "I2C off, BDU, 3-wire, DRDY still off");
+
+    // Rates round up to the next output data rate, and stop at the fastest
+    static const struct { uint16_t rate; uint8_t odr; } rates[] = { {1U, 0U}, {10U, 0U}, {11U, 1U}, {100U, 3U}, {400U, 3U} };
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        TEST_CHECK(Mag_Init(handles, rates[i].rate));
+        TEST_CHECK(((FakeLis2mdl_GetReg(REG_CFG_A) >> 2) & 0x03U) == rates[i].odr, "%u Hz", rates[i].rate);
+    }
+
+    mag_repo_t repo;
+    TEST_CHECK(!Mag_GetRepo(&repo), "nothing published before the first read");
+}
+
+static void Test_InitRejectsOtherDevice(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    FakeLis2mdl_SetReg(REG_WHO_AM_I, 0x3D); // LIS3MDL
+    TEST_CHECK(!Mag_Init(handles, 50U));
+
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(!Mag_Init(handles, 0U));
+
+    SPI_HandleTypeDef empty = { 0 };
+    SystemHardwareHandles_t noDevice = { .p_hspi3 = &empty };
+    TEST_CHECK(!Mag_Init(noDevice, 50U));
+}
+
+static mag_repo_t callbackRepo;
+static uint32_t callbackCount;
+
+static void Test_OnSample(const mag_repo_t* repo) {
+    callbackRepo = *repo;
+    callbackCount++;
+}
+
+// A DRDY edge sends the address, the completion turns the line around for the DMA burst
+static void Test_DataReadyRead(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(Mag_Init(handles, 50U));
+    Mag_SetSampleCallback(Test_OnSample);
+    callbackCount = 0;
+    TEST_CHECK(Mag_SetDataReadyInterrupt(true));
+    TEST_CHECK(FakeLis2mdl_GetReg(REG_CFG_C) == 0x31);
+
+    FakeLis2mdl_SetRaw(200, -50, -32768);
+    FakeLis2mdl_Advance(1000U);
+    TEST_CHECK(callbackCount == 0U, "sample before the first period elapsed");
+
+    uint64_t before = Timebase_GetUs();
+    FakeLis2mdl_Advance(1000U + PERIOD_50HZ);
+    uint64_t after = Timebase_GetUs();
+
+    mag_repo_t repo;
+    if (TEST_CHECK(Mag_GetRepo(&repo))) {
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before && repo.timestamp_us <= after, "stamped at the DRDY edge");
+        TEST_CHECK_NEAR(repo.data.mx, 200 * MAG_LSB_UT, 1e-4);
+        TEST_CHECK_NEAR(repo.data.my, -50 * MAG_LSB_UT, 1e-4);
+        TEST_CHECK_NEAR(repo.data.mz, -32768 * MAG_LSB_UT, 1e-2);
+    }
+    TEST_CHECK(callbackCount == 1U && callbackRepo.seq_n == 1U, "sample callback after publishing");
+    TEST_CHECK(hspi3.RxXferSize == 7U, "status and outputs in one burst of %u bytes", hspi3.RxXferSize);
+    TEST_CHECK(FakeLis2mdl_GetReg(REG_STATUS) == 0U, "burst released data ready");
+    TEST_CHECK(HAL_GPIO_ReadPin(MAG_CS_GPIO_Port, MAG_CS_Pin) == GPIO_PIN_SET, "chip select released");
+
+    // Reading the outputs released DRDY, so every period brings a new edge
+    FakeLis2mdl_SetRaw(-1, 2, 3);
+    FakeLis2mdl_Advance(1000U + 4U * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 4U, "seq %u", repo.seq_n);
+    TEST_CHECK_NEAR(repo.data.mx, -1 * MAG_LSB_UT, 1e-6);
+
+    TEST_CHECK(Mag_SetDataReadyInterrupt(false));
+    FakeLis2mdl_Advance(1000U + 8U * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 4U);
+    Mag_SetSampleCallback(NULL);
+}
+
+// Nothing is published until the burst lands, and a read cannot start over one in flight
+static void Test_DataReadyInFlight(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(Mag_Init(handles, 50U));
+    TEST_CHECK(Mag_SetDataReadyInterrupt(true));
+    HalFake_SpiDefer(&hspi3, true);
+
+    FakeLis2mdl_Advance(1000U);
+    uint64_t before = Timebase_GetUs();
+    FakeLis2mdl_Advance(1000U + PERIOD_50HZ);
+    uint64_t after = Timebase_GetUs();
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_TX, "address sent on the edge");
+    TEST_CHECK(HAL_GPIO_ReadPin(MAG_CS_GPIO_Port, MAG_CS_Pin) == GPIO_PIN_RESET, "chip select held");
+
+    mag_repo_t repo;
+    TEST_CHECK(!Mag_StartRead(), "second read started over the first");
+    TEST_CHECK(!Mag_SetDataReadyInterrupt(false), "configured over a transfer");
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_RX, "burst received by DMA after the address");
+    TEST_CHECK(!Mag_GetRepo(&repo), "published before the burst completed");
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    if (TEST_CHECK(Mag_GetRepo(&repo))) {
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before && repo.timestamp_us <= after, "stamped at the edge");
+    }
+    TEST_CHECK(HAL_GPIO_ReadPin(MAG_CS_GPIO_Port, MAG_CS_Pin) == GPIO_PIN_SET, "chip select released");
+
+    HalFake_SpiDefer(&hspi3, false);
+    TEST_CHECK(Mag_SetDataReadyInterrupt(false));
+}
+
+// A measurement that lands while the burst is in flight raises DRDY with the edge missed, the
+// completion sees the level and reads it
+static void Test_DataReadyDuringBurst(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(Mag_Init(handles, 50U));
+    TEST_CHECK(Mag_SetDataReadyInterrupt(true));
+    HalFake_SpiDefer(&hspi3, true);
+
+    FakeLis2mdl_Advance(1000U);
+    FakeLis2mdl_Advance(1000U + PERIOD_50HZ);
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_RX);
+
+    FakeLis2mdl_SetRaw(7, 8, 9);
+    FakeLis2mdl_Advance(1000U + 2U * PERIOD_50HZ);
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_RX, "edge during the burst started a transfer");
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_TX, "DRDY left high without a read");
+
+    HalFake_SpiDefer(&hspi3, false);
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    mag_repo_t repo;
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 2U, "seq %u", repo.seq_n);
+    TEST_CHECK_NEAR(repo.data.mx, 7 * MAG_LSB_UT, 1e-6);
+
+    FakeLis2mdl_Advance(1000U + 3U * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 3U, "edges resumed, seq %u", repo.seq_n);
+    TEST_CHECK(Mag_SetDataReadyInterrupt(false));
+}
+
+// A bus error leaves DRDY high, the error path reads again and the edges resume on their own
+static void Test_BusErrorRecovery(void) {
+    FakeLis2mdl_Attach(&hspi3);
+    TEST_CHECK(Mag_Init(handles, 50U));
+    TEST_CHECK(Mag_SetDataReadyInterrupt(true));
+    HalFake_SpiDefer(&hspi3, true);
+
+    FakeLis2mdl_Advance(1000U);
+    FakeLis2mdl_Advance(1000U + PERIOD_50HZ);
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_TX);
+    hspi3.pending = HAL_FAKE_SPI_NONE; // the HAL aborts the transfer before the error callback
+    HAL_SPI_ErrorCallback(&hspi3);
+    TEST_CHECK(hspi3.pending == HAL_FAKE_SPI_TX, "no read after the error");
+
+    HalFake_SpiDefer(&hspi3, false);
+    TEST_CHECK(HalFake_SpiComplete(&hspi3));
+    mag_repo_t repo;
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 1U);
+    TEST_CHECK(HAL_GPIO_ReadPin(MAG_CS_GPIO_Port, MAG_CS_Pin) == GPIO_PIN_SET, "chip select released");
+
+    for (uint32_t n = 2U; n <= 4U; n++)
+        FakeLis2mdl_Advance(1000U + n * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 4U, "edges resumed, seq %u", repo.seq_n);
+
+    // A refused DMA receive is retried from the same completion
+    HalFake_SpiDefer(&hspi3, true);
+    FakeLis2mdl_Advance(1000U + 5U * PERIOD_50HZ);
+    hspi3.pending = HAL_FAKE_SPI_NONE;
+    HalFake_SpiDefer(&hspi3, false);
+    const hal_fake_spi_device_t* device = hspi3.device;
+    hspi3.device = NULL;
+    Mag_OnTransferComplete(); // address out, the receive is refused and so is the retry
+    hspi3.device = device;
+    TEST_CHECK(!Mag_GetRepo(&repo) || repo.seq_n == 4U);
+    TEST_CHECK(HAL_GPIO_ReadPin(MAG_CS_GPIO_Port, MAG_CS_Pin) == GPIO_PIN_SET, "chip select released");
+
+    // With the bus refusing even the restart only a direct read gets the line going again
+    FakeLis2mdl_Advance(1000U + 6U * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 4U, "DRDY stuck high still raised an edge");
+    TEST_CHECK(Mag_StartRead());
+    FakeLis2mdl_Advance(1000U + 7U * PERIOD_50HZ);
+    TEST_CHECK(Mag_GetRepo(&repo) && repo.seq_n == 6U, "seq %u", repo.seq_n);
+    TEST_CHECK(Mag_SetDataReadyInterrupt(false));
+}
+
+int main(void) {
+    Timebase_Init();
+    if (!Logger_Init(LOGGER_TYPE_UART, &huart1))
+        return EXIT_FAILURE;
+
+    TEST_RUN(Test_InitConfiguresDevice);
+    TEST_RUN(Test_InitRejectsOtherDevice);
+    TEST_RUN(Test_DataReadyRead);
+    TEST_RUN(Test_DataReadyInFlight);
+    TEST_RUN(Test_DataReadyDuringBurst);
+    TEST_RUN(Test_BusErrorRecovery);
+    return HostTest_Exit();
+}
\ No newline at end of file
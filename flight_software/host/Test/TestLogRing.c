@@ -0,0 +1,231 @@
+/**
+ * Host tests of the log record ring, several producer threads against one consumer thread
+ *
+ * Every record carries its producer and a per producer sequence number, and its length and
+ * payload bytes are derived from both. The consumer can then tell a lost, duplicated, torn
+ * or truncated record apart from a good one without any shared bookkeeping.
+ */
+
+#include "HostTest.h"
+#include "LogRing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#define STRESS_PRODUCERS 4U
+#define STRESS_RECORDS   200000U // per producer
+#define RECORD_HDR_SIZE  8U
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+    uint8_t payload[LOG_RING_MAX_RECORD - RECORD_HDR_SIZE];
+} record_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t drops; // full ring rejections, retried
+} producer_t;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t lost;
+    uint32_t duplicated;
+    uint32_t torn;
+    uint32_t strays; // records naming a producer that does not exist
+    uint32_t next[STRESS_PRODUCERS];
+} consumer_t;
+
+static atomic_uint producersRunning;
+
+// Spreads lengths over the whole range so padding records land at every offset
+static uint16_t Record_Len(uint32_t producer, uint32_t seq) {
+    return (uint16_t)(RECORD_HDR_SIZE + (seq * 13U + producer * 5U) % (LOG_RING_MAX_RECORD - RECORD_HDR_SIZE + 1U));
+}
+
+static uint8_t Record_Byte(uint32_t producer, uint32_t seq, uint32_t i) {
+    return (uint8_t)(seq * 31U + producer * 7U + i);
+}
+
+static uint16_t Record_Make(uint32_t producer, uint32_t seq, record_t* rec) {
+    uint16_t len = Record_Len(producer, seq);
+    rec->producer = producer;
+    rec->seq = seq;
+    for (uint32_t i = 0; i < len - RECORD_HDR_SIZE; i++)
+        rec->payload[i] = Record_Byte(producer, seq, i);
+    return len;
+}
+
+static bool Record_Intact(const record_t* rec, uint16_t len) {
+    if (len < RECORD_HDR_SIZE || len != Record_Len(rec->producer, rec->seq))
+        return false;
+    for (uint32_t i = 0; i < len - RECORD_HDR_SIZE; i++) {
+        if (rec->payload[i] != Record_Byte(rec->producer, rec->seq, i))
+            return false;
+    }
+    return true;
+}
+
+static void* Producer_Run(void* arg) {
+    producer_t* p = arg;
+    record_t rec;
+    for (uint32_t seq = 0; seq < STRESS_RECORDS; seq++) {
+        uint16_t len = Record_Make(p->id, seq, &rec);
+        while (!LogRing_Write(&rec, len)) {
+            p->drops++;
+            sched_yield(); // full, wait for the consumer
+        }
+    }
+    atomic_fetch_sub(&producersRunning, 1U);
+    return NULL;
+}
+
+static void Consumer_Take(consumer_t* c, const record_t* rec, uint16_t len) {
+    c->reads++;
+    if (len < RECORD_HDR_SIZE || rec->producer >= STRESS_PRODUCERS) {
+        c->strays++;
+        return;
+    }
+    if (!Record_Intact(rec, len))
+        c->torn++;
+
+    // One producer's records come out in the order it wrote them
+    uint32_t* next = &c->next[rec->producer];
+    if (rec->seq < *next) {
+        c->duplicated++;
+    } else {
+        c->lost += rec->seq - *next;
+        *next = rec->seq + 1U;
+    }
+}
+
+static void* Consumer_Run(void* arg) {
+    consumer_t* c = arg;
+    record_t rec;
+    for (;;) {
+        bool done = atomic_load(&producersRunning) == 0U;
+        uint16_t len = LogRing_Read(&rec, sizeof(rec));
+        if (len > 0) {
+            Consumer_Take(c, &rec, len);
+        } else if (done) {
+            return NULL; // every producer finished before this empty read
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static void Test_Stress(void) {
+    producer_t producers[STRESS_PRODUCERS];
+    pthread_t threads[STRESS_PRODUCERS];
+    pthread_t consumerThread;
+    consumer_t consumer;
+
+    LogRing_Init();
+    memset(&consumer, 0, sizeof(consumer));
+    atomic_store(&producersRunning, STRESS_PRODUCERS);
+    pthread_create(&consumerThread, NULL, Consumer_Run, &consumer);
+    for (uint32_t i = 0; i < STRESS_PRODUCERS; i++) {
+        producers[i].id = i;
+        producers[i].drops = 0;
+        pthread_create(&threads[i], NULL, Producer_Run, &producers[i]);
+    }
+
+    uint32_t drops = 0;
+    for (uint32_t i = 0; i < STRESS_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+        drops += producers[i].drops;
+    }
+    pthread_join(consumerThread, NULL);
+
+    log_ring_stats_t stats;
+    LogRing_GetStats(&stats);
+
+    TEST_CHECK(consumer.reads == STRESS_PRODUCERS * STRESS_RECORDS, "%u reads", consumer.reads);
+    TEST_CHECK(consumer.strays == 0U, "%u stray records", consumer.strays);
+    TEST_CHECK(consumer.torn == 0U, "%u torn records", consumer.torn);
+    TEST_CHECK(consumer.lost == 0U, "%u lost records", consumer.lost);
+    TEST_CHECK(consumer.duplicated == 0U, "%u duplicated records", consumer.duplicated);
+    for (uint32_t i = 0; i < STRESS_PRODUCERS; i++)
+        TEST_CHECK(consumer.next[i] == STRESS_RECORDS, "producer %u ended on %u", i, consumer.next[i]);
+    TEST_CHECK(stats.drops == drops, "ring counted %u drops, producers %u", stats.drops, drops);
+    TEST_CHECK(stats.used == 0U, "%u bytes left reserved", stats.used);
+    TEST_CHECK(stats.highWater <= LOG_RING_SIZE, "high water %u", stats.highWater);
+}
+
+// Fills the ring up to one record short of the end, then writes one that has to wrap
+static void Test_PaddingWrap(void) {
+    record_t rec;
+    record_t out;
+    log_ring_stats_t stats;
+    const uint16_t fill = LOG_RING_MAX_RECORD - 4U; // 256 byte records with the header
+
+    LogRing_Init();
+    uint32_t filled = 0;
+    for (uint32_t seq = 0; filled + LOG_RING_MAX_RECORD <= LOG_RING_SIZE - LOG_RING_MAX_RECORD; seq++) {
+        rec.producer = 0;
+        rec.seq = seq;
+        TEST_CHECK(LogRing_Write(&rec, fill));
+        filled += fill + 4U;
+    }
+    while (LogRing_Read(&out, sizeof(out)) > 0)
+        ;
+    LogRing_GetStats(&stats);
+    TEST_CHECK(stats.used == 0U, "%u bytes left reserved", stats.used);
+
+    // Pick a record that does not fit in the space left before the end
+    uint32_t left = LOG_RING_SIZE - filled;
+    uint16_t len = Record_Make(1, 0, &rec);
+    while (len + 4U <= left)
+        len = Record_Make(1, ++rec.seq, &rec);
+    TEST_CHECK(LogRing_Write(&rec, len));
+    LogRing_GetStats(&stats);
+    uint32_t recSize = (4U + len + 3U) & ~3U;
+    TEST_CHECK(stats.used == left + recSize, "%u bytes reserved, %u of them padding", stats.used, left);
+
+    // The padding is skipped, the record comes back whole from the start of the buffer
+    memset(&out, 0, sizeof(out));
+    uint16_t got = LogRing_Read(&out, sizeof(out));
+    TEST_CHECK(got == len, "read %u bytes of %u", got, len);
+    TEST_CHECK(Record_Intact(&out, got));
+    TEST_CHECK(LogRing_Read(&out, sizeof(out)) == 0U);
+    LogRing_GetStats(&stats);
+    TEST_CHECK(stats.used == 0U, "%u bytes left reserved", stats.used);
+
+    // Wrapping needs the padding free as well, 512 bytes free in two halves is not enough
+    LogRing_Init();
+    for (uint32_t seq = 0; seq < 7U; seq++)
+        TEST_CHECK(LogRing_Write(&rec, fill));
+    TEST_CHECK(LogRing_Read(&out, sizeof(out)) == fill);
+    TEST_CHECK(!LogRing_Write(&rec, len), "a wrapping record overran the consumer");
+    TEST_CHECK(LogRing_Write(&rec, fill));
+    LogRing_GetStats(&stats);
+    TEST_CHECK(stats.drops == 1U, "%u drops", stats.drops);
+    TEST_CHECK(stats.used == LOG_RING_SIZE - (fill + 4U), "%u bytes reserved", stats.used);
+}
+
+static void Test_RejectsBadLengths(void) {
+    uint8_t data[LOG_RING_MAX_RECORD + 1U] = { 0 };
+    log_ring_stats_t stats;
+
+    LogRing_Init();
+    TEST_CHECK(!LogRing_Write(data, 0));
+    TEST_CHECK(!LogRing_Write(data, LOG_RING_MAX_RECORD + 1U));
+    TEST_CHECK(LogRing_Write(data, LOG_RING_MAX_RECORD));
+    LogRing_GetStats(&stats);
+    TEST_CHECK(stats.drops == 2U, "%u drops", stats.drops);
+
+    // A short destination truncates, the rest of the record is still released
+    TEST_CHECK(LogRing_Read(data, 10) == 10U);
+    LogRing_GetStats(&stats);
+    TEST_CHECK(stats.used == 0U, "%u bytes left reserved", stats.used);
+}
+
+int main(void) {
+    TEST_RUN(Test_RejectsBadLengths);
+    TEST_RUN(Test_PaddingWrap);
+    TEST_RUN(Test_Stress);
+    return HostTest_Exit();
+}
\ No newline at end of file
@@ -0,0 +1,448 @@
+/**
+ * Host tests of the MPU6500 SPI driver, the real driver against the register model on the fake bus
+ */
+
+#include "HostTest.h"
+#include "AcqScheduler.h"
+#include "FakeMpu6500.h"
+#include "IMUInterface.h"
+#include "ImuRing.h"
+#include "Logger.h"
+#include "Timebase.h"
+
+#define REG_SMPLRT_DIV    0x19
+#define REG_CONFIG        0x1A
+#define REG_FIFO_EN       0x23
+#define REG_GYRO_CONFIG   0x1B
+#define REG_ACCEL_CONFIG  0x1C
+#define REG_INT_PIN_CFG   0x37
+#define REG_INT_ENABLE    0x38
+#define REG_USER_CTRL     0x6A
+#define REG_PWR_MGMT_1    0x6B
+#define REG_WHO_AM_I      0x75
+
+#define ACCEL_LSB (8.0 * 9.80665 / 32768.0)
+#define GYRO_LSB  (2000.0 / 32768.0 * 3.14159265 / 180.0)
+
+static UART_HandleTypeDef huart1;
+static SPI_HandleTypeDef hspi2;
+static const SystemHardwareHandles_t handles = { .p_huart1 = &huart1, .p_hspi2 = &hspi2 };
+
+// The fake bus completes inside the start call, route it the way SystemInitializer does
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi2)
+        Imu_OnTransferComplete();
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+    if (hspi == &hspi2)
+        Imu_OnTransferError();
+}
+
+static void Test_InitConfiguresDevice(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_PWR_MGMT_1) == 0x01, "PLL clock source");
+    TEST_CHECK(FakeMpu6500_GetReg(REG_USER_CTRL) & 0x10, "I2C interface disabled");
+    TEST_CHECK(FakeMpu6500_GetReg(REG_CONFIG) == 0x01, "184 Hz DLPF");
+    TEST_CHECK(FakeMpu6500_GetReg(REG_SMPLRT_DIV) == 0x00);
+    TEST_CHECK(FakeMpu6500_GetReg(REG_GYRO_CONFIG) == 0x18, "2000 dps");
+    TEST_CHECK(FakeMpu6500_GetReg(REG_ACCEL_CONFIG) == 0x10, "8 g");
+    TEST_CHECK(Imu_GetSamplePeriodUs() == 1000U);
+    TEST_CHECK(hspi2.Init.BaudRatePrescaler == SPI_BAUDRATEPRESCALER_4, "left at the data clock");
+
+    imu_repo_t repo;
+    TEST_CHECK(!Imu_GetRepo(&repo), "nothing published before the first read");
+}
+
+static void Test_InitSampleRates(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 250U));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_SMPLRT_DIV) == 3U);
+    TEST_CHECK(Imu_GetSamplePeriodUs() == 4000U);
+
+    TEST_CHECK(Imu_Init(handles, 4U));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_SMPLRT_DIV) == 249U);
+
+    TEST_CHECK(Imu_Init(handles, 8000U));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_CONFIG) == 0x07, "DLPF bypassed");
+    TEST_CHECK(Imu_GetSamplePeriodUs() == 125U);
+
+    // Rates the sample clock cannot produce exactly
+    static const uint16_t unsupported[] = { 0U, 1U, 2U, 3U, 300U, 1001U, 2000U, 4000U, 16000U };
+    for (uint32_t i = 0; i < sizeof(unsupported) / sizeof(unsupported[0]); i++)
+        TEST_CHECK(!Imu_Init(handles, unsupported[i]), "%u Hz accepted", unsupported[i]);
+}
+
+static void Test_InitRejectsOtherDevice(void) {
+    FakeMpu6500_Attach(&hspi2);
+    FakeMpu6500_SetReg(REG_WHO_AM_I, 0x71); // MPU9250
+    TEST_CHECK(!Imu_Init(handles, 1000U));
+
+    // No device on the bus at all
+    SPI_HandleTypeDef empty = { 0 };
+    SystemHardwareHandles_t noDevice = { .p_hspi2 = &empty };
+    TEST_CHECK(!Imu_Init(noDevice, 1000U));
+}
+
+static void Test_DataReadyInterrupt(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    TEST_CHECK(Imu_SetDataReadyInterrupt(true));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_INT_PIN_CFG) == 0x10, "pulse cleared by any read");
+    TEST_CHECK(FakeMpu6500_GetReg(REG_INT_ENABLE) == 0x01, "raw data ready");
+    TEST_CHECK(Imu_SetDataReadyInterrupt(false));
+    TEST_CHECK(FakeMpu6500_GetReg(REG_INT_ENABLE) == 0x00);
+}
+
+static imu_repo_t callbackRepo;
+static uint32_t callbackCount;
+
+static void Test_OnSample(const imu_repo_t* repo) {
+    callbackRepo = *repo;
+    callbackCount++;
+}
+
+// One 15 byte DMA burst from ACCEL_XOUT_H, converted, stamped and published on completion
+static void Test_BurstRead(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    Imu_SetSampleCallback(Test_OnSample);
+    callbackCount = 0;
+    imu_ring_reader_t reader;
+    ImuRing_ReaderInit(&reader);
+
+    static const int16_t accel[3] = { 4096, -2048, -32768 };
+    static const int16_t gyro[3] = { 16, -1000, 32767 };
+    FakeMpu6500_SetRaw(accel, gyro);
+    uint64_t before = Timebase_GetUs();
+    TEST_CHECK(Imu_StartRead());
+    uint64_t after = Timebase_GetUs();
+
+    TEST_CHECK(hspi2.RxXferSize == 15U, "one burst of %u bytes", hspi2.RxXferSize);
+    TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12) == GPIO_PIN_SET, "chip select released");
+
+    imu_repo_t repo;
+    if (TEST_CHECK(Imu_GetRepo(&repo))) {
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before && repo.timestamp_us <= after, "stamped at the start of the transfer");
+        TEST_CHECK_NEAR(repo.data.ax, 4096 * ACCEL_LSB, 1e-4);
+        TEST_CHECK_NEAR(repo.data.ay, -2048 * ACCEL_LSB, 1e-4);
+        TEST_CHECK_NEAR(repo.data.az, -32768 * ACCEL_LSB, 1e-4);
+        TEST_CHECK_NEAR(repo.data.gx, 16 * GYRO_LSB, 1e-6);
+        TEST_CHECK_NEAR(repo.data.gy, -1000 * GYRO_LSB, 1e-5);
+        TEST_CHECK_NEAR(repo.data.gz, 32767 * GYRO_LSB, 1e-4);
+    }
+
+    TEST_CHECK(callbackCount == 1U && callbackRepo.seq_n == 1U, "sample callback after publishing");
+    imu_repo_t ringRepo;
+    TEST_CHECK(ImuRing_Read(&reader, &ringRepo) && ringRepo.seq_n == 1U && ringRepo.data.ax == repo.data.ax);
+
+    // The next read is a new sample, the old burst is not served again
+    static const int16_t accel2[3] = { -1, 1, 0 };
+    FakeMpu6500_SetRaw(accel2, gyro);
+    TEST_CHECK(Imu_StartRead());
+    TEST_CHECK(Imu_GetRepo(&repo) && repo.seq_n == 2U);
+    TEST_CHECK_NEAR(repo.data.ax, -ACCEL_LSB, 1e-6);
+    TEST_CHECK(ImuRing_Read(&reader, &ringRepo) && ringRepo.seq_n == 2U);
+    TEST_CHECK(!ImuRing_Read(&reader, &ringRepo));
+    TEST_CHECK(reader.missed == 0U);
+
+    Imu_SetSampleCallback(NULL);
+}
+
+// Nothing is published until the DMA completes, and an edge meanwhile does not restart the bus
+static void Test_BurstReadInFlight(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    HalFake_SpiDefer(&hspi2, true);
+
+    static const int16_t accel[3] = { 100, 200, 300 };
+    static const int16_t gyro[3] = { -100, -200, -300 };
+    FakeMpu6500_SetRaw(accel, gyro);
+    uint64_t before = Timebase_GetUs();
+    TEST_CHECK(Imu_StartRead());
+    TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12) == GPIO_PIN_RESET, "chip select held for the burst");
+
+    imu_repo_t repo;
+    TEST_CHECK(!Imu_GetRepo(&repo), "published before the transfer completed");
+    TEST_CHECK(!Imu_StartRead(), "second read started over the first");
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi2));
+    TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12) == GPIO_PIN_SET, "chip select released");
+    if (TEST_CHECK(Imu_GetRepo(&repo))) {
+        TEST_CHECK(repo.seq_n == 1U);
+        TEST_CHECK(repo.timestamp_us >= before);
+        TEST_CHECK_NEAR(repo.data.az, 300 * ACCEL_LSB, 1e-5);
+        TEST_CHECK_NEAR(repo.data.gz, -300 * GYRO_LSB, 1e-6);
+    }
+
+    // Settings are refused while the bus belongs to a transfer
+    TEST_CHECK(Imu_StartRead());
+    TEST_CHECK(!Imu_SetCalibration(NULL, NULL));
+    TEST_CHECK(!Imu_SetDataReadyInterrupt(true));
+    TEST_CHECK(HalFake_SpiComplete(&hspi2));
+    TEST_CHECK(Imu_GetRepo(&repo) && repo.seq_n == 2U);
+
+    HalFake_SpiDefer(&hspi2, false);
+}
+
+// A refused or failed transfer publishes nothing and leaves the driver ready for the next edge
+static void Test_BurstReadBusErrors(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    TEST_CHECK(Imu_StartRead());
+
+    const hal_fake_spi_device_t* device = hspi2.device;
+    hspi2.device = NULL;
+    TEST_CHECK(!Imu_StartRead(), "bus refused the transfer");
+    TEST_CHECK(HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_12) == GPIO_PIN_SET, "chip select released");
+    hspi2.device = device;
+
+    imu_repo_t repo;
+    TEST_CHECK(Imu_GetRepo(&repo) && repo.seq_n == 1U, "nothing published");
+
+    HAL_SPI_ErrorCallback(&hspi2);
+    TEST_CHECK(Imu_StartRead(), "ready again after a bus error");
+    TEST_CHECK(Imu_GetRepo(&repo) && repo.seq_n == 2U);
+}
+
+static imu_batch_t lastBatch;
+static uint32_t batchCount;
+
+static void Test_OnBatch(const imu_batch_t* batch) {
+    lastBatch = *batch;
+    batchCount++;
+}
+
+// Frame i of a test stream, distinct on every axis
+static void Test_Frame(int16_t i, int16_t accel[3], int16_t gyro[3]) {
+    accel[0] = (int16_t)(100 * i);
+    accel[1] = (int16_t)(-100 * i - 1);
+    accel[2] = 4096;
+    gyro[0] = (int16_t)(10 * i);
+    gyro[1] = (int16_t)(-10 * i);
+    gyro[2] = (int16_t)(i - 20000);
+}
+
+// Pushes frames first..first+n-1 into the FIFO
+static void Test_PushFrames(int16_t first, int16_t n) {
+    for (int16_t i = first; i < first + n; i++) {
+        int16_t accel[3], gyro[3];
+        Test_Frame(i, accel, gyro);
+        FakeMpu6500_PushFifo(accel, gyro);
+    }
+}
+
+// Checks that a batch carries frames first.. of the test stream
+static void Test_CheckBatchFrames(const imu_batch_t* batch, int16_t first) {
+    for (uint16_t k = 0; k < batch->count; k++) {
+        int16_t accel[3], gyro[3];
+        Test_Frame((int16_t)(first + k), accel, gyro);
+        bool ok = fabs(batch->ax[k] - accel[0] * ACCEL_LSB) < 1e-4 && fabs(batch->ay[k] - accel[1] * ACCEL_LSB) < 1e-4 &&
+                  fabs(batch->az[k] - accel[2] * ACCEL_LSB) < 1e-4 && fabs(batch->gx[k] - gyro[0] * GYRO_LSB) < 1e-5 &&
+                  fabs(batch->gy[k] - gyro[1] * GYRO_LSB) < 1e-5 && fabs(batch->gz[k] - gyro[2] * GYRO_LSB) < 1e-4;
+        if (!TEST_CHECK(ok, "sample %u is not frame %d", k, first + k))
+            return;
+    }
+}
+
+static void Test_FifoSetup(uint16_t rate) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, rate));
+    TEST_CHECK(Imu_SetFifoMode(true));
+    Imu_SetBatchCallback(Test_OnBatch);
+    batchCount = 0;
+}
+
+// FIFO_COUNT, then every complete frame in one burst, published as a back-dated batch
+static void Test_FifoDrain(void) {
+    Test_FifoSetup(1000U);
+    TEST_CHECK(FakeMpu6500_GetReg(REG_FIFO_EN) == 0x78, "accel and gyro into the FIFO");
+    TEST_CHECK((FakeMpu6500_GetReg(REG_USER_CTRL) & 0x40) != 0, "FIFO enabled");
+    TEST_CHECK(FakeMpu6500_GetFastWrites() == 0U, "%u register writes above 1 MHz", FakeMpu6500_GetFastWrites());
+    TEST_CHECK(hspi2.Init.BaudRatePrescaler == SPI_BAUDRATEPRESCALER_4, "left at the data clock");
+    imu_ring_reader_t reader;
+    ImuRing_ReaderInit(&reader);
+
+    // Empty FIFO, nothing to hand off
+    TEST_CHECK(Imu_StartFifoDrain());
+    TEST_CHECK(batchCount == 0U);
+
+    Test_PushFrames(0, 10);
+    uint64_t before = Timebase_GetUs();
+    TEST_CHECK(Imu_StartFifoDrain());
+    uint64_t after = Timebase_GetUs();
+    TEST_CHECK(FakeMpu6500_GetFifoCount() == 0U, "%u bytes left in the FIFO", FakeMpu6500_GetFifoCount());
+    TEST_CHECK(hspi2.RxXferSize == 10U * 12U + 1U, "frames read in one burst");
+
+    if (TEST_CHECK(batchCount == 1U)) {
+        TEST_CHECK(lastBatch.count == 10U);
+        TEST_CHECK(!lastBatch.overflowed);
+        TEST_CHECK(lastBatch.first_seq_n == 1U);
+        TEST_CHECK(lastBatch.sample_period_us == 1000U);
+        // The newest frame is stamped with the FIFO_COUNT read, the rest one period apart before it
+        TEST_CHECK(lastBatch.first_timestamp_us + 9000U >= before && lastBatch.first_timestamp_us + 9000U <= after,
+                   "first sample at %llu, drain started between %llu and %llu",
+                   (unsigned long long)lastBatch.first_timestamp_us, (unsigned long long)before, (unsigned long long)after);
+        Test_CheckBatchFrames(&lastBatch, 0);
+    }
+
+    // Every sample also goes out on its own, oldest first, with its interpolated timestamp
+    imu_repo_t repo;
+    for (uint32_t k = 0; k < 10U; k++) {
+        if (!TEST_CHECK(ImuRing_Read(&reader, &repo), "sample %u missing from the ring", k))
+            break;
+        TEST_CHECK(repo.seq_n == k + 1U);
+        TEST_CHECK(repo.timestamp_us == lastBatch.first_timestamp_us + k * 1000U);
+    }
+    TEST_CHECK(!ImuRing_Read(&reader, &repo));
+    TEST_CHECK(Imu_GetRepo(&repo) && repo.seq_n == 10U);
+
+    // The next batch follows on without a gap
+    Test_PushFrames(10, 3);
+    TEST_CHECK(Imu_StartFifoDrain());
+    if (TEST_CHECK(batchCount == 2U)) {
+        TEST_CHECK(lastBatch.count == 3U && lastBatch.first_seq_n == 11U && !lastBatch.overflowed);
+        Test_CheckBatchFrames(&lastBatch, 10);
+    }
+
+    Imu_SetBatchCallback(NULL);
+}
+
+// A count that is not whole frames means the boundary is lost, the FIFO is reset at 1 MHz
+static void Test_FifoPartialFrame(void) {
+    Test_FifoSetup(1000U);
+
+    static const uint8_t half[6] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC };
+    Test_PushFrames(0, 3);
+    FakeMpu6500_PushFifoBytes(half, sizeof(half));
+    TEST_CHECK(Imu_StartFifoDrain());
+    TEST_CHECK(batchCount == 0U, "misaligned frames handed off");
+    TEST_CHECK(FakeMpu6500_GetFifoCount() == 0U, "FIFO not reset");
+    TEST_CHECK(FakeMpu6500_GetFastWrites() == 0U, "reset written above 1 MHz");
+    TEST_CHECK(hspi2.Init.BaudRatePrescaler == SPI_BAUDRATEPRESCALER_4, "data clock restored");
+    TEST_CHECK((FakeMpu6500_GetReg(REG_USER_CTRL) & 0x40) != 0, "FIFO still enabled");
+
+    // The first batch after the reset is flagged, the one after is not
+    Test_PushFrames(100, 2);
+    TEST_CHECK(Imu_StartFifoDrain());
+    if (TEST_CHECK(batchCount == 1U)) {
+        TEST_CHECK(lastBatch.overflowed);
+        TEST_CHECK(lastBatch.count == 2U && lastBatch.first_seq_n == 1U);
+        Test_CheckBatchFrames(&lastBatch, 100);
+    }
+    Test_PushFrames(102, 1);
+    TEST_CHECK(Imu_StartFifoDrain());
+    TEST_CHECK(batchCount == 2U && !lastBatch.overflowed && lastBatch.first_seq_n == 3U);
+
+    Imu_SetBatchCallback(NULL);
+}
+
+// In overwrite mode a full FIFO drops its oldest bytes mid-frame, the driver resets and flags it
+static void Test_FifoOverflow(void) {
+    Test_FifoSetup(8000U);
+
+    Test_PushFrames(0, 50);
+    TEST_CHECK(FakeMpu6500_GetFifoCount() == 512U);
+    TEST_CHECK(Imu_StartFifoDrain());
+    TEST_CHECK(batchCount == 0U, "overflowed FIFO handed off");
+    TEST_CHECK(FakeMpu6500_GetFifoCount() == 0U, "FIFO not reset");
+
+    // 41 frames is the most the driver takes as intact
+    Test_PushFrames(200, 41);
+    TEST_CHECK(Imu_StartFifoDrain());
+    if (TEST_CHECK(batchCount == 1U)) {
+        TEST_CHECK(lastBatch.overflowed);
+        TEST_CHECK(lastBatch.count == 41U);
+        TEST_CHECK(lastBatch.sample_period_us == 125U);
+        Test_CheckBatchFrames(&lastBatch, 200);
+    }
+    TEST_CHECK(FakeMpu6500_GetFastWrites() == 0U);
+
+    Imu_SetBatchCallback(NULL);
+}
+
+// The two step drain holds the bus until its data burst completes
+static void Test_FifoDrainInFlight(void) {
+    Test_FifoSetup(1000U);
+    HalFake_SpiDefer(&hspi2, true);
+
+    Test_PushFrames(0, 4);
+    TEST_CHECK(Imu_StartFifoDrain());
+    TEST_CHECK(hspi2.RxXferSize == 3U, "FIFO_COUNT read first");
+    TEST_CHECK(!Imu_StartFifoDrain() && !Imu_StartRead(), "bus taken over mid drain");
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi2));
+    TEST_CHECK(hspi2.RxXferSize == 4U * 12U + 1U, "data burst follows the count");
+    TEST_CHECK(batchCount == 0U);
+    TEST_CHECK(!Imu_StartFifoDrain());
+
+    TEST_CHECK(HalFake_SpiComplete(&hspi2));
+    TEST_CHECK(batchCount == 1U && lastBatch.count == 4U);
+    TEST_CHECK(!HalFake_SpiComplete(&hspi2), "transfer left behind");
+    TEST_CHECK(Imu_StartFifoDrain(), "idle again");
+    HalFake_SpiComplete(&hspi2);
+
+    HalFake_SpiDefer(&hspi2, false);
+    Imu_SetBatchCallback(NULL);
+}
+
+// The scheduler drains the FIFO on every Nth data-ready edge instead of reading every sample
+static void Test_SchedulerBatches(void) {
+    FakeMpu6500_Attach(&hspi2);
+    TEST_CHECK(Imu_Init(handles, 8000U));
+    TEST_CHECK(!AcqScheduler_Init(0U));
+    TEST_CHECK(!AcqScheduler_Init(ACQ_MAX_FIFO_BATCH + 1U));
+    TEST_CHECK(AcqScheduler_Init(8U));
+    TEST_CHECK((FakeMpu6500_GetReg(REG_USER_CTRL) & 0x40) != 0, "FIFO enabled by the scheduler");
+
+    imu_ring_reader_t reader;
+    ImuRing_ReaderInit(&reader);
+    uint64_t t = 1000;
+    for (int16_t i = 0; i < 32; i++) {
+        Test_PushFrames(i, 1);
+        AcqScheduler_OnDataReady(t += 125U);
+    }
+
+    acq_stats_t stats;
+    AcqScheduler_GetStats(&stats);
+    TEST_CHECK(stats.edges == 32U);
+    TEST_CHECK(stats.samples == 32U, "%u samples published", stats.samples);
+    TEST_CHECK(stats.overruns == 0U);
+    TEST_CHECK(stats.maxJitterUs == 0U, "nominal period is the 8 kHz sample clock");
+
+    imu_repo_t repo;
+    uint32_t n = 0;
+    while (ImuRing_Read(&reader, &repo))
+        n++;
+    TEST_CHECK(n == 32U && reader.missed == 0U);
+
+    // One sample per edge without the FIFO
+    TEST_CHECK(Imu_Init(handles, 1000U));
+    TEST_CHECK(AcqScheduler_Init(1U));
+    TEST_CHECK((FakeMpu6500_GetReg(REG_USER_CTRL) & 0x40) == 0, "FIFO disabled");
+    AcqScheduler_OnDataReady(t += 1000U);
+    AcqScheduler_GetStats(&stats);
+    TEST_CHECK(stats.samples == 1U && Imu_GetRepo(&repo) && repo.seq_n == 1U);
+}
+
+int main(void) {
+    Timebase_Init();
+    if (!Logger_Init(LOGGER_TYPE_UART, &huart1))
+        return EXIT_FAILURE;
+
+    TEST_RUN(Test_InitConfiguresDevice);
+    TEST_RUN(Test_InitSampleRates);
+    TEST_RUN(Test_InitRejectsOtherDevice);
+    TEST_RUN(Test_DataReadyInterrupt);
+    TEST_RUN(Test_BurstRead);
+    TEST_RUN(Test_BurstReadInFlight);
+    TEST_RUN(Test_BurstReadBusErrors);
+    TEST_RUN(Test_FifoDrain);
+    TEST_RUN(Test_FifoPartialFrame);
+    TEST_RUN(Test_FifoOverflow);
+    TEST_RUN(Test_FifoDrainInFlight);
+    TEST_RUN(Test_SchedulerBatches);
+    return HostTest_Exit();
+}
\ No newline at end of file
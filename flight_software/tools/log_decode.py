@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+# Decodes binary Logger frames (firmware built with -DLOG_BINARY_OUTPUT=ON) back into text.
+# Format and tag pointers are resolved against the string tables of the matching ELF.
+# Data frames (e.g. SysMonitor telemetry) are expanded too; with --text the capture is a
+# text mode log instead, and only the hex data lines in it are expanded.
+#
+# Usage: ./log_decode.py <firmware.elf> [capture_file|-]
+#        ./log_decode.py --text [capture_file|-]
+# Example: stty -F /dev/ttyACM0 raw && cat /dev/ttyACM0 | ./log_decode.py build/Debug/flight_software.elf -
+
+import re
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+DATA_SYNC = b"\xA5\x5B"
+HEADER_WORDS = 4  # timestamp low, timestamp high, tag address, format address
+DATA_HEADER_LEN = 9  # timestamp low, timestamp high, type byte
+
+# Data frame types, see LOG_DATA_<X> in Logger.h
+DATA_SYSMON = 0x01
+SYSMON_HEADER = struct.Struct("<IIHHIB")  # sysmon_frame_t up to the task entries
+SYSMON_TASK = struct.Struct("<8sBBHH")    # sysmon_task_entry_t
+TASK_STATES = "RrBSD"  # running, ready, blocked, suspended, deleted
+
+TEXT_DATA_RE = re.compile(r"^(?P<prefix>\[[0-9.]+\] \[\w+\]) #(?P<type>[0-9a-f]{2}) (?P<hex>[0-9a-f]*)\s*$")
+
+# Argument sizes in bytes on the Cortex-M4 (ILP32)
+ARG_SIZES = {"": 4, "hh": 4, "h": 4, "l": 4, "ll": 8, "z": 4, "t": 4, "j": 8}
+
+SPEC_RE = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\d*)(?P<prec>\.\d*)?(?P<len>hh|h|ll|l|z|j|t)?(?P<conv>[%diuxXocfFeEgGaAsp])")
+
+
+class Elf32:
+    """Minimal ELF32 little endian reader: maps loaded addresses to file contents."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError(f"{path} is not an ELF32 file")
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from("<IIIIII", self.data, shoff + i * shentsize)
+            SHT_NOBITS, SHF_ALLOC = 8, 0x2
+            if sh_flags & SHF_ALLOC and sh_type != SHT_NOBITS and sh_size > 0:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+
+    def string_at(self, addr):
+        for base, size, offset in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("ascii", errors="replace")
+        return f"<0x{addr:08x}>"
+
+
+def format_record(elf, fmt, args):
+    out = []
+    pos = 0
+    idx = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        conv = m.group("conv")
+        if conv == "%":
+            out.append("%")
+            continue
+
+        length = m.group("len") or ""
+        size = 4 if conv in "fFeEgGaAsp" else ARG_SIZES[length]
+        if idx + size > len(args):
+            return "".join(out)  # the record ran out of captured arguments
+        raw = args[idx:idx + size]
+        idx += size
+
+        spec = "%" + m.group("flags") + m.group("width") + (m.group("prec") or "")
+        if conv in "di":
+            value = int.from_bytes(raw, "little", signed=True)
+            out.append((spec + "d") % value)
+        elif conv in "uxXo":
+            value = int.from_bytes(raw, "little", signed=False)
+            out.append((spec + ("d" if conv == "u" else conv)) % value)
+        elif conv == "c":
+            out.append((spec + "c") % chr(raw[0]))
+        elif conv in "fFeEgGaA":
+            value, = struct.unpack("<f", raw)
+            out.append((spec + ("f" if conv in "aA" else conv)) % value)
+        elif conv == "s":
+            out.append((spec + "s") % elf.string_at(int.from_bytes(raw, "little")))
+        elif conv == "p":
+            out.append("0x%08x" % int.from_bytes(raw, "little"))
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def format_data(frame_type, payload):
+    if frame_type != DATA_SYSMON or len(payload) < SYSMON_HEADER.size:
+        return f"#{frame_type:02x} {payload.hex()}"
+
+    heap_free, heap_min, ring_used, ring_high, drops, n_tasks = SYSMON_HEADER.unpack_from(payload)
+    out = [f"heap {heap_free} free ({heap_min} min), log ring {ring_used}/{ring_high} B, {drops} drops"]
+    for i in range(n_tasks):
+        offset = SYSMON_HEADER.size + i * SYSMON_TASK.size
+        if offset + SYSMON_TASK.size > len(payload):
+            break
+        name, prio, state, cpu, stack = SYSMON_TASK.unpack_from(payload, offset)
+        name = name.rstrip(b"\0").decode("ascii", errors="replace")
+        state = TASK_STATES[state] if state < len(TASK_STATES) else "?"
+        out.append(f"{name}({prio}{state}) {cpu / 10:.1f}% {stack}B")
+    return " | ".join(out)
+
+
+def frames(stream):
+    """Yields (is_data, payload) for every log record and data frame in a binary capture."""
+    buff = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buff += chunk
+        while True:
+            start = buff.find(SYNC[:1])
+            if start < 0:
+                buff = b""
+                break
+            if len(buff) < start + 3:
+                buff = buff[start:]
+                break
+            sync = buff[start:start + 2]
+            if sync not in (SYNC, DATA_SYNC):
+                buff = buff[start + 1:]
+                continue
+            length = buff[start + 2]
+            end = start + 3 + length
+            if len(buff) < end:
+                buff = buff[start:]
+                break
+            payload = buff[start + 3:end]
+            is_data = sync == DATA_SYNC
+            if is_data and length < DATA_HEADER_LEN:
+                buff = buff[start + 1:]
+                continue  # lost sync
+            if not is_data and (length < HEADER_WORDS * 4 or (length % 4) != 0):
+                buff = buff[start + 1:]
+                continue  # lost sync
+            buff = buff[end:]
+            yield is_data, payload
+
+
+def decode_text(stream):
+    for raw in stream:
+        line = raw.decode("ascii", errors="replace").rstrip("\r\n")
+        m = TEXT_DATA_RE.match(line)
+        if m:
+            line = f"{m.group('prefix')} {format_data(int(m.group('type'), 16), bytes.fromhex(m.group('hex')))}"
+        print(line, flush=True)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(f"Usage: {sys.argv[0]} <firmware.elf> [capture_file|-]")
+        print(f"       {sys.argv[0]} --text [capture_file|-]")
+        sys.exit(1)
+
+    src = sys.argv[2] if len(sys.argv) > 2 else "-"
+    stream = sys.stdin.buffer if src == "-" else open(src, "rb")
+
+    if sys.argv[1] == "--text":
+        decode_text(stream)
+        return
+
+    elf = Elf32(sys.argv[1])
+    for is_data, payload in frames(stream):
+        if is_data:
+            time_us, frame_type = struct.unpack_from("<QB", payload)
+            text = format_data(frame_type, payload[DATA_HEADER_LEN:])
+            print(f"[{time_us // 1000000}.{time_us % 1000000:06d}] [DATA] {text}", flush=True)
+            continue
+
+        time_us, tag_addr, fmt_addr = struct.unpack_from("<QII", payload)
+        text = format_record(elf, elf.string_at(fmt_addr), payload[HEADER_WORDS * 4:])
+        print(f"[{time_us // 1000000}.{time_us % 1000000:06d}] [{elf.string_at(tag_addr)}] {text}", flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+
+# Per-module RAM bill from a GNU ld map file (the build links with -Wl,-Map=flight_software.map).
+# Every input section that lands in a RAM region is charged to the object it came from,
+# objects are grouped into subsystems by source directory.
+#
+# Usage: ./ram_budget.py <map_file> [-o report.txt] [--modules] [--sections]
+# Example: ./ram_budget.py build/Debug/flight_software.map --modules
+
+import argparse
+import collections
+import re
+import sys
+
+# Output sections that only reserve space, charged to the linker
+RESERVED = {
+    "._user_heap_stack": "newlib_heap",
+    "._user_stack": "msp_stack",
+}
+
+SECTION_RE = re.compile(r"^ (?P<name>\S+)?\s*0x(?P<addr>[0-9a-fA-F]+)\s+0x(?P<size>[0-9a-fA-F]+)(?:\s+(?P<obj>\S.*))?$")
+REGION_RE = re.compile(r"^(?P<name>\S+)\s+0x(?P<origin>[0-9a-fA-F]+)\s+0x(?P<length>[0-9a-fA-F]+)(?:\s+(?P<attrs>\S+))?")
+
+# Source directory -> subsystem, first match wins
+SUBSYSTEMS = [
+    ("Core/Src/utils/", "utils"),
+    ("Core/Src/sensors/", "sensors"),
+    ("Core/Src/estimation/", "estimation"),
+    ("Core/Src/init/", "init"),
+    ("Core/Src/bench/", "bench"),
+    ("Core/Src/", "cube"),
+    ("USB_DEVICE/", "usb"),
+    ("Middlewares/ST/", "usb"),
+    ("Middlewares/Third_Party/FreeRTOS/", "freertos"),
+    ("Drivers/", "hal"),
+    ("startup_", "cube"),
+]
+
+
+def parse_regions(lines):
+    """RAM regions as (name, start, end), told from flash by the writable attribute in the MEMORY table."""
+    regions = []
+    in_table = False
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            in_table = True
+            continue
+        if in_table and line.startswith("Linker script and memory map"):
+            break
+        m = REGION_RE.match(line) if in_table else None
+        # (rx) FLASH and (r) CALIB are read only, a region without attributes could be either
+        attrs = m.group("attrs") if m else None
+        if m and m.group("name") not in ("Name", "*default*") and (attrs is None or "w" in attrs.lower()):
+            origin = int(m.group("origin"), 16)
+            regions.append((m.group("name"), origin, origin + int(m.group("length"), 16)))
+    return regions
+
+
+def region_of(regions, addr):
+    for name, start, end in regions:
+        if start <= addr < end:
+            return name
+    return None
+
+
+def module_of(obj):
+    obj = obj.strip()
+    # Archive members: libc_nano.a(lib_a-mallocr.o)
+    m = re.match(r".*?([^/\\]+)\.a\((.+)\)$", obj)
+    if m:
+        return m.group(1), m.group(2)
+    path = obj.replace("\\", "/")
+    name = path.rsplit("/", 1)[-1]
+    for suffix in (".c.obj", ".s.obj", ".c.o", ".s.o", ".obj", ".o"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+            break
+    for prefix, subsystem in SUBSYSTEMS:
+        if prefix in path:
+            return subsystem, name
+    return "other", name
+
+
+def parse_sections(lines, regions):
+    """Yields (region, output_section, input_section, subsystem, module, size) for every allocated input section."""
+    in_map = False
+    output = None
+    pending = None  # input section name wrapped onto its own line
+    for line in lines:
+        if line.startswith("Linker script and memory map"):
+            in_map = True
+            continue
+        if not in_map:
+            continue
+
+        line = line.rstrip("\n")
+        if line and not line[0].isspace():
+            fields = line.split()
+            output = fields[0]
+            pending = None
+            if output in RESERVED and len(fields) >= 3 and fields[2].startswith("0x"):
+                # Reservation whose header fits on one line
+                region = region_of(regions, int(fields[1], 16))
+                if region is not None:
+                    yield region, output, output, "linker", RESERVED[output], int(fields[2], 16)
+                output = None
+            continue
+        if re.match(r"^ \S+$", line):
+            pending = line.strip()
+            continue
+
+        m = SECTION_RE.match(line)
+        if m and m.group("obj") is None and output in RESERVED and pending is None:
+            # Heap or stack reservation, the wrapped output section header carries its size
+            region = region_of(regions, int(m.group("addr"), 16))
+            if region is not None:
+                yield region, output, output, "linker", RESERVED[output], int(m.group("size"), 16)
+            output = None
+            continue
+        if not m or m.group("obj") is None:
+            pending = None
+            continue
+        name = m.group("name") or pending
+        pending = None
+        size = int(m.group("size"), 16)
+        if size == 0 or name is None or name.startswith("*fill*"):
+            continue
+
+        region = region_of(regions, int(m.group("addr"), 16))
+        if region is None:
+            continue
+        subsystem, module = module_of(m.group("obj"))
+        yield region, output, name, subsystem, module, size
+
+
+def parse_fill(lines, regions):
+    """Total alignment padding per region. The fill that makes up a reservation is already charged to it."""
+    fill = collections.Counter()
+    output = None
+    for line in lines:
+        if line.strip() and not line[0].isspace():
+            output = line.split()[0]
+            continue
+        m = re.match(r"^ \*fill\*\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)", line)
+        if m and output not in RESERVED:
+            region = region_of(regions, int(m.group(1), 16))
+            if region is not None:
+                fill[region] += int(m.group(2), 16)
+    return fill
+
+
+def report(lines, show_modules, show_sections):
+    regions = parse_regions(lines)
+    ram = regions
+    by_subsystem = collections.defaultdict(collections.Counter)
+    by_module = collections.defaultdict(collections.Counter)
+    totals = collections.Counter()
+    placement = []
+    for region, output, section, subsystem, module, size in parse_sections(lines, regions):
+        placement.append((region, output, section, module, size))
+        by_subsystem[subsystem][region] += size
+        by_module[(subsystem, module)][region] += size
+        totals[region] += size
+    fill = parse_fill(lines, regions)
+
+    names = [r[0] for r in ram]
+    out = []
+    header = f"{'subsystem':<24}" + "".join(f"{n:>10}" for n in names) + f"{'total':>10}"
+    out.append(header)
+    out.append("-" * len(header))
+    for subsystem, counts in sorted(by_subsystem.items(), key=lambda kv: -sum(kv[1].values())):
+        out.append(f"{subsystem:<24}" + "".join(f"{counts[n]:>10}" for n in names) + f"{sum(counts.values()):>10}")
+        if show_modules:
+            modules = [(m, c) for (s, m), c in by_module.items() if s == subsystem]
+            for module, mcounts in sorted(modules, key=lambda kv: -sum(kv[1].values())):
+                out.append(f"  {module:<22}" + "".join(f"{mcounts[n]:>10}" for n in names) + f"{sum(mcounts.values()):>10}")
+    out.append(f"{'(padding)':<24}" + "".join(f"{fill[n]:>10}" for n in names) + f"{sum(fill.values()):>10}")
+    out.append("-" * len(header))
+    used = [totals[n] + fill[n] for n in names]
+    out.append(f"{'used':<24}" + "".join(f"{u:>10}" for u in used) + f"{sum(used):>10}")
+    out.append(f"{'size':<24}" + "".join(f"{end - start:>10}" for _, start, end in ram))
+
+    if show_sections:
+        # What landed where, largest first within each region
+        for name in names:
+            out.append("")
+            out.append(f"{name}:")
+            for region, output, section, module, size in sorted(placement, key=lambda p: -p[4]):
+                if region == name:
+                    out.append(f"  {output:<18}{section:<40}{module:<24}{size:>8}")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Per-module RAM budget from a GNU ld map file")
+    parser.add_argument("map_file")
+    parser.add_argument("-o", "--output", help="also write the report to this file")
+    parser.add_argument("--modules", action="store_true", help="break subsystems down per source file")
+    parser.add_argument("--sections", action="store_true", help="list every input section per region")
+    args = parser.parse_args()
+
+    with open(args.map_file, encoding="utf-8", errors="replace") as f:
+        lines = f.readlines()
+
+    text = report(lines, args.modules, args.sections)
+    print(text)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file